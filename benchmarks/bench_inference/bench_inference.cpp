@@ -0,0 +1,158 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/benchmark_fixture.hpp"
+
+namespace {
+
+const int64_t NUM_EXECUTIONS = 8;
+
+void setGraphArgs(::benchmark::internal::Benchmark* bench) {
+  bench->ArgName("graph");
+  for (int64_t graph = 0; graph < GRAPH_COUNT; ++graph) {
+    bench->Arg(graph);
+  }
+  bench->Unit(::benchmark::kMillisecond);
+}
+
+}  // namespace
+
+/**
+ * Time to add the operands and operations of a model and finish it.
+ * The weights are generated by a first build so that only the model API calls
+ * are timed.
+ */
+BENCHMARK_DEFINE_F(BenchmarkFixture, ModelBuild)(::benchmark::State& state) {
+  TENSOROPT_BENCHMARK_CHECK(state, buildGraph(state.range(0)));
+  for (auto _ : state) {
+    state.PauseTiming();
+    recreateModel();
+    state.ResumeTiming();
+    TENSOROPT_BENCHMARK_CHECK(state, buildGraph(state.range(0)));
+  }
+}
+BENCHMARK_REGISTER_F(BenchmarkFixture, ModelBuild)->Apply(setGraphArgs);
+
+/**
+ * Time of ANeuralNetworksCompilation_finish, this includes the optimization
+ * passes and the creation of the backend network.
+ */
+BENCHMARK_DEFINE_F(BenchmarkFixture, CompilationFinish)
+(::benchmark::State& state) {
+  TENSOROPT_BENCHMARK_CHECK(state, buildGraph(state.range(0)));
+  for (auto _ : state) {
+    state.PauseTiming();
+    TENSOROPT_BENCHMARK_CHECK(
+        state, ANeuralNetworksCompilation_create(model, &compilation));
+    state.ResumeTiming();
+    TENSOROPT_BENCHMARK_CHECK(
+        state, ANeuralNetworksCompilation_finish(compilation));
+    state.PauseTiming();
+    ANeuralNetworksCompilation_free(compilation);
+    compilation = nullptr;
+    state.ResumeTiming();
+  }
+}
+BENCHMARK_REGISTER_F(BenchmarkFixture, CompilationFinish)
+    ->Apply(setGraphArgs);
+
+/**
+ * Latency of a single synchronous execution with host inputs and outputs.
+ * The inputs and outputs are set before each computation.
+ */
+BENCHMARK_DEFINE_F(BenchmarkFixture, ExecutionLatency)
+(::benchmark::State& state) {
+  TENSOROPT_BENCHMARK_CHECK(state, buildGraph(state.range(0)));
+  TENSOROPT_BENCHMARK_CHECK(state, compile());
+  ANeuralNetworksExecution* execution = nullptr;
+  TENSOROPT_BENCHMARK_CHECK(
+      state, ANeuralNetworksExecution_create(compilation, &execution));
+  std::vector<std::vector<uint8_t>> host_data;
+  TENSOROPT_BENCHMARK_CHECK(state,
+                            allocateHostMemories(execution, host_data));
+  // Warm up
+  TENSOROPT_BENCHMARK_CHECK(state, setHostMemories(execution, host_data));
+  TENSOROPT_BENCHMARK_CHECK(state, ANeuralNetworksExecution_compute(execution));
+  for (auto _ : state) {
+    TENSOROPT_BENCHMARK_CHECK(state, setHostMemories(execution, host_data));
+    TENSOROPT_BENCHMARK_CHECK(state,
+                              ANeuralNetworksExecution_compute(execution));
+  }
+  ANeuralNetworksExecution_free(execution);
+}
+BENCHMARK_REGISTER_F(BenchmarkFixture, ExecutionLatency)
+    ->Apply(setGraphArgs)
+    ->UseRealTime();
+
+/**
+ * Steady-state throughput of executions submitted asynchronously.
+ * Each iteration sets the inputs and outputs and starts NUM_EXECUTIONS
+ * executions before waiting on all of them, the number of items processed is
+ * the number of executions.
+ */
+BENCHMARK_DEFINE_F(BenchmarkFixture, ExecutionThroughput)
+(::benchmark::State& state) {
+  TENSOROPT_BENCHMARK_CHECK(state, buildGraph(state.range(0)));
+  TENSOROPT_BENCHMARK_CHECK(state, compile());
+  std::vector<ANeuralNetworksExecution*> executions(NUM_EXECUTIONS, nullptr);
+  std::vector<ANeuralNetworksEvent*> events(NUM_EXECUTIONS, nullptr);
+  std::vector<std::vector<std::vector<uint8_t>>> host_data(NUM_EXECUTIONS);
+  auto free_executions = [&executions]() {
+    for (auto execution : executions) {
+      ANeuralNetworksExecution_free(execution);
+    }
+  };
+  for (std::size_t i = 0; i < executions.size(); ++i) {
+    if (ANeuralNetworksExecution_create(compilation, &executions[i]) !=
+            ANEURALNETWORKS_NO_ERROR ||
+        allocateHostMemories(executions[i], host_data[i]) !=
+            ANEURALNETWORKS_NO_ERROR) {
+      free_executions();
+      state.SkipWithError("Could not create the executions");
+      return;
+    }
+  }
+  for (auto _ : state) {
+    ResultCode status = ANEURALNETWORKS_NO_ERROR;
+    for (std::size_t i = 0; i < executions.size(); ++i) {
+      if (status == ANEURALNETWORKS_NO_ERROR) {
+        status = setHostMemories(executions[i], host_data[i]);
+      }
+      if (status == ANEURALNETWORKS_NO_ERROR) {
+        status = ANeuralNetworksExecution_startCompute(executions[i],
+                                                       &events[i]);
+      }
+    }
+    for (auto& event : events) {
+      if (event) {
+        if (status == ANEURALNETWORKS_NO_ERROR) {
+          status = ANeuralNetworksEvent_wait(event);
+        }
+        ANeuralNetworksEvent_free(event);
+        event = nullptr;
+      }
+    }
+    if (status != ANEURALNETWORKS_NO_ERROR) {
+      free_executions();
+      state.SkipWithError("Could not compute the executions");
+      return;
+    }
+  }
+  free_executions();
+  state.SetItemsProcessed(state.iterations() * NUM_EXECUTIONS);
+}
+BENCHMARK_REGISTER_F(BenchmarkFixture, ExecutionThroughput)
+    ->Apply(setGraphArgs)
+    ->UseRealTime();
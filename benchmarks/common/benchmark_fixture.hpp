@@ -0,0 +1,241 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef TENSOROPT_BENCHMARKS_COMMON_BENCHMARK_FIXTURE_HPP
+#define TENSOROPT_BENCHMARKS_COMMON_BENCHMARK_FIXTURE_HPP
+
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <tensoropt/tensoropt.hpp>
+
+#include "common/macro.hpp"
+#include "common/utils.hpp"
+#include "model_zoo/model_zoo.hpp"
+
+// Stop the benchmark if VAR is not ANEURALNETWORKS_NO_ERROR
+#define TENSOROPT_BENCHMARK_CHECK(STATE, VAR)         \
+  if ((VAR) != ANEURALNETWORKS_NO_ERROR) {            \
+    (STATE).SkipWithError("Error returned by " #VAR); \
+    return;                                           \
+  }
+
+/**
+ * Representative graphs built by BenchmarkFixture::buildGraph.
+ */
+enum BenchmarkGraph : int64_t {
+  // Stack of 3x3 CONV_2D with RELU, the input is [1, 56, 56, 32]
+  CONV_STACK,
+  // Chain of MATMUL of [256, 256] matrices
+  MATMUL_CHAIN,
+  // Chain of ADD and MUL of a [256, 256] tensor with [256] vectors
+  ELEMENTWISE_BROADCAST,
+  // Models of the zoo with their default configuration
+  MOBILENET_V1,
+  MOBILENET_V2,
+  RESNET,
+  TRANSFORMER_ENCODER,
+  MLP,
+  GRAPH_COUNT,
+};
+
+/**
+ * Fixture building a model through the public API.
+ * The builders return an error code instead of stopping the benchmark so
+ * that they can be used with TENSOROPT_RETURN_IF_ERROR.
+ */
+class BenchmarkFixture : public ::benchmark::Fixture {
+ public:
+  BenchmarkFixture() : model(nullptr), compilation(nullptr), builder() {}
+
+  void SetUp(::benchmark::State&) override { createModel(); }
+
+  void TearDown(::benchmark::State&) override { release(); }
+
+ protected:
+  static const uint32_t NUM_LAYERS = 8;
+
+  void createModel() {
+    release();
+    ANeuralNetworksModel_create(&model);
+    builder.reset(new ModelBuilder(model));
+  }
+
+  /**
+   * Replace the model with an empty one. The builder is kept so that building
+   * the same graph again reuses its weights.
+   */
+  void recreateModel() {
+    if (compilation) {
+      ANeuralNetworksCompilation_free(compilation);
+      compilation = nullptr;
+    }
+    ANeuralNetworksModel_free(model);
+    ANeuralNetworksModel_create(&model);
+    builder->reset(model);
+  }
+
+  void release() {
+    if (compilation) {
+      ANeuralNetworksCompilation_free(compilation);
+      compilation = nullptr;
+    }
+    if (model) {
+      ANeuralNetworksModel_free(model);
+      model = nullptr;
+    }
+    builder.reset();
+  }
+
+  ResultCode buildConvStack() {
+    const uint32_t channels = 32;
+    ZooTensor x;
+    TENSOROPT_RETURN_IF_ERROR(builder->addInput({1, 56, 56, channels}, x));
+    for (uint32_t i = 0; i < NUM_LAYERS; ++i) {
+      TENSOROPT_RETURN_IF_ERROR(builder->conv2D(
+          x, channels, 3, 1, ANEURALNETWORKS_FUSED_RELU, x));
+    }
+    return builder->identifyInputsAndOutputs({x});
+  }
+
+  ResultCode buildMatmulChain() {
+    const uint32_t size = 256;
+    ZooTensor x;
+    TENSOROPT_RETURN_IF_ERROR(builder->addInput({size, size}, x));
+    for (uint32_t i = 0; i < NUM_LAYERS; ++i) {
+      ZooTensor matrix;
+      TENSOROPT_RETURN_IF_ERROR(
+          builder->addWeights({size, size}, 0.1f, matrix));
+      TENSOROPT_RETURN_IF_ERROR(builder->matmul(x, matrix, x));
+    }
+    return builder->identifyInputsAndOutputs({x});
+  }
+
+  ResultCode buildElementwiseBroadcast() {
+    const uint32_t size = 256;
+    ZooTensor x;
+    TENSOROPT_RETURN_IF_ERROR(builder->addInput({size, size}, x));
+    for (uint32_t i = 0; i < NUM_LAYERS; ++i) {
+      ZooTensor vector;
+      uint32_t fuse_idx;
+      TENSOROPT_RETURN_IF_ERROR(builder->addWeights({size}, 1.f, vector));
+      TENSOROPT_RETURN_IF_ERROR(
+          builder->addInt32(ANEURALNETWORKS_FUSED_NONE, fuse_idx));
+      TENSOROPT_RETURN_IF_ERROR(builder->addOperation(
+          i % 2 ? ANEURALNETWORKS_MUL : ANEURALNETWORKS_ADD,
+          {x.idx, vector.idx, fuse_idx}, x.dims, x));
+    }
+    return builder->identifyInputsAndOutputs({x});
+  }
+
+  /**
+   * Build and finish the model of the given graph.
+   */
+  ResultCode buildGraph(int64_t graph) {
+    switch (graph) {
+      case CONV_STACK:
+        TENSOROPT_RETURN_IF_ERROR(buildConvStack());
+        break;
+      case MATMUL_CHAIN:
+        TENSOROPT_RETURN_IF_ERROR(buildMatmulChain());
+        break;
+      case ELEMENTWISE_BROADCAST:
+        TENSOROPT_RETURN_IF_ERROR(buildElementwiseBroadcast());
+        break;
+      case MOBILENET_V1:
+        TENSOROPT_RETURN_IF_ERROR(
+            buildMobileNetV1(*builder, MobileNetConfig()));
+        break;
+      case MOBILENET_V2:
+        TENSOROPT_RETURN_IF_ERROR(
+            buildMobileNetV2(*builder, MobileNetConfig()));
+        break;
+      case RESNET:
+        TENSOROPT_RETURN_IF_ERROR(buildResNet(*builder, ResNetConfig()));
+        break;
+      case TRANSFORMER_ENCODER:
+        TENSOROPT_RETURN_IF_ERROR(
+            buildTransformerEncoder(*builder, TransformerConfig()));
+        break;
+      case MLP:
+        TENSOROPT_RETURN_IF_ERROR(buildMlp(*builder, MlpConfig()));
+        break;
+      default:
+        return ANEURALNETWORKS_BAD_DATA;
+    }
+    return ANeuralNetworksModel_finish(model);
+  }
+
+  ResultCode compile() {
+    TENSOROPT_RETURN_IF_ERROR(
+        ANeuralNetworksCompilation_create(model, &compilation));
+    return ANeuralNetworksCompilation_finish(compilation);
+  }
+
+  /**
+   * Allocate in host_data the host memory of all the inputs followed by all
+   * the outputs of execution.
+   */
+  ResultCode allocateHostMemories(
+      ANeuralNetworksExecution* execution,
+      std::vector<std::vector<uint8_t>>& host_data) {
+    auto num_inputs =
+        ANeuralNetworksExecution_getIdentifiedInputCount(execution);
+    auto num_outputs =
+        ANeuralNetworksExecution_getIdentifiedOutputCount(execution);
+    std::vector<ANeuralNetworksOperandType> op_types(num_inputs + num_outputs);
+    TENSOROPT_RETURN_IF_ERROR(ANeuralNetworksExecution_getIdentifiedInputs(
+        execution, op_types.data()));
+    TENSOROPT_RETURN_IF_ERROR(ANeuralNetworksExecution_getIdentifiedOutputs(
+        execution, op_types.data() + num_inputs));
+    host_data.resize(op_types.size());
+    for (std::size_t i = 0; i < op_types.size(); ++i) {
+      host_data[i].resize(getOperandTypeSizeBytes(op_types[i]));
+    }
+    return ANEURALNETWORKS_NO_ERROR;
+  }
+
+  /**
+   * Set all the inputs and outputs of execution to the host memory allocated
+   * by allocateHostMemories. This is done for each computation as a user
+   * would do.
+   */
+  ResultCode setHostMemories(ANeuralNetworksExecution* execution,
+                             std::vector<std::vector<uint8_t>>& host_data) {
+    auto num_inputs =
+        ANeuralNetworksExecution_getIdentifiedInputCount(execution);
+    for (uint32_t i = 0; i < host_data.size(); ++i) {
+      auto& data = host_data[i];
+      if (i < num_inputs) {
+        TENSOROPT_RETURN_IF_ERROR(ANeuralNetworksExecution_setInput(
+            execution, static_cast<int32_t>(i), nullptr, data.data(),
+            data.size()));
+      } else {
+        TENSOROPT_RETURN_IF_ERROR(ANeuralNetworksExecution_setOutput(
+            execution, static_cast<int32_t>(i - num_inputs), nullptr,
+            data.data(), data.size()));
+      }
+    }
+    return ANEURALNETWORKS_NO_ERROR;
+  }
+
+  ANeuralNetworksModel* model;
+  ANeuralNetworksCompilation* compilation;
+  // Owns the weights of the model, must be destroyed after the compilation
+  std::unique_ptr<ModelBuilder> builder;
+};
+
+#endif  // TENSOROPT_BENCHMARKS_COMMON_BENCHMARK_FIXTURE_HPP
@@ -0,0 +1,31 @@
+# Integrate Google Benchmark the same way as googletest, see GTest.cmake
+# Download and unpack Google Benchmark at configure time
+set(BENCHMARK_GIT_TAG "v1.5.2" CACHE STRING
+  "Git tag, branch or commit to use for Google Benchmark"
+)
+configure_file(
+  ${CMAKE_SOURCE_DIR}/cmake/templates/GoogleBenchmark.txt.in
+  googlebenchmark-download/CMakeLists.txt
+)
+execute_process(COMMAND ${CMAKE_COMMAND} -G "${CMAKE_GENERATOR}" .
+  RESULT_VARIABLE result
+  WORKING_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}/googlebenchmark-download )
+if(result)
+  message(FATAL_ERROR "CMake step for Google Benchmark failed: ${result}")
+endif()
+execute_process(COMMAND ${CMAKE_COMMAND} --build .
+  RESULT_VARIABLE result
+  WORKING_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}/googlebenchmark-download )
+if(result)
+  message(FATAL_ERROR "Build step for Google Benchmark failed: ${result}")
+endif()
+
+# The tests of Google Benchmark would require googletest
+set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "" FORCE)
+set(BENCHMARK_ENABLE_INSTALL OFF CACHE BOOL "" FORCE)
+
+# Add Google Benchmark directly to our build. This defines
+# the benchmark and benchmark_main targets.
+add_subdirectory(${CMAKE_CURRENT_BINARY_DIR}/googlebenchmark-src
+                 ${CMAKE_CURRENT_BINARY_DIR}/googlebenchmark-build
+                 EXCLUDE_FROM_ALL)
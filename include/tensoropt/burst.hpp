@@ -0,0 +1,42 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef INCLUDE_TENSOROPT_BURST_HPP
+#define INCLUDE_TENSOROPT_BURST_HPP
+
+#include "tensoropt/compilation.hpp"
+
+/**
+ * A burst keeps the resources needed to execute a compilation alive across
+ * executions so that executions using the same memories do not have to
+ * prepare them again.
+ * See ANeuralNetworksExecution_burstCompute.
+ */
+struct ANeuralNetworksBurst;
+
+/**
+ * Create a burst from a finished compilation.
+ * Compilations of models with dynamic inputs are not supported.
+ */
+ResultCode ANeuralNetworksBurst_create(ANeuralNetworksCompilation* compilation,
+                                       ANeuralNetworksBurst** burst);
+
+/**
+ * Free a burst.
+ * The memories used by the executions of the burst are released.
+ */
+void ANeuralNetworksBurst_free(ANeuralNetworksBurst* burst);
+
+#endif  // INCLUDE_TENSOROPT_BURST_HPP
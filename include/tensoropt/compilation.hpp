@@ -34,6 +34,24 @@ enum PreferenceCode {
   ANEURALNETWORKS_PREFER_SUSTAINED_SPEED = 2
 };
 
+/**
+ * Stages of a compilation that can be queried with
+ * ANeuralNetworksCompilation_getDuration.
+ */
+enum CompilationDurationCode : int {
+  // Optimization passes applied to the model before it is converted
+  ANEURALNETWORKS_COMPILATION_DURATION_OPTIMIZE = 0,
+  // Copy to the host of the constant operands set from device memory
+  ANEURALNETWORKS_COMPILATION_DURATION_COPY_CONSTANTS = 1,
+  // Conversion of the model to a backend network, including the two stages
+  // above
+  ANEURALNETWORKS_COMPILATION_DURATION_CONVERT = 2,
+  // Compilation of the network object by the backend
+  ANEURALNETWORKS_COMPILATION_DURATION_CREATE_NETWORK_OBJECT = 3,
+  // Creation of the network binary when caching or serializing
+  ANEURALNETWORKS_COMPILATION_DURATION_CREATE_NETWORK_BINARY = 4,
+};
+
 /**
  * Compiles a ANeuralNetworksModel to an ANeuralNetworksExecution object.
  */
@@ -56,10 +74,12 @@ ResultCode ANeuralNetworksCompilation_createForDevices(
 /**
  * Provide a cache directory to save and load compiled models.
  * The token must be a unique identifier for the model of size
- * BYTE_SIZE_OF_CACHE_TOKEN.
- * Caching if only used if this method is called and
- * ANeuralNetworksCompilation_serialize is used after. By default no caching is
- * performed.
+ * BYTE_SIZE_OF_CACHE_TOKEN. If token is nullptr the hash of the model is used
+ * instead, see ANeuralNetworksModel_getHash.
+ * ANeuralNetworksCompilation_finish and ANeuralNetworksCompilation_serialize
+ * will load the compiled model from the cache directory if it exists. On a
+ * cache miss, ANeuralNetworksCompilation_finish writes the compiled model to
+ * the cache directory. By default no caching is performed.
  */
 ResultCode ANeuralNetworksCompilation_setCaching(
     ANeuralNetworksCompilation* compilation, const char* cache_dir,
@@ -68,15 +88,83 @@ ResultCode ANeuralNetworksCompilation_setCaching(
 ResultCode ANeuralNetworksCompilation_setPreference(
     ANeuralNetworksCompilation* compilation, int32_t preference);
 
+/**
+ * Set the maximum number of network objects kept for a model with dynamic
+ * inputs. The model is compiled for each set of concrete input shapes the
+ * first time it is executed and the least recently used network object is
+ * released once there are more than max_specialisations. Defaults to 8.
+ */
+ResultCode ANeuralNetworksCompilation_setMaxSpecialisations(
+    ANeuralNetworksCompilation* compilation, uint32_t max_specialisations);
+
+/**
+ * Declare the sizes a dynamic dimension of a model input is padded to so that
+ * the number of network objects compiled stays bounded.
+ * At execution the dimension is padded with zeros up to the smallest bucket it
+ * fits in and the outputs are sliced back to the shapes computed from the
+ * unpadded inputs. Sizes larger than the largest bucket are compiled as is.
+ * The padded elements must not change the other elements of the outputs, which
+ * is the case of a batch dimension for instance.
+ * Padding is only supported for inputs and outputs set from host memory.
+ * The index is an identified input index, not an operand index.
+ */
+ResultCode ANeuralNetworksCompilation_setDimensionBuckets(
+    ANeuralNetworksCompilation* compilation, int32_t index, uint32_t dimension,
+    const uint32_t* buckets, uint32_t num_buckets);
+
 /**
  * Mark the compilation as finished to be able to create an
  * ANeuralNetworksExecution object using ANeuralNetworksExecution_create.
+ * See ANeuralNetworksCompilation_setCaching to avoid compiling the same model
+ * again.
  */
 ResultCode ANeuralNetworksCompilation_finish(
     ANeuralNetworksCompilation* compilation);
 
+/**
+ * Return the peak memory in bytes needed by the intermediate tensors of a
+ * finished compilation once tensors whose lifetimes do not overlap share the
+ * same memory. Model inputs and outputs are not included.
+ * The placement is computed by the first query. If the compiled model was
+ * loaded from the cache or shared with another compilation, the model is
+ * optimized again at this point.
+ * This is not supported for models with dynamic inputs.
+ */
+ResultCode ANeuralNetworksCompilation_getArenaSize(
+    ANeuralNetworksCompilation* compilation, std::size_t* arena_size);
+
+/**
+ * Return the offset in bytes in the arena of the intermediate tensor
+ * operand_index, see ANeuralNetworksCompilation_getArenaSize.
+ * Return ANEURALNETWORKS_BAD_DATA if the operand is not an intermediate
+ * tensor of the optimized model, for instance if it was removed by the
+ * optimizations.
+ */
+ResultCode ANeuralNetworksCompilation_getArenaOffset(
+    ANeuralNetworksCompilation* compilation, uint32_t operand_index,
+    std::size_t* offset);
+
+/**
+ * Return the time spent in a stage of the compilation in nanoseconds.
+ * duration is set to UINT64_MAX if the stage was not run, for instance if
+ * the compiled model was loaded from the cache.
+ */
+ResultCode ANeuralNetworksCompilation_getDuration(
+    const ANeuralNetworksCompilation* compilation, int32_t duration_code,
+    uint64_t* duration);
+
+/**
+ * Return the time spent converting the operations of type operation_type in
+ * nanoseconds and the number of such operations converted. The operations
+ * are counted after the model is optimized.
+ */
+ResultCode ANeuralNetworksCompilation_getOperationDuration(
+    const ANeuralNetworksCompilation* compilation, int32_t operation_type,
+    uint64_t* duration, uint32_t* count);
+
 /**
  * Serialize the compiled model, this replaces the call to finish.
+ * A model with dynamic inputs cannot be serialized.
  * The compilation should not be finished with ANeuralNetworksCompilation_finish
  * unless execution objects will be created using both
  * ANeuralNetworksExecution_create and
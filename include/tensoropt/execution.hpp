@@ -16,6 +16,7 @@
 #ifndef INCLUDE_TENSOROPT_EXECUTION_HPP
 #define INCLUDE_TENSOROPT_EXECUTION_HPP
 
+#include "tensoropt/burst.hpp"
 #include "tensoropt/compilation.hpp"
 #include "tensoropt/event.hpp"
 
@@ -41,10 +42,14 @@ ResultCode ANeuralNetworksExecution_createFromBinary(
  * There must be one call of ANeuralNetworksExecution_setInput or
  * ANeuralNetworksExecution_setInputFromMemory per model input.
  * The index is an identified input index, not an operand index.
- * type can be a nullptr.
+ * type can be a nullptr unless the input has dynamic dimensions in which case
+ * type gives the concrete dimensions for this execution.
  * If the input is optional, value can be nullptr and length can be 0.
  * data is copied to the model if the length is smaller or equal to
  * ANEURALNETWORKS_MAX_SIZE_OF_IMMEDIATELY_COPIED_VALUES
+ * The memory imported for data is reused by the following computations
+ * setting the same data and length, data must stay valid until the
+ * execution is freed.
  */
 ResultCode ANeuralNetworksExecution_setInput(
     ANeuralNetworksExecution* execution, int32_t index,
@@ -56,9 +61,12 @@ ResultCode ANeuralNetworksExecution_setInput(
  * There must be one call of ANeuralNetworksExecution_setInput or
  * ANeuralNetworksExecution_setInputFromMemory per model input.
  * The index is an identified input index, not an operand index.
- * type can be a nullptr.
+ * type can be a nullptr unless the input has dynamic dimensions, see
+ * ANeuralNetworksExecution_setInput.
  * If the input is optional, memory can be nullptr and offset and length can
  * be 0.
+ * offset must be a multiple of the device's base address alignment
+ * (CL_DEVICE_MEM_BASE_ADDR_ALIGN) so that a SYCL sub-buffer can be used.
  */
 ResultCode ANeuralNetworksExecution_setInputFromMemory(
     ANeuralNetworksExecution* execution, int32_t index,
@@ -72,6 +80,7 @@ ResultCode ANeuralNetworksExecution_setInputFromMemory(
  * The index is an identified output index, not an operand index.
  * type can be a nullptr.
  * If the output is optional, value can be nullptr and length can be 0.
+ * data is reused in the same way as ANeuralNetworksExecution_setInput.
  */
 ResultCode ANeuralNetworksExecution_setOutput(
     ANeuralNetworksExecution* execution, int32_t index,
@@ -85,6 +94,8 @@ ResultCode ANeuralNetworksExecution_setOutput(
  * type can be a nullptr.
  * If the output is optional, memory can be nullptr and offset and length can
  * be 0.
+ * offset must be a multiple of the device's base address alignment
+ * (CL_DEVICE_MEM_BASE_ADDR_ALIGN) so that a SYCL sub-buffer can be used.
  */
 ResultCode ANeuralNetworksExecution_setOutputFromMemory(
     ANeuralNetworksExecution* execution, int32_t index,
@@ -126,6 +137,8 @@ ResultCode ANeuralNetworksExecution_getIdentifiedOutputs(
 /**
  * Return the dimensions of the specified output operand.
  * dimensions must be at least as big as the rank of the operand.
+ * If the model has dynamic inputs the dimensions are the ones computed for the
+ * shapes of the inputs set on the execution.
  * See also ANeuralNetworksExecution_getIdentifiedOutputs.
  */
 ResultCode ANeuralNetworksExecution_getOutputOperandDimensions(
@@ -138,13 +151,86 @@ ResultCode ANeuralNetworksExecution_getOutputOperandDimensions(
 ResultCode ANeuralNetworksExecution_getOutputOperandRank(
     ANeuralNetworksExecution* execution, int32_t index, uint32_t* rank);
 
+/**
+ * Durations that can be queried with ANeuralNetworksExecution_getDuration.
+ * The durations specific to TensorOpt start at 1000 so that they do not
+ * collide with the NNAPI durations.
+ */
+enum DurationCode : int {
+  // Execution of the network on the device
+  ANEURALNETWORKS_DURATION_ON_HARDWARE = 0,
+  // From the submission of the computation to the end of the copy of the
+  // outputs to the host
+  ANEURALNETWORKS_DURATION_IN_DRIVER = 1,
+  // From the submission of the computation to the start of its execution on
+  // the device
+  ANEURALNETWORKS_DURATION_IN_QUEUE = 1000,
+  // Copy of the host outputs once the execution on the device is done
+  ANEURALNETWORKS_DURATION_COPY_TO_HOST = 1001,
+};
+
+/**
+ * Set whether the durations of the next computations are measured.
+ * Timing is disabled by default.
+ */
+ResultCode ANeuralNetworksExecution_setMeasureTiming(
+    ANeuralNetworksExecution* execution, bool measure);
+
+/**
+ * Return the duration of the last computation in nanoseconds.
+ * The computation must have been waited on. duration is set to UINT64_MAX if
+ * the timing was not measured.
+ */
+ResultCode ANeuralNetworksExecution_getDuration(
+    const ANeuralNetworksExecution* execution, int32_t duration_code,
+    uint64_t* duration);
+
+/**
+ * Cumulative counters of the computations of an execution.
+ */
+struct ANeuralNetworksExecutionStatistics {
+  // Number of computations started
+  uint64_t num_computations;
+  // Number of memories imported to the backend and destroyed
+  uint64_t num_memory_imports;
+  uint64_t num_memory_destroys;
+  // Size in bytes of the imported memories
+  uint64_t imported_bytes;
+  // Size in bytes of the host outputs copied back once computed
+  uint64_t host_output_bytes;
+  // Time in nanoseconds waiting for the inputs and outputs set from device
+  // memory to be released by the previous computation
+  uint64_t lock_wait_duration;
+};
+
+/**
+ * Return the counters accumulated since the execution was created.
+ * The memories imported by a burst are counted by the execution computed
+ * with the burst.
+ */
+ResultCode ANeuralNetworksExecution_getStatistics(
+    const ANeuralNetworksExecution* execution,
+    ANeuralNetworksExecutionStatistics* statistics);
+
 /**
  * Execute the model synchronously.
- * An execution can be executed multiple times.
+ * An execution can be executed multiple times. The inputs and outputs stay
+ * set for the next computations, with or without a burst.
  */
 ResultCode ANeuralNetworksExecution_compute(
     ANeuralNetworksExecution* execution);
 
+/**
+ * Execute the model synchronously using the resources of a burst.
+ * The execution must be created from the same compilation as the burst.
+ * Memories used by a previous computation of the burst are not imported
+ * again. Host memories must stay valid until the burst is freed.
+ * A burst can only be used by one computation at a time, concurrent calls
+ * are serialized.
+ */
+ResultCode ANeuralNetworksExecution_burstCompute(
+    ANeuralNetworksExecution* execution, ANeuralNetworksBurst* burst);
+
 /**
  * Execute the model asynchronously and create a corresponding output_event.
  * An execution can be executed multiple times. The output_event can be nullptr
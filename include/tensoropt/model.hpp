@@ -24,6 +24,12 @@
 
 struct ANeuralNetworksModel;
 
+/**
+ * Size of the hash of a model.
+ * See ANeuralNetworksModel_getHash.
+ */
+enum { BYTE_SIZE_OF_MODEL_HASH = 32 };
+
 /**
  * Create a model.
  */
@@ -34,6 +40,18 @@ ResultCode ANeuralNetworksModel_create(ANeuralNetworksModel** model);
  */
 ResultCode ANeuralNetworksModel_finish(ANeuralNetworksModel* model);
 
+/**
+ * Get the 256-bit hash of a finished model.
+ * The hash covers the operands, operations, constant values and identified
+ * inputs and outputs. It is computed incrementally while the model is built so
+ * two models built with the same sequence of calls have the same hash.
+ * Constant values set from device memory are read back when
+ * ANeuralNetworksModel_setOperandValueFromMemory is called.
+ * hash must be at least of size BYTE_SIZE_OF_MODEL_HASH.
+ */
+ResultCode ANeuralNetworksModel_getHash(const ANeuralNetworksModel* model,
+                                        uint8_t* hash);
+
 /**
  * Free a model.
  * A model cannot be free'd while it is used by a compilation.
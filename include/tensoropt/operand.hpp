@@ -54,7 +54,11 @@ struct ANeuralNetworksOperandType {
   ANeuralNetworksOperandCode type;
   /** Number of dimensions (rank), should be 0 for scalars */
   uint32_t dimensionCount;
-  /** The dimensions of the tensor, should be nullptr for scalars */
+  /**
+   * The dimensions of the tensor, should be nullptr for scalars.
+   * A dimension of 0 is unknown. Unknown dimensions of the model inputs are
+   * dynamic, their value is given to ANeuralNetworksExecution_setInput.
+   */
   const uint32_t* dimensions;
   /** Used for quantized type */
   float scale;
@@ -16,8 +16,10 @@
 #ifndef INCLUDE_TENSOROPT_TENSOROPT_HPP
 #define INCLUDE_TENSOROPT_TENSOROPT_HPP
 
+#include "tensoropt/burst.hpp"
 #include "tensoropt/compilation.hpp"
 #include "tensoropt/execution.hpp"
 #include "tensoropt/model.hpp"
+#include "tensoropt/trace.hpp"
 
 #endif  // INCLUDE_TENSOROPT_TENSOROPT_HPP
@@ -0,0 +1,37 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef INCLUDE_TENSOROPT_TRACE_HPP
+#define INCLUDE_TENSOROPT_TRACE_HPP
+
+#include "tensoropt/result.hpp"
+
+/**
+ * Start recording the calls to the TensorOpt API, to the backend and the
+ * tasks submitted to the device.
+ * The trace is written to path in the Chrome trace event format once
+ * ANeuralNetworks_stopTracing is called. It can be opened with
+ * chrome://tracing or Perfetto.
+ * Tracing can also be enabled for the whole process by setting the
+ * TENSOROPT_TRACE environment variable to the output path.
+ */
+ResultCode ANeuralNetworks_startTracing(const char* path);
+
+/**
+ * Stop recording and write the trace started by ANeuralNetworks_startTracing.
+ */
+ResultCode ANeuralNetworks_stopTracing();
+
+#endif  // INCLUDE_TENSOROPT_TRACE_HPP
@@ -0,0 +1,509 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "model_zoo/model_zoo.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "common/macro.hpp"
+
+namespace {
+
+const float BIAS_RANGE = 0.1f;
+
+/**
+ * Range of the weights so that the variance of the outputs is close to the
+ * variance of the inputs.
+ */
+float getWeightsRange(uint32_t fan_in) {
+  return std::sqrt(3.f / static_cast<float>(fan_in));
+}
+
+uint32_t scaleChannels(uint32_t channels, float width_multiplier) {
+  auto scaled = static_cast<uint32_t>(
+      std::lround(static_cast<float>(channels) * width_multiplier));
+  return std::max(scaled, 8u);
+}
+
+ResultCode checkRank(const ZooTensor& tensor, std::size_t rank) {
+  TENSOROPT_RETURN_IF_COND(tensor.dims.size() != rank,
+                           "Error: expected rank " << rank << " but got "
+                                                   << tensor.dims.size(),
+                           ANEURALNETWORKS_BAD_DATA);
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode addClassifier(ModelBuilder& builder, const ZooTensor& features,
+                         uint32_t num_classes) {
+  ZooTensor logits;
+  ZooTensor probabilities;
+  TENSOROPT_RETURN_IF_ERROR(builder.fullyConnected(
+      features, num_classes, ANEURALNETWORKS_FUSED_NONE, logits));
+  TENSOROPT_RETURN_IF_ERROR(builder.softmax(logits, 1.f, probabilities));
+  return builder.identifyInputsAndOutputs({probabilities});
+}
+
+}  // namespace
+
+ModelBuilder::ModelBuilder(ANeuralNetworksModel* model, uint32_t seed)
+    : model(model),
+      engine(seed),
+      weights(),
+      next_weights(weights.end()),
+      inputs() {}
+
+void ModelBuilder::reset(ANeuralNetworksModel* new_model) {
+  model = new_model;
+  next_weights = weights.begin();
+  inputs.clear();
+}
+
+ResultCode ModelBuilder::addOperand(ANeuralNetworksOperandCode op_code,
+                                    const std::vector<uint32_t>& dims,
+                                    uint32_t& op_idx) {
+  ANeuralNetworksOperandType op;
+  op.type = op_code;
+  op.scale = 0.f;
+  op.zeroPoint = 0;
+  op.dimensionCount = static_cast<uint32_t>(dims.size());
+  op.dimensions = dims.empty() ? nullptr : dims.data();
+  return ANeuralNetworksModel_addOperand(model, &op, &op_idx);
+}
+
+ResultCode ModelBuilder::addInt32(int32_t value, uint32_t& op_idx) {
+  TENSOROPT_RETURN_IF_ERROR(addOperand(ANEURALNETWORKS_INT32, {}, op_idx));
+  return ANeuralNetworksModel_setOperandValue(model, op_idx, &value,
+                                              sizeof(value));
+}
+
+ResultCode ModelBuilder::addFloat32(float value, uint32_t& op_idx) {
+  TENSOROPT_RETURN_IF_ERROR(addOperand(ANEURALNETWORKS_FLOAT32, {}, op_idx));
+  return ANeuralNetworksModel_setOperandValue(model, op_idx, &value,
+                                              sizeof(value));
+}
+
+ResultCode ModelBuilder::addBool(bool value, uint32_t& op_idx) {
+  TENSOROPT_RETURN_IF_ERROR(addOperand(ANEURALNETWORKS_BOOL, {}, op_idx));
+  uint8_t byte_value = value;
+  return ANeuralNetworksModel_setOperandValue(model, op_idx, &byte_value,
+                                              sizeof(byte_value));
+}
+
+ResultCode ModelBuilder::addInt32Vector(const std::vector<int32_t>& values,
+                                        uint32_t& op_idx) {
+  TENSOROPT_RETURN_IF_ERROR(addOperand(
+      ANEURALNETWORKS_TENSOR_INT32,
+      {static_cast<uint32_t>(values.size())}, op_idx));
+  // Small vectors are copied by the model
+  return ANeuralNetworksModel_setOperandValue(
+      model, op_idx, values.data(), values.size() * sizeof(int32_t));
+}
+
+ResultCode ModelBuilder::addWeights(const std::vector<uint32_t>& dims,
+                                    float range, ZooTensor& out) {
+  out.dims = dims;
+  TENSOROPT_RETURN_IF_ERROR(
+      addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, dims, out.idx));
+  std::size_t size = 1;
+  for (auto dim : dims) {
+    size *= dim;
+  }
+  auto values_it = next_weights;
+  if (next_weights != weights.end() && next_weights->size() == size) {
+    ++next_weights;
+  } else {
+    std::uniform_real_distribution<float> distribution(-range, range);
+    values_it = weights.emplace(next_weights, size);
+    std::generate(values_it->begin(), values_it->end(),
+                  [&]() { return distribution(engine); });
+  }
+  return ANeuralNetworksModel_setOperandValue(model, out.idx, values_it->data(),
+                                              size * sizeof(float));
+}
+
+ResultCode ModelBuilder::addInput(const std::vector<uint32_t>& dims,
+                                  ZooTensor& out) {
+  out.dims = dims;
+  TENSOROPT_RETURN_IF_ERROR(
+      addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, dims, out.idx));
+  inputs.push_back(out.idx);
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode ModelBuilder::addOperation(ANeuralNetworksOperationType op_type,
+                                      const std::vector<uint32_t>& op_inputs,
+                                      const std::vector<uint32_t>& out_dims,
+                                      ZooTensor& out) {
+  out.dims = out_dims;
+  TENSOROPT_RETURN_IF_ERROR(
+      addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, out_dims, out.idx));
+  return ANeuralNetworksModel_addOperation(
+      model, op_type, static_cast<uint32_t>(op_inputs.size()),
+      op_inputs.data(), 1, &out.idx);
+}
+
+ResultCode ModelBuilder::identifyInputsAndOutputs(
+    const std::vector<ZooTensor>& outputs) {
+  std::vector<uint32_t> output_indices;
+  for (const auto& output : outputs) {
+    output_indices.push_back(output.idx);
+  }
+  return ANeuralNetworksModel_identifyInputsAndOutputs(
+      model, static_cast<uint32_t>(inputs.size()), inputs.data(),
+      static_cast<uint32_t>(output_indices.size()), output_indices.data());
+}
+
+ResultCode ModelBuilder::conv2D(const ZooTensor& in, uint32_t channels,
+                                uint32_t filter_size, uint32_t stride,
+                                int32_t fuse_code, ZooTensor& out) {
+  TENSOROPT_RETURN_IF_ERROR(checkRank(in, 4));
+  auto in_channels = in.dims[3];
+  ZooTensor filter;
+  ZooTensor bias;
+  uint32_t padding_idx;
+  uint32_t stride_idx;
+  uint32_t fuse_idx;
+  TENSOROPT_RETURN_IF_ERROR(addWeights(
+      {channels, filter_size, filter_size, in_channels},
+      getWeightsRange(filter_size * filter_size * in_channels), filter));
+  TENSOROPT_RETURN_IF_ERROR(addWeights({channels}, BIAS_RANGE, bias));
+  TENSOROPT_RETURN_IF_ERROR(
+      addInt32(ANEURALNETWORKS_PADDING_SAME, padding_idx));
+  TENSOROPT_RETURN_IF_ERROR(
+      addInt32(static_cast<int32_t>(stride), stride_idx));
+  TENSOROPT_RETURN_IF_ERROR(addInt32(fuse_code, fuse_idx));
+  return addOperation(ANEURALNETWORKS_CONV_2D,
+                      {in.idx, filter.idx, bias.idx, padding_idx, stride_idx,
+                       stride_idx, fuse_idx},
+                      {in.dims[0], (in.dims[1] + stride - 1) / stride,
+                       (in.dims[2] + stride - 1) / stride, channels},
+                      out);
+}
+
+ResultCode ModelBuilder::depthwiseConv2D(const ZooTensor& in,
+                                         uint32_t filter_size, uint32_t stride,
+                                         int32_t fuse_code, ZooTensor& out) {
+  TENSOROPT_RETURN_IF_ERROR(checkRank(in, 4));
+  auto channels = in.dims[3];
+  ZooTensor filter;
+  ZooTensor bias;
+  uint32_t padding_idx;
+  uint32_t stride_idx;
+  uint32_t multiplier_idx;
+  uint32_t fuse_idx;
+  TENSOROPT_RETURN_IF_ERROR(
+      addWeights({channels, filter_size, filter_size, 1},
+                 getWeightsRange(filter_size * filter_size), filter));
+  TENSOROPT_RETURN_IF_ERROR(addWeights({channels}, BIAS_RANGE, bias));
+  TENSOROPT_RETURN_IF_ERROR(
+      addInt32(ANEURALNETWORKS_PADDING_SAME, padding_idx));
+  TENSOROPT_RETURN_IF_ERROR(
+      addInt32(static_cast<int32_t>(stride), stride_idx));
+  TENSOROPT_RETURN_IF_ERROR(addInt32(1, multiplier_idx));
+  TENSOROPT_RETURN_IF_ERROR(addInt32(fuse_code, fuse_idx));
+  return addOperation(ANEURALNETWORKS_DEPTHWISE_CONV_2D,
+                      {in.idx, filter.idx, bias.idx, padding_idx, stride_idx,
+                       stride_idx, multiplier_idx, fuse_idx},
+                      {in.dims[0], (in.dims[1] + stride - 1) / stride,
+                       (in.dims[2] + stride - 1) / stride, channels},
+                      out);
+}
+
+ResultCode ModelBuilder::maxPool2D(const ZooTensor& in, uint32_t filter_size,
+                                   uint32_t stride, ZooTensor& out) {
+  TENSOROPT_RETURN_IF_ERROR(checkRank(in, 4));
+  uint32_t padding_idx;
+  uint32_t stride_idx;
+  uint32_t filter_idx;
+  TENSOROPT_RETURN_IF_ERROR(
+      addInt32(ANEURALNETWORKS_PADDING_SAME, padding_idx));
+  TENSOROPT_RETURN_IF_ERROR(
+      addInt32(static_cast<int32_t>(stride), stride_idx));
+  TENSOROPT_RETURN_IF_ERROR(
+      addInt32(static_cast<int32_t>(filter_size), filter_idx));
+  return addOperation(ANEURALNETWORKS_MAX_POOL_2D,
+                      {in.idx, padding_idx, stride_idx, stride_idx,
+                       filter_idx, filter_idx},
+                      {in.dims[0], (in.dims[1] + stride - 1) / stride,
+                       (in.dims[2] + stride - 1) / stride, in.dims[3]},
+                      out);
+}
+
+ResultCode ModelBuilder::globalAveragePool(const ZooTensor& in,
+                                           ZooTensor& out) {
+  TENSOROPT_RETURN_IF_ERROR(checkRank(in, 4));
+  uint32_t padding_idx;
+  uint32_t stride_idx;
+  uint32_t filter_w_idx;
+  uint32_t filter_h_idx;
+  uint32_t shape_idx;
+  ZooTensor pooled;
+  TENSOROPT_RETURN_IF_ERROR(
+      addInt32(ANEURALNETWORKS_PADDING_VALID, padding_idx));
+  TENSOROPT_RETURN_IF_ERROR(addInt32(1, stride_idx));
+  TENSOROPT_RETURN_IF_ERROR(
+      addInt32(static_cast<int32_t>(in.dims[2]), filter_w_idx));
+  TENSOROPT_RETURN_IF_ERROR(
+      addInt32(static_cast<int32_t>(in.dims[1]), filter_h_idx));
+  TENSOROPT_RETURN_IF_ERROR(addOperation(
+      ANEURALNETWORKS_AVERAGE_POOL_2D,
+      {in.idx, padding_idx, stride_idx, stride_idx, filter_w_idx,
+       filter_h_idx},
+      {in.dims[0], 1, 1, in.dims[3]}, pooled));
+  TENSOROPT_RETURN_IF_ERROR(addInt32Vector(
+      {static_cast<int32_t>(in.dims[0]), static_cast<int32_t>(in.dims[3])},
+      shape_idx));
+  return addOperation(ANEURALNETWORKS_RESHAPE, {pooled.idx, shape_idx},
+                      {in.dims[0], in.dims[3]}, out);
+}
+
+ResultCode ModelBuilder::fullyConnected(const ZooTensor& in, uint32_t units,
+                                        int32_t fuse_code, ZooTensor& out) {
+  TENSOROPT_RETURN_IF_ERROR(checkRank(in, 2));
+  ZooTensor matrix;
+  ZooTensor bias;
+  ZooTensor product;
+  TENSOROPT_RETURN_IF_ERROR(
+      addWeights({in.dims[1], units}, getWeightsRange(in.dims[1]), matrix));
+  TENSOROPT_RETURN_IF_ERROR(addWeights({units}, BIAS_RANGE, bias));
+  TENSOROPT_RETURN_IF_ERROR(matmul(in, matrix, product));
+  return add(product, bias, fuse_code, out);
+}
+
+ResultCode ModelBuilder::add(const ZooTensor& lhs, const ZooTensor& rhs,
+                             int32_t fuse_code, ZooTensor& out) {
+  // Only broadcast the rhs to keep the output shape simple
+  uint32_t fuse_idx;
+  TENSOROPT_RETURN_IF_ERROR(addInt32(fuse_code, fuse_idx));
+  return addOperation(ANEURALNETWORKS_ADD, {lhs.idx, rhs.idx, fuse_idx},
+                      lhs.dims, out);
+}
+
+ResultCode ModelBuilder::matmul(const ZooTensor& lhs, const ZooTensor& rhs,
+                                ZooTensor& out) {
+  TENSOROPT_RETURN_IF_ERROR(checkRank(lhs, 2));
+  TENSOROPT_RETURN_IF_ERROR(checkRank(rhs, 2));
+  uint32_t transpose_idx;
+  TENSOROPT_RETURN_IF_ERROR(addBool(false, transpose_idx));
+  return addOperation(ANEURALNETWORKS_MATMUL,
+                      {lhs.idx, rhs.idx, transpose_idx, transpose_idx},
+                      {lhs.dims[0], rhs.dims[1]}, out);
+}
+
+ResultCode ModelBuilder::softmax(const ZooTensor& in, float beta,
+                                 ZooTensor& out) {
+  uint32_t beta_idx;
+  TENSOROPT_RETURN_IF_ERROR(addFloat32(beta, beta_idx));
+  return addOperation(ANEURALNETWORKS_SOFTMAX, {in.idx, beta_idx}, in.dims,
+                      out);
+}
+
+ResultCode ModelBuilder::transpose(const ZooTensor& in,
+                                   const std::vector<int32_t>& perm,
+                                   ZooTensor& out) {
+  TENSOROPT_RETURN_IF_ERROR(checkRank(in, perm.size()));
+  uint32_t perm_idx;
+  std::vector<uint32_t> out_dims;
+  for (auto axis : perm) {
+    out_dims.push_back(in.dims[static_cast<std::size_t>(axis)]);
+  }
+  TENSOROPT_RETURN_IF_ERROR(addInt32Vector(perm, perm_idx));
+  return addOperation(ANEURALNETWORKS_TRANSPOSE, {in.idx, perm_idx}, out_dims,
+                      out);
+}
+
+ResultCode ModelBuilder::concatenation(const std::vector<ZooTensor>& inputs,
+                                       int32_t axis, ZooTensor& out) {
+  TENSOROPT_RETURN_IF_COND(inputs.empty(), "Error: no inputs to concatenate",
+                           ANEURALNETWORKS_BAD_DATA);
+  auto uaxis = static_cast<std::size_t>(axis);
+  std::vector<uint32_t> op_inputs;
+  auto out_dims = inputs.front().dims;
+  out_dims[uaxis] = 0;
+  for (const auto& input : inputs) {
+    op_inputs.push_back(input.idx);
+    out_dims[uaxis] += input.dims[uaxis];
+  }
+  uint32_t axis_idx;
+  TENSOROPT_RETURN_IF_ERROR(addInt32(axis, axis_idx));
+  op_inputs.push_back(axis_idx);
+  return addOperation(ANEURALNETWORKS_CONCATENATION, op_inputs, out_dims, out);
+}
+
+ResultCode buildMobileNetV1(ModelBuilder& builder,
+                            const MobileNetConfig& config) {
+  // Number of output channels and stride of the depthwise separable
+  // convolutions
+  const std::vector<std::pair<uint32_t, uint32_t>> blocks{
+      {64, 1},  {128, 2}, {128, 1}, {256, 2}, {256, 1},
+      {512, 2}, {512, 1}, {512, 1}, {512, 1}, {512, 1},
+      {512, 1}, {1024, 2}, {1024, 1}};
+  ZooTensor x;
+  TENSOROPT_RETURN_IF_ERROR(builder.addInput(
+      {config.batch, config.image_size, config.image_size, 3}, x));
+  TENSOROPT_RETURN_IF_ERROR(builder.conv2D(
+      x, scaleChannels(32, config.width_multiplier), 3, 2,
+      ANEURALNETWORKS_FUSED_RELU6, x));
+  for (const auto& block : blocks) {
+    TENSOROPT_RETURN_IF_ERROR(builder.depthwiseConv2D(
+        x, 3, block.second, ANEURALNETWORKS_FUSED_RELU6, x));
+    TENSOROPT_RETURN_IF_ERROR(builder.conv2D(
+        x, scaleChannels(block.first, config.width_multiplier), 1, 1,
+        ANEURALNETWORKS_FUSED_RELU6, x));
+  }
+  TENSOROPT_RETURN_IF_ERROR(builder.globalAveragePool(x, x));
+  return addClassifier(builder, x, config.num_classes);
+}
+
+ResultCode buildMobileNetV2(ModelBuilder& builder,
+                            const MobileNetConfig& config) {
+  struct InvertedResidual {
+    uint32_t expansion;
+    uint32_t channels;
+    uint32_t repeats;
+    uint32_t stride;
+  };
+  const std::vector<InvertedResidual> blocks{
+      {1, 16, 1, 1}, {6, 24, 2, 2},  {6, 32, 3, 2}, {6, 64, 4, 2},
+      {6, 96, 3, 1}, {6, 160, 3, 2}, {6, 320, 1, 1}};
+  ZooTensor x;
+  TENSOROPT_RETURN_IF_ERROR(builder.addInput(
+      {config.batch, config.image_size, config.image_size, 3}, x));
+  TENSOROPT_RETURN_IF_ERROR(builder.conv2D(
+      x, scaleChannels(32, config.width_multiplier), 3, 2,
+      ANEURALNETWORKS_FUSED_RELU6, x));
+  for (const auto& block : blocks) {
+    auto channels = scaleChannels(block.channels, config.width_multiplier);
+    for (uint32_t i = 0; i < block.repeats; ++i) {
+      uint32_t stride = i == 0 ? block.stride : 1;
+      ZooTensor y = x;
+      if (block.expansion != 1) {
+        TENSOROPT_RETURN_IF_ERROR(
+            builder.conv2D(y, x.dims[3] * block.expansion, 1, 1,
+                           ANEURALNETWORKS_FUSED_RELU6, y));
+      }
+      TENSOROPT_RETURN_IF_ERROR(builder.depthwiseConv2D(
+          y, 3, stride, ANEURALNETWORKS_FUSED_RELU6, y));
+      // The projection is linear
+      TENSOROPT_RETURN_IF_ERROR(
+          builder.conv2D(y, channels, 1, 1, ANEURALNETWORKS_FUSED_NONE, y));
+      if (stride == 1 && x.dims[3] == channels) {
+        TENSOROPT_RETURN_IF_ERROR(
+            builder.add(x, y, ANEURALNETWORKS_FUSED_NONE, y));
+      }
+      x = y;
+    }
+  }
+  TENSOROPT_RETURN_IF_ERROR(builder.conv2D(
+      x, scaleChannels(1280, std::max(config.width_multiplier, 1.f)), 1, 1,
+      ANEURALNETWORKS_FUSED_RELU6, x));
+  TENSOROPT_RETURN_IF_ERROR(builder.globalAveragePool(x, x));
+  return addClassifier(builder, x, config.num_classes);
+}
+
+ResultCode buildResNet(ModelBuilder& builder, const ResNetConfig& config) {
+  ZooTensor x;
+  TENSOROPT_RETURN_IF_ERROR(builder.addInput(
+      {config.batch, config.image_size, config.image_size, 3}, x));
+  TENSOROPT_RETURN_IF_ERROR(builder.conv2D(x, config.base_channels, 7, 2,
+                                           ANEURALNETWORKS_FUSED_RELU, x));
+  TENSOROPT_RETURN_IF_ERROR(builder.maxPool2D(x, 3, 2, x));
+  for (std::size_t stage = 0; stage < config.blocks_per_stage.size();
+       ++stage) {
+    uint32_t channels = config.base_channels << stage;
+    for (uint32_t i = 0; i < config.blocks_per_stage[stage]; ++i) {
+      uint32_t stride = stage > 0 && i == 0 ? 2 : 1;
+      ZooTensor shortcut = x;
+      ZooTensor y;
+      if (stride != 1 || x.dims[3] != channels) {
+        TENSOROPT_RETURN_IF_ERROR(builder.conv2D(
+            x, channels, 1, stride, ANEURALNETWORKS_FUSED_NONE, shortcut));
+      }
+      TENSOROPT_RETURN_IF_ERROR(builder.conv2D(
+          x, channels, 3, stride, ANEURALNETWORKS_FUSED_RELU, y));
+      TENSOROPT_RETURN_IF_ERROR(
+          builder.conv2D(y, channels, 3, 1, ANEURALNETWORKS_FUSED_NONE, y));
+      TENSOROPT_RETURN_IF_ERROR(
+          builder.add(y, shortcut, ANEURALNETWORKS_FUSED_RELU, x));
+    }
+  }
+  TENSOROPT_RETURN_IF_ERROR(builder.globalAveragePool(x, x));
+  return addClassifier(builder, x, config.num_classes);
+}
+
+ResultCode buildTransformerEncoder(ModelBuilder& builder,
+                                   const TransformerConfig& config) {
+  TENSOROPT_RETURN_IF_COND(
+      config.num_heads == 0 || config.model_size % config.num_heads != 0,
+      "Error: model size " << config.model_size
+                           << " is not divisible by the number of heads "
+                           << config.num_heads,
+      ANEURALNETWORKS_BAD_DATA);
+  auto head_size = config.model_size / config.num_heads;
+  auto beta = 1.f / std::sqrt(static_cast<float>(head_size));
+  ZooTensor x;
+  TENSOROPT_RETURN_IF_ERROR(
+      builder.addInput({config.sequence_length, config.model_size}, x));
+  for (uint32_t layer = 0; layer < config.num_layers; ++layer) {
+    // Each head is computed with rank 2 tensors as MATMUL is not batched
+    std::vector<ZooTensor> heads(config.num_heads);
+    for (auto& head : heads) {
+      ZooTensor query;
+      ZooTensor key;
+      ZooTensor value;
+      ZooTensor key_t;
+      ZooTensor scores;
+      TENSOROPT_RETURN_IF_ERROR(builder.fullyConnected(
+          x, head_size, ANEURALNETWORKS_FUSED_NONE, query));
+      TENSOROPT_RETURN_IF_ERROR(builder.fullyConnected(
+          x, head_size, ANEURALNETWORKS_FUSED_NONE, key));
+      TENSOROPT_RETURN_IF_ERROR(builder.fullyConnected(
+          x, head_size, ANEURALNETWORKS_FUSED_NONE, value));
+      TENSOROPT_RETURN_IF_ERROR(builder.transpose(key, {1, 0}, key_t));
+      TENSOROPT_RETURN_IF_ERROR(builder.matmul(query, key_t, scores));
+      TENSOROPT_RETURN_IF_ERROR(builder.softmax(scores, beta, scores));
+      TENSOROPT_RETURN_IF_ERROR(builder.matmul(scores, value, head));
+    }
+    ZooTensor attention = heads.front();
+    if (heads.size() > 1) {
+      TENSOROPT_RETURN_IF_ERROR(builder.concatenation(heads, 1, attention));
+    }
+    TENSOROPT_RETURN_IF_ERROR(builder.fullyConnected(
+        attention, config.model_size, ANEURALNETWORKS_FUSED_NONE, attention));
+    TENSOROPT_RETURN_IF_ERROR(
+        builder.add(x, attention, ANEURALNETWORKS_FUSED_NONE, x));
+    ZooTensor hidden;
+    TENSOROPT_RETURN_IF_ERROR(builder.fullyConnected(
+        x, config.feed_forward_size, ANEURALNETWORKS_FUSED_RELU, hidden));
+    TENSOROPT_RETURN_IF_ERROR(builder.fullyConnected(
+        hidden, config.model_size, ANEURALNETWORKS_FUSED_NONE, hidden));
+    TENSOROPT_RETURN_IF_ERROR(
+        builder.add(x, hidden, ANEURALNETWORKS_FUSED_NONE, x));
+  }
+  return builder.identifyInputsAndOutputs({x});
+}
+
+ResultCode buildMlp(ModelBuilder& builder, const MlpConfig& config) {
+  ZooTensor x;
+  TENSOROPT_RETURN_IF_ERROR(
+      builder.addInput({config.batch, config.input_size}, x));
+  for (auto hidden_size : config.hidden_sizes) {
+    TENSOROPT_RETURN_IF_ERROR(builder.fullyConnected(
+        x, hidden_size, ANEURALNETWORKS_FUSED_RELU, x));
+  }
+  return addClassifier(builder, x, config.num_classes);
+}
@@ -0,0 +1,220 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef TENSOROPT_MODEL_ZOO_MODEL_ZOO_HPP
+#define TENSOROPT_MODEL_ZOO_MODEL_ZOO_HPP
+
+#include <list>
+#include <random>
+#include <vector>
+
+#include <tensoropt/tensoropt.hpp>
+
+/**
+ * Synthetic networks built with the public ANeuralNetworksModel_* API.
+ * The networks follow the structure of well-known models but their weights
+ * are random so they are only useful for benchmarking and testing.
+ */
+
+/**
+ * Float tensor operand of a model being built.
+ */
+struct ZooTensor {
+  uint32_t idx;
+  std::vector<uint32_t> dims;
+};
+
+/**
+ * Add operands and operations to a model.
+ * Constant weights are uniformly distributed and owned by the builder which
+ * must outlive any compilation of the model.
+ */
+class ModelBuilder {
+ public:
+  explicit ModelBuilder(ANeuralNetworksModel* model, uint32_t seed = 0);
+
+  ModelBuilder(const ModelBuilder&) = delete;
+  ModelBuilder& operator=(const ModelBuilder&) = delete;
+
+  ResultCode addOperand(ANeuralNetworksOperandCode op_code,
+                        const std::vector<uint32_t>& dims, uint32_t& op_idx);
+
+  ResultCode addInt32(int32_t value, uint32_t& op_idx);
+
+  ResultCode addFloat32(float value, uint32_t& op_idx);
+
+  ResultCode addBool(bool value, uint32_t& op_idx);
+
+  ResultCode addInt32Vector(const std::vector<int32_t>& values,
+                            uint32_t& op_idx);
+
+  /**
+   * Add a constant tensor with random values in [-range, range].
+   */
+  ResultCode addWeights(const std::vector<uint32_t>& dims, float range,
+                        ZooTensor& out);
+
+  /**
+   * Add a tensor that will be identified as an input of the model.
+   */
+  ResultCode addInput(const std::vector<uint32_t>& dims, ZooTensor& out);
+
+  /**
+   * Add an operation with a single float output of shape out_dims.
+   */
+  ResultCode addOperation(ANeuralNetworksOperationType op_type,
+                          const std::vector<uint32_t>& inputs,
+                          const std::vector<uint32_t>& out_dims,
+                          ZooTensor& out);
+
+  /**
+   * Identify the inputs added with addInput and the given outputs.
+   * The model still has to be finished.
+   */
+  ResultCode identifyInputsAndOutputs(const std::vector<ZooTensor>& outputs);
+
+  /**
+   * Add a CONV_2D with SAME padding and a random bias.
+   */
+  ResultCode conv2D(const ZooTensor& in, uint32_t channels,
+                    uint32_t filter_size, uint32_t stride, int32_t fuse_code,
+                    ZooTensor& out);
+
+  /**
+   * Add a DEPTHWISE_CONV_2D with SAME padding, a depth multiplier of 1 and a
+   * random bias.
+   */
+  ResultCode depthwiseConv2D(const ZooTensor& in, uint32_t filter_size,
+                             uint32_t stride, int32_t fuse_code,
+                             ZooTensor& out);
+
+  /**
+   * Add a MAX_POOL_2D with SAME padding.
+   */
+  ResultCode maxPool2D(const ZooTensor& in, uint32_t filter_size,
+                       uint32_t stride, ZooTensor& out);
+
+  /**
+   * Average the height and width of a NHWC tensor and reshape it to a
+   * [N, C] tensor.
+   */
+  ResultCode globalAveragePool(const ZooTensor& in, ZooTensor& out);
+
+  /**
+   * Multiply a [N, K] tensor with random [K, units] weights and add a random
+   * bias.
+   */
+  ResultCode fullyConnected(const ZooTensor& in, uint32_t units,
+                            int32_t fuse_code, ZooTensor& out);
+
+  ResultCode add(const ZooTensor& lhs, const ZooTensor& rhs,
+                 int32_t fuse_code, ZooTensor& out);
+
+  ResultCode matmul(const ZooTensor& lhs, const ZooTensor& rhs, ZooTensor& out);
+
+  ResultCode softmax(const ZooTensor& in, float beta, ZooTensor& out);
+
+  ResultCode transpose(const ZooTensor& in, const std::vector<int32_t>& perm,
+                       ZooTensor& out);
+
+  ResultCode concatenation(const std::vector<ZooTensor>& inputs, int32_t axis,
+                           ZooTensor& out);
+
+  ANeuralNetworksModel* getModel() { return model; }
+
+  /**
+   * Start adding operands to another model. The weights generated so far are
+   * reused in the same order by the weights of the same size so that building
+   * the same graph again does not generate new values.
+   */
+  void reset(ANeuralNetworksModel* new_model);
+
+ private:
+  ANeuralNetworksModel* model;
+  std::mt19937 engine;
+  std::list<std::vector<float>> weights;
+  // Next weights that can be reused by addWeights
+  std::list<std::vector<float>>::iterator next_weights;
+  std::vector<uint32_t> inputs;
+};
+
+struct MobileNetConfig {
+  uint32_t batch = 1;
+  uint32_t image_size = 224;
+  // Multiplier applied to the number of channels of every layer
+  float width_multiplier = 1.f;
+  uint32_t num_classes = 1000;
+};
+
+struct ResNetConfig {
+  uint32_t batch = 1;
+  uint32_t image_size = 224;
+  uint32_t base_channels = 64;
+  // Number of basic blocks of each stage, the default is ResNet-18
+  std::vector<uint32_t> blocks_per_stage{2, 2, 2, 2};
+  uint32_t num_classes = 1000;
+};
+
+struct TransformerConfig {
+  uint32_t sequence_length = 128;
+  uint32_t model_size = 256;
+  uint32_t num_heads = 4;
+  uint32_t feed_forward_size = 1024;
+  uint32_t num_layers = 4;
+};
+
+struct MlpConfig {
+  uint32_t batch = 1;
+  uint32_t input_size = 784;
+  std::vector<uint32_t> hidden_sizes{512, 512};
+  uint32_t num_classes = 10;
+};
+
+/**
+ * Build a MobileNet V1 made of a strided CONV_2D followed by 13 depthwise
+ * separable convolutions and a classifier.
+ * The output is the [batch, num_classes] result of a SOFTMAX.
+ */
+ResultCode buildMobileNetV1(ModelBuilder& builder,
+                            const MobileNetConfig& config);
+
+/**
+ * Build a MobileNet V2 made of 17 inverted residual blocks and a classifier.
+ * The output is the [batch, num_classes] result of a SOFTMAX.
+ */
+ResultCode buildMobileNetV2(ModelBuilder& builder,
+                            const MobileNetConfig& config);
+
+/**
+ * Build a ResNet made of stages of basic residual blocks and a classifier.
+ * The output is the [batch, num_classes] result of a SOFTMAX.
+ */
+ResultCode buildResNet(ModelBuilder& builder, const ResNetConfig& config);
+
+/**
+ * Build a transformer encoder with multi-head self-attention layers.
+ * The input and output are [sequence_length, model_size] tensors.
+ * Layer normalizations are not included.
+ */
+ResultCode buildTransformerEncoder(ModelBuilder& builder,
+                                   const TransformerConfig& config);
+
+/**
+ * Build a multi-layer perceptron with RELU activations.
+ * The output is the [batch, num_classes] result of a SOFTMAX.
+ */
+ResultCode buildMlp(ModelBuilder& builder, const MlpConfig& config);
+
+#endif  // TENSOROPT_MODEL_ZOO_MODEL_ZOO_HPP
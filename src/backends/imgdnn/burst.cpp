@@ -0,0 +1,48 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "backends/imgdnn/burst.hpp"
+#include "backends/imgdnn/compilation.hpp"
+#include "common/trace.hpp"
+
+ResultCode ANeuralNetworksBurst_create(ANeuralNetworksCompilation* compilation,
+                                       ANeuralNetworksBurst** burst) {
+  TENSOROPT_TRACE_API();
+  TENSOROPT_RETURN_IF_NULL(compilation);
+  TENSOROPT_RETURN_IF_NULL(burst);
+  TENSOROPT_RETURN_IF_UNFINISHED(compilation);
+  TENSOROPT_RETURN_IF_COND(compilation->has_dynamic_inputs,
+                           "Error: bursts do not support dynamic inputs",
+                           ANEURALNETWORKS_BAD_DATA);
+  imgdnn_err_code ret;
+  imgdnn_binding binding;
+  BACKEND_CALL_RET(binding, imgdnnCreateBinding, &ret);
+  IMGDNN_RETURN_ERR_IF_ERROR(ret);
+  *burst = new ANeuralNetworksBurst();
+  (*burst)->compilation = compilation;
+  (*burst)->imgdnn_context_ = compilation->imgdnn_context_;
+  (*burst)->imgdnn_binding_ = binding;
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+void ANeuralNetworksBurst_free(ANeuralNetworksBurst* burst) {
+  TENSOROPT_TRACE_API();
+  if (!burst) {
+    return;
+  }
+  BACKEND_CALL(imgdnnBindingDestroy, burst->imgdnn_binding_);
+  clearMemoryCache(burst->memory_cache);
+  delete burst;
+}
@@ -0,0 +1,38 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef SRC_BACKENDS_IMGDNN_BURST_HPP
+#define SRC_BACKENDS_IMGDNN_BURST_HPP
+
+#include <mutex>
+
+#include "backends/imgdnn/backend.hpp"
+#include "backends/imgdnn/memory_cache.hpp"
+#include "tensoropt/burst.hpp"
+
+struct ANeuralNetworksBurst {
+  const ANeuralNetworksCompilation* compilation;  // weak_ptr
+  std::mutex mutex;
+
+  // Memories imported by the previous computations, including the memories
+  // of the accessors, destroyed with the burst
+  MemoryCache memory_cache;
+
+  // IMGDNN specifics
+  imgdnn_context imgdnn_context_;
+  imgdnn_binding imgdnn_binding_;
+};
+
+#endif  // SRC_BACKENDS_IMGDNN_BURST_HPP
@@ -15,15 +15,177 @@
  */
 #include "backends/imgdnn/compilation.hpp"
 #include "backends/imgdnn/convert.hpp"
+#include "backends/imgdnn/network_object_registry.hpp"
 #include "common/device.hpp"
 #include "common/model.hpp"
+#include "common/passes/graph_utils.hpp"
+#include "common/passes/passes.hpp"
+#include "common/sha256.hpp"
+#include "common/shape_inference.hpp"
+#include "common/trace.hpp"
+#include "common/utils.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
 #include <fstream>
+#include <iomanip>
+#include <random>
 #include <sstream>
 #include <streambuf>
 
+/**
+ * Number of specialised compilations kept by default for a model with dynamic
+ * inputs, see ANeuralNetworksCompilation_setMaxSpecialisations.
+ */
+static constexpr std::size_t DEFAULT_MAX_SPECIALISATIONS = 8;
+
+/**
+ * Write each byte in hexadecimal so that a token always maps to a valid file
+ * name.
+ */
+static void writeHexToken(std::ostream& os, const uint8_t* token) {
+  os << std::hex << std::setfill('0');
+  for (unsigned i = 0; i < BYTE_SIZE_OF_CACHE_TOKEN; ++i) {
+    os << std::setw(2) << static_cast<unsigned>(token[i]);
+  }
+}
+
+/**
+ * Read the whole file at path into data.
+ * Return false if the file could not be read.
+ */
+static bool readCacheFile(const std::string& path, std::vector<char>& data) {
+  std::ifstream file(path, std::ios::in | std::ios::binary);
+  if (!file.good()) {
+    return false;
+  }
+  std::ostringstream buffer;
+  buffer << file.rdbuf();
+  const std::string& file_str(buffer.str());
+  data.assign(file_str.begin(), file_str.end());
+  return !data.empty();
+}
+
+/**
+ * Write data to path atomically.
+ * The data is first written to a temporary file in the same directory which is
+ * then renamed so that concurrent processes never read a partial binary.
+ * Return false if the file could not be written.
+ */
+static bool writeCacheFile(const std::string& path, const void* data,
+                           std::size_t data_size) {
+  std::stringstream ss;
+  ss << path << ".tmp" << std::random_device()();
+  const std::string tmp_path = ss.str();
+  {
+    std::ofstream file(tmp_path,
+                       std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write(static_cast<const char*>(data),
+               static_cast<std::streamsize>(data_size));
+    if (!file.good()) {
+      VLOG_AT("Warning: could not write cache file " << tmp_path);
+      std::remove(tmp_path.c_str());
+      return false;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    VLOG_AT("Warning: could not rename cache file " << tmp_path << " to "
+                                                     << path);
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Convert the model to an IMGDNN network if it was not done already.
+ */
+static ResultCode convertModelOnce(ANeuralNetworksCompilation* compilation) {
+  if (!compilation->converted) {
+    TENSOROPT_RETURN_IF_ERROR(convertModel(compilation));
+    compilation->converted = true;
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+/**
+ * Create the network binary of the converted model.
+ */
+static ResultCode createNetworkBinary(ANeuralNetworksCompilation* compilation) {
+  using statistics_clock_t = ANeuralNetworksCompilation::statistics_clock_t;
+  auto start = statistics_clock_t::now();
+  imgdnn_err_code ret;
+  BACKEND_CALL_RET(compilation->imgdnn_binary_, imgdnnCreateNetworkBinary,
+                   compilation->imgdnn_device_, compilation->imgdnn_context_,
+                   compilation->imgdnn_network_,
+                   static_cast<unsigned>(compilation->imgdnn_inputs_.size()),
+                   compilation->imgdnn_inputs_.data(),
+                   static_cast<unsigned>(compilation->imgdnn_outputs_.size()),
+                   compilation->imgdnn_outputs_.data(),
+                   compilation->imgdnn_flags_,
+                   compilation->imgdnn_options_.c_str(), &ret);
+  if (ret != IMGDNN_SUCCESS) {
+    // Make sure ANeuralNetworksCompilation_free does not destroy the binary
+    compilation->imgdnn_binary_ = {0, nullptr};
+  }
+  IMGDNN_RETURN_ERR_IF_ERROR(ret);
+  compilation->durations
+      [ANEURALNETWORKS_COMPILATION_DURATION_CREATE_NETWORK_BINARY] =
+      getNanoseconds(start, statistics_clock_t::now());
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+/**
+ * Try to load the network object from the cache directory.
+ * Return false if there is no valid cached binary for this compilation.
+ */
+static bool loadCachedNetworkObject(ANeuralNetworksCompilation* compilation) {
+  if (compilation->token_path.empty() ||
+      !readCacheFile(compilation->token_path, compilation->cached_file)) {
+    return false;
+  }
+  imgdnn_err_code ret;
+  BACKEND_CALL_RET(compilation->imgdnn_network_object_,
+                   imgdnnLoadNetworkObject, compilation->imgdnn_device_,
+                   compilation->imgdnn_context_,
+                   compilation->cached_file.size(),
+                   compilation->cached_file.data(), &ret);
+  if (ret != IMGDNN_SUCCESS) {
+    // An invalid cache entry, for instance written by an other version of the
+    // DDK, is not an error. The model is compiled again and the entry
+    // overwritten.
+    VLOG_AT("Warning: could not load cached binary "
+            << compilation->token_path << ", error code " << ret);
+    compilation->imgdnn_network_object_ = nullptr;
+    compilation->cached_file.clear();
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Create the network binary and write it to the cache directory.
+ * Failing to create the binary or to write the cache is not an error, the
+ * model is compiled again next time.
+ */
+static void storeCachedNetworkBinary(ANeuralNetworksCompilation* compilation) {
+  // Some versions of the DDK do not support creating binaries
+  if (!compilation->imgdnn_binary_.data &&
+      createNetworkBinary(compilation) != ANEURALNETWORKS_NO_ERROR) {
+    VLOG_AT("Warning: could not create the network binary for "
+            << compilation->token_path);
+    return;
+  }
+  const auto& binary = compilation->imgdnn_binary_;
+  if (binary.data && binary.size > 0) {
+    writeCacheFile(compilation->token_path, binary.data, binary.size);
+  }
+}
+
 ResultCode ANeuralNetworksCompilation_create(
     ANeuralNetworksModel* model, ANeuralNetworksCompilation** compilation) {
+  TENSOROPT_TRACE_API();
   ANeuralNetworksDevice* device = nullptr;
   TENSOROPT_RETURN_IF_ERROR(ANeuralNetworks_getDevice(0, &device));
   TENSOROPT_RETURN_IF_ERROR(ANeuralNetworksCompilation_createForDevices(
@@ -37,6 +199,7 @@ ResultCode ANeuralNetworksCompilation_create(
 ResultCode ANeuralNetworksCompilation_createForDevices(
     ANeuralNetworksModel* model, const ANeuralNetworksDevice* const* devices,
     uint32_t num_devices, ANeuralNetworksCompilation** compilation) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_RETURN_IF_NULL(model);
   TENSOROPT_RETURN_IF_UNFINISHED(model);
 
@@ -51,52 +214,126 @@ ResultCode ANeuralNetworksCompilation_createForDevices(
   (*compilation)->device = rt_device;
 
   imgdnn_err_code ret;
-  auto cl_device = rt_device->queue->get_device().get();
+  (*compilation)->cl_context_ = rt_device->queue->get_context().get();
+  (*compilation)->cl_device_ = rt_device->queue->get_device().get();
   BACKEND_CALL_RET((*compilation)->imgdnn_context_, imgdnnCLCreateContext,
-                   rt_device->queue->get_context().get(), 1, &cl_device,
+                   (*compilation)->cl_context_, 1, &(*compilation)->cl_device_,
                    IMGDNN_CTX_FLAGS_NONE, &(*compilation)->imgdnn_device_,
                    &ret);
   IMGDNN_RETURN_ERR_IF_ERROR(ret);
   (*compilation)->imgdnn_flags_ = IMGDNN_NETWORK_OBJ_FLAG_NONE;
   (*compilation)->imgdnn_binary_ = {0, nullptr};
+  (*compilation)->max_specialisations = DEFAULT_MAX_SPECIALISATIONS;
+  (*compilation)->durations.fill(UINT64_MAX);
   return ANEURALNETWORKS_NO_ERROR;
 }
 
 ResultCode ANeuralNetworksCompilation_setCaching(
     ANeuralNetworksCompilation* compilation, const char* cache_dir,
     const uint8_t* token) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_RETURN_IF_FINISHED(compilation);
   TENSOROPT_RETURN_IF_NULL(cache_dir);
-  TENSOROPT_RETURN_IF_NULL(token);
+  static_assert(static_cast<int>(BYTE_SIZE_OF_MODEL_HASH) ==
+                    static_cast<int>(BYTE_SIZE_OF_CACHE_TOKEN),
+                "The model hash must be usable as a cache token");
+  if (!token) {
+    token = compilation->model->hash.data();
+  }
   std::string str_cache_dir(cache_dir);
   std::stringstream ss;
   ss << str_cache_dir;
   if (str_cache_dir.back() != '/') {
     ss << '/';
   }
-  ss << token[0];
-  for (unsigned i = 1; i < BYTE_SIZE_OF_CACHE_TOKEN; ++i) {
-    ss << '_' << token[i];
-  }
+  writeHexToken(ss, token);
   compilation->token_path = ss.str();
   return ANEURALNETWORKS_NO_ERROR;
 }
 
 ResultCode ANeuralNetworksCompilation_setPreference(ANeuralNetworksCompilation*,
                                                     int32_t) {
+  TENSOROPT_TRACE_API();
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode ANeuralNetworksCompilation_setMaxSpecialisations(
+    ANeuralNetworksCompilation* compilation, uint32_t max_specialisations) {
+  TENSOROPT_TRACE_API();
+  TENSOROPT_RETURN_IF_NULL(compilation);
+  TENSOROPT_RETURN_IF_FINISHED(compilation);
+  TENSOROPT_RETURN_IF_COND(max_specialisations == 0,
+                           "Error: at least one specialisation must be kept",
+                           ANEURALNETWORKS_BAD_DATA);
+  compilation->max_specialisations = max_specialisations;
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode ANeuralNetworksCompilation_setDimensionBuckets(
+    ANeuralNetworksCompilation* compilation, int32_t index, uint32_t dimension,
+    const uint32_t* buckets, uint32_t num_buckets) {
+  TENSOROPT_TRACE_API();
+  TENSOROPT_RETURN_IF_NULL(compilation);
+  TENSOROPT_RETURN_IF_FINISHED(compilation);
+  TENSOROPT_TO_UINT32_INDEX(index, uindex);
+  const auto& model = *compilation->model;
+  TENSOROPT_RETURN_IF_COND(uindex >= model.inputs.size(),
+                           "Error: invalid input index " << index,
+                           ANEURALNETWORKS_BAD_DATA);
+  const auto& input_op = model.operands[model.inputs[uindex]];
+  TENSOROPT_RETURN_IF_COND(dimension >= input_op.dimensionCount ||
+                               input_op.dimensions[dimension] != 0,
+                           "Error: dimension " << dimension << " of input "
+                                               << index << " is not dynamic",
+                           ANEURALNETWORKS_BAD_DATA);
+  TENSOROPT_RETURN_IF_COND(num_buckets == 0 || !buckets,
+                           "Error: expected at least one bucket",
+                           ANEURALNETWORKS_BAD_DATA);
+  std::vector<uint32_t> sorted_buckets(buckets, buckets + num_buckets);
+  std::sort(sorted_buckets.begin(), sorted_buckets.end());
+  TENSOROPT_RETURN_IF_COND(sorted_buckets.front() == 0,
+                           "Error: buckets must not be empty",
+                           ANEURALNETWORKS_BAD_DATA);
+  compilation->dimension_buckets[std::make_pair(uindex, dimension)] =
+      std::move(sorted_buckets);
   return ANEURALNETWORKS_NO_ERROR;
 }
 
 ResultCode ANeuralNetworksCompilation_finish(
     ANeuralNetworksCompilation* compilation) {
+  TENSOROPT_TRACE_API();
   if (compilation->finished) {
     return ANEURALNETWORKS_NO_ERROR;
   }
 
-  if (!compilation->serialized) {
-    TENSOROPT_RETURN_IF_ERROR(convertModel(compilation));
+  // The network objects are created once the input shapes are known, see
+  // getSpecialisedCompilation
+  if (hasDynamicInputs(*compilation->model)) {
+    if (!compilation->dimension_buckets.empty()) {
+      compilation->sorted_model = *compilation->model;
+      TENSOROPT_RETURN_IF_ERROR(sortOperations(compilation->sorted_model));
+    }
+    compilation->has_dynamic_inputs = true;
+    compilation->finished = true;
+    return ANEURALNETWORKS_NO_ERROR;
+  }
+
+  // Identical models compiled in this process share the same network object
+  if (acquireSharedNetworkObject(compilation)) {
+    compilation->finished = true;
+    return ANEURALNETWORKS_NO_ERROR;
   }
 
+  if (loadCachedNetworkObject(compilation)) {
+    registerNetworkObject(compilation);
+    compilation->finished = true;
+    return ANEURALNETWORKS_NO_ERROR;
+  }
+
+  TENSOROPT_RETURN_IF_ERROR(convertModelOnce(compilation));
+
+  using statistics_clock_t = ANeuralNetworksCompilation::statistics_clock_t;
+  auto start = statistics_clock_t::now();
   imgdnn_err_code ret;
   BACKEND_CALL_RET(compilation->imgdnn_network_object_,
                    imgdnnCreateNetworkObject, compilation->imgdnn_device_,
@@ -108,62 +345,262 @@ ResultCode ANeuralNetworksCompilation_finish(
                    compilation->imgdnn_flags_,
                    compilation->imgdnn_options_.c_str(), &ret);
   IMGDNN_RETURN_ERR_IF_ERROR(ret);
+  compilation->durations
+      [ANEURALNETWORKS_COMPILATION_DURATION_CREATE_NETWORK_OBJECT] =
+      getNanoseconds(start, statistics_clock_t::now());
+
+  if (!compilation->token_path.empty()) {
+    storeCachedNetworkBinary(compilation);
+  }
 
+  registerNetworkObject(compilation);
   compilation->finished = true;
   return ANEURALNETWORKS_NO_ERROR;
 }
 
+/**
+ * Compute the memory plan of a finished compilation the first time it is
+ * queried.
+ */
+static ResultCode planMemoryOnce(ANeuralNetworksCompilation* compilation) {
+  TENSOROPT_RETURN_IF_UNFINISHED(compilation);
+  TENSOROPT_RETURN_IF_COND(compilation->has_dynamic_inputs,
+                           "Error: the memory plan of a model with dynamic "
+                           "inputs depends on the input shapes",
+                           ANEURALNETWORKS_BAD_STATE);
+  if (compilation->memory_planned) {
+    return ANEURALNETWORKS_NO_ERROR;
+  }
+  // The model is not optimized if the network object was loaded from the
+  // cache or shared. Optimizing it is only worth it if the plan is queried so
+  // it is not done by ANeuralNetworksCompilation_finish.
+  if (!compilation->converted) {
+    compilation->optimized_model = *compilation->model;
+    TENSOROPT_RETURN_IF_ERROR(optimizeModel(compilation->optimized_model));
+  }
+  TENSOROPT_RETURN_IF_ERROR(
+      planMemory(compilation->optimized_model, compilation->memory_plan));
+  compilation->memory_planned = true;
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode ANeuralNetworksCompilation_getArenaSize(
+    ANeuralNetworksCompilation* compilation, std::size_t* arena_size) {
+  TENSOROPT_TRACE_API();
+  TENSOROPT_RETURN_IF_NULL(compilation);
+  TENSOROPT_RETURN_IF_NULL(arena_size);
+  TENSOROPT_RETURN_IF_ERROR(planMemoryOnce(compilation));
+  *arena_size = compilation->memory_plan.arena_size;
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode ANeuralNetworksCompilation_getArenaOffset(
+    ANeuralNetworksCompilation* compilation, uint32_t operand_index,
+    std::size_t* offset) {
+  TENSOROPT_TRACE_API();
+  TENSOROPT_RETURN_IF_NULL(compilation);
+  TENSOROPT_RETURN_IF_NULL(offset);
+  TENSOROPT_RETURN_IF_ERROR(planMemoryOnce(compilation));
+  const auto& offsets = compilation->memory_plan.offsets;
+  auto it = offsets.find(operand_index);
+  TENSOROPT_RETURN_IF_COND(it == offsets.end(),
+                           "Error: operand " << operand_index
+                                             << " is not an intermediate "
+                                                "tensor of the optimized model",
+                           ANEURALNETWORKS_BAD_DATA);
+  *offset = it->second;
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode ANeuralNetworksCompilation_getDuration(
+    const ANeuralNetworksCompilation* compilation, int32_t duration_code,
+    uint64_t* duration) {
+  TENSOROPT_TRACE_API();
+  TENSOROPT_RETURN_IF_NULL(compilation);
+  TENSOROPT_RETURN_IF_NULL(duration);
+  TENSOROPT_RETURN_IF_COND(
+      duration_code < 0 || static_cast<std::size_t>(duration_code) >=
+                               NUM_COMPILATION_DURATIONS,
+      "Error: invalid duration code " << duration_code,
+      ANEURALNETWORKS_BAD_DATA);
+  *duration = compilation->durations[static_cast<std::size_t>(duration_code)];
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode ANeuralNetworksCompilation_getOperationDuration(
+    const ANeuralNetworksCompilation* compilation, int32_t operation_type,
+    uint64_t* duration, uint32_t* count) {
+  TENSOROPT_TRACE_API();
+  TENSOROPT_RETURN_IF_NULL(compilation);
+  TENSOROPT_RETURN_IF_NULL(duration);
+  TENSOROPT_RETURN_IF_NULL(count);
+  auto it = compilation->operation_statistics.find(operation_type);
+  if (it == compilation->operation_statistics.end()) {
+    *duration = 0;
+    *count = 0;
+    return ANEURALNETWORKS_NO_ERROR;
+  }
+  *duration = it->second.duration;
+  *count = it->second.count;
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
 ResultCode ANeuralNetworksCompilation_serialize(
     ANeuralNetworksCompilation* compilation, void** data,
     std::size_t* data_size) {
-  if (!compilation->token_path.empty()) {
-    std::ifstream file(compilation->token_path,
-                       std::ios::in | std::ios::binary | std::ios::ate);
-    if (file.good()) {
-      std::ostringstream buffer;
-      buffer << file.rdbuf();
-      const std::string& file_str(buffer.str());
-      compilation->cached_file.assign(file_str.begin(), file_str.end());
-      *data_size = compilation->cached_file.size();
-      *data = compilation->cached_file.data();
-      return ANEURALNETWORKS_NO_ERROR;
-    }
+  TENSOROPT_TRACE_API();
+  TENSOROPT_RETURN_IF_COND(hasDynamicInputs(*compilation->model),
+                           "Error: a model with dynamic inputs cannot be "
+                           "serialized",
+                           ANEURALNETWORKS_BAD_STATE);
+  if (!compilation->token_path.empty() &&
+      readCacheFile(compilation->token_path, compilation->cached_file)) {
+    *data_size = compilation->cached_file.size();
+    *data = compilation->cached_file.data();
+    return ANEURALNETWORKS_NO_ERROR;
   }
 
-  if (!compilation->finished && !compilation->serialized) {
-    TENSOROPT_RETURN_IF_ERROR(convertModel(compilation));
-  }
+  // The binary may already have been created when writing the cache
+  if (!compilation->imgdnn_binary_.data) {
+    TENSOROPT_RETURN_IF_ERROR(convertModelOnce(compilation));
 
-  imgdnn_err_code ret;
-  BACKEND_CALL_RET(compilation->imgdnn_binary_, imgdnnCreateNetworkBinary,
-                   compilation->imgdnn_device_, compilation->imgdnn_context_,
-                   compilation->imgdnn_network_,
-                   static_cast<unsigned>(compilation->imgdnn_inputs_.size()),
-                   compilation->imgdnn_inputs_.data(),
-                   static_cast<unsigned>(compilation->imgdnn_outputs_.size()),
-                   compilation->imgdnn_outputs_.data(),
-                   compilation->imgdnn_flags_,
-                   compilation->imgdnn_options_.c_str(), &ret);
-  IMGDNN_RETURN_ERR_IF_ERROR(ret);
+    TENSOROPT_RETURN_IF_ERROR(createNetworkBinary(compilation));
+  }
 
   *data = compilation->imgdnn_binary_.data;
   *data_size = compilation->imgdnn_binary_.size;
-  compilation->serialized = true;
   return ANEURALNETWORKS_NO_ERROR;
 }
 
 void ANeuralNetworksCompilation_free(ANeuralNetworksCompilation* compilation) {
+  TENSOROPT_TRACE_API();
   if (!compilation) {
     return;
   }
   if (compilation->imgdnn_binary_.data) {
     BACKEND_CALL(imgdnnNetworkBinaryDestroy, &compilation->imgdnn_binary_);
   }
-  if (compilation->finished) {
-    BACKEND_CALL(imgdnnNetworkObjectDestroy,
-                 compilation->imgdnn_network_object_);
+  // The network is not created if the network object was loaded from the
+  // cache or shared
+  if (compilation->converted) {
     BACKEND_CALL(imgdnnNetworkDestroy, compilation->imgdnn_network_);
   }
-  BACKEND_CALL(imgdnnContextDestroy, compilation->imgdnn_context_);
+  // Specialisations are released first as they may share the device
+  compilation->specialisations.clear();
+  if (compilation->finished && !compilation->has_dynamic_inputs) {
+    releaseNetworkObject(compilation);
+  } else {
+    BACKEND_CALL(imgdnnContextDestroy, compilation->imgdnn_context_);
+  }
   delete compilation;
 }
+
+/**
+ * Compile a copy of the compilation's model where the dynamic input dimensions
+ * are replaced by the given shapes.
+ */
+static ResultCode createSpecialisedCompilation(
+    ANeuralNetworksCompilation* compilation,
+    const ANeuralNetworksCompilation::input_shapes_t& input_shapes,
+    std::shared_ptr<ANeuralNetworksCompilation>& specialised) {
+  const auto& model = *compilation->model;
+  TENSOROPT_RETURN_IF_COND(input_shapes.size() != model.inputs.size(),
+                           "Error: expected " << model.inputs.size()
+                                              << " input shapes but got "
+                                              << input_shapes.size(),
+                           ANEURALNETWORKS_BAD_DATA);
+  auto specialised_model = std::make_shared<ANeuralNetworksModel>(model);
+  // The hash identifies the specialisation so that network objects and cached
+  // binaries are only shared between identical shapes
+  Sha256 hasher;
+  hasher.update(model.hash.data(), model.hash.size());
+  for (std::size_t i = 0; i < input_shapes.size(); ++i) {
+    const auto& shape = input_shapes[i];
+    const auto declared = getOperandShape(model.operands[model.inputs[i]]);
+    TENSOROPT_RETURN_IF_COND(
+        !isShapeKnown(shape) || !isShapeCompatible(declared, shape),
+        "Error: invalid shape for input " << i, ANEURALNETWORKS_BAD_DATA);
+    setOperandDimensions(*specialised_model, model.inputs[i], shape);
+    hasher.updateU32(static_cast<uint32_t>(shape.size()));
+    for (auto dim : shape) {
+      hasher.updateU32(dim);
+    }
+  }
+  specialised_model->hash = hasher.digest();
+
+  ANeuralNetworksCompilation* raw_specialised;
+  TENSOROPT_RETURN_IF_ERROR(ANeuralNetworksCompilation_createForDevices(
+      specialised_model.get(), &compilation->device, 1, &raw_specialised));
+  specialised.reset(raw_specialised, ANeuralNetworksCompilation_free);
+  specialised->owned_model = specialised_model;
+  specialised->owned_device = compilation->owned_device;
+  specialised->imgdnn_flags_ = compilation->imgdnn_flags_;
+  specialised->imgdnn_options_ = compilation->imgdnn_options_;
+  if (!compilation->token_path.empty()) {
+    std::stringstream ss;
+    ss << compilation->token_path << '-';
+    writeHexToken(ss, specialised_model->hash.data());
+    specialised->token_path = ss.str();
+  }
+  return ANeuralNetworksCompilation_finish(specialised.get());
+}
+
+ResultCode getSpecialisedCompilation(
+    ANeuralNetworksCompilation* compilation,
+    const ANeuralNetworksCompilation::input_shapes_t& input_shapes,
+    std::shared_ptr<ANeuralNetworksCompilation>& specialised) {
+  std::lock_guard<std::mutex> lock(compilation->specialisations_mutex);
+  auto& specialisations = compilation->specialisations;
+  for (auto it = specialisations.begin(); it != specialisations.end(); ++it) {
+    if (it->first == input_shapes) {
+      // Move the specialisation to the front as the most recently used
+      specialisations.splice(specialisations.begin(), specialisations, it);
+      specialised = it->second;
+      return ANEURALNETWORKS_NO_ERROR;
+    }
+  }
+
+  VLOG_AT("Specialising compilation for new input shapes");
+  TENSOROPT_RETURN_IF_ERROR(
+      createSpecialisedCompilation(compilation, input_shapes, specialised));
+  specialisations.emplace_front(input_shapes, specialised);
+  // Executions keep their own reference so an evicted specialisation is only
+  // released once it is not used anymore
+  if (specialisations.size() > compilation->max_specialisations) {
+    specialisations.pop_back();
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+void padToDimensionBuckets(
+    const ANeuralNetworksCompilation& compilation,
+    ANeuralNetworksCompilation::input_shapes_t& input_shapes) {
+  for (const auto& dimension_buckets : compilation.dimension_buckets) {
+    auto input_index = dimension_buckets.first.first;
+    auto dimension = dimension_buckets.first.second;
+    const auto& buckets = dimension_buckets.second;
+    auto& dim = input_shapes[input_index][dimension];
+    auto it = std::lower_bound(buckets.begin(), buckets.end(), dim);
+    if (it != buckets.end()) {
+      dim = *it;
+    }
+  }
+}
+
+ResultCode inferDynamicOutputShapes(
+    const ANeuralNetworksCompilation& compilation,
+    const ANeuralNetworksCompilation::input_shapes_t& input_shapes,
+    std::vector<std::vector<uint32_t>>& output_shapes) {
+  const auto& model = compilation.sorted_model;
+  std::vector<Shape> shapes;
+  TENSOROPT_RETURN_IF_ERROR(inferShapes(model, input_shapes, shapes));
+  output_shapes.clear();
+  for (auto output : model.outputs) {
+    TENSOROPT_RETURN_IF_COND(!isShapeKnown(shapes[output]),
+                             "Error: could not infer the shape of output "
+                                 << output,
+                             ANEURALNETWORKS_BAD_DATA);
+    output_shapes.push_back(shapes[output]);
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
@@ -16,23 +16,68 @@
 #ifndef SRC_BACKENDS_IMGDNN_COMPILATION_HPP
 #define SRC_BACKENDS_IMGDNN_COMPILATION_HPP
 
+#include <array>
+#include <chrono>
+#include <list>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "backends/imgdnn/backend.hpp"
+#include "common/memory_planner.hpp"
 #include "common/model.hpp"
 #include "tensoropt/compilation.hpp"
 
+/**
+ * Number of durations stored by a compilation.
+ */
+constexpr std::size_t NUM_COMPILATION_DURATIONS =
+    ANEURALNETWORKS_COMPILATION_DURATION_CREATE_NETWORK_BINARY + 1;
+
 struct ANeuralNetworksCompilation {
   const ANeuralNetworksModel* model;    // weak_ptr
+  // Set if the compilation owns its model, see getSpecialisedCompilation
+  std::shared_ptr<ANeuralNetworksModel> owned_model;
+  // Copy of the model modified by the passes before it is converted
+  ANeuralNetworksModel optimized_model;
   const ANeuralNetworksDevice* device;  // weak_ptr
   std::shared_ptr<ANeuralNetworksDevice> owned_device;
   std::string token_path;
   std::vector<char> cached_file;  // data has to be mutable for IMGDNN API
   bool finished;
-  bool serialized;
+  bool converted;
+
+  // Placement of the intermediate operands of optimized_model, computed on
+  // demand by ANeuralNetworksCompilation_getArenaSize and
+  // ANeuralNetworksCompilation_getArenaOffset
+  MemoryPlan memory_plan;
+  bool memory_planned;
+
+  // A model with dynamic inputs is not compiled by
+  // ANeuralNetworksCompilation_finish. Instead a compilation is specialised
+  // for each set of concrete input shapes the first time it is executed.
+  // The specialisations are ordered from the most recently used and the least
+  // recently used one is released once there are more than
+  // max_specialisations.
+  using input_shapes_t = std::vector<std::vector<uint32_t>>;
+  using specialisation_t =
+      std::pair<input_shapes_t, std::shared_ptr<ANeuralNetworksCompilation>>;
+  bool has_dynamic_inputs;
+  std::list<specialisation_t> specialisations;
+  std::size_t max_specialisations;
+  std::mutex specialisations_mutex;
+
+  // Sizes the dynamic dimensions are padded to, indexed by the input index and
+  // the dimension, so that the number of specialisations stays bounded.
+  // The outputs are sliced back to the shapes inferred on sorted_model from
+  // the unpadded input shapes.
+  std::map<std::pair<uint32_t, uint32_t>, std::vector<uint32_t>>
+      dimension_buckets;
+  ANeuralNetworksModel sorted_model;
 
   using owned_const_host_operands =
       std::unordered_map<uint32_t, ANeuralNetworksModel::owned_const_host_data>;
@@ -43,7 +88,38 @@ struct ANeuralNetworksCompilation {
   // if the user compiles the same model multiple times.
   owned_const_host_operands const_copied_to_host_operands;
 
+  // Constant filters permuted to OIHW by convertModel, indexed by the operand
+  // index and whether the filter was in HWIO format. IMGDNN keeps a pointer to
+  // the data so it has to live as long as the compilation. The fixed input
+  // tensor is created once and shared by the operations using the filter.
+  struct OIHWConstHostOperand {
+    ANeuralNetworksModel::owned_const_host_data data;
+    imgdnn_tensor img_tensor;
+  };
+  std::map<std::pair<uint32_t, bool>, OIHWConstHostOperand>
+      oihw_const_host_operands;
+
+  // Time spent in each stage of the compilation indexed by
+  // CompilationDurationCode, UINT64_MAX if the stage was not run, and time
+  // spent converting each type of operation.
+  struct OperationStatistics {
+    uint64_t duration;
+    uint32_t count;
+  };
+  using statistics_clock_t = std::chrono::steady_clock;
+  std::array<uint64_t, NUM_COMPILATION_DURATIONS> durations;
+  std::map<int32_t, OperationStatistics> operation_statistics;
+  // Number of transposes added to the IMGDNN network once the transposes
+  // cancelling each other are merged.
+  uint32_t num_img_transposes;
+
+  // Identify the device to share network objects between compilations
+  cl_context cl_context_;
+  cl_device_id cl_device_;
+
   // IMGDNN specifics
+  // Once the compilation is finished the context and the network object are
+  // owned by the network object registry.
   imgdnn_device imgdnn_device_;
   imgdnn_context imgdnn_context_;
   imgdnn_network imgdnn_network_;
@@ -55,4 +131,31 @@ struct ANeuralNetworksCompilation {
   imgdnn_network_object imgdnn_network_object_;
 };
 
+/**
+ * Return the compilation specialised for the given input shapes, compiling it
+ * if it is not in the compilation's cache. The shapes are given in the order
+ * of the model inputs and must not have unknown dimensions.
+ */
+ResultCode getSpecialisedCompilation(
+    ANeuralNetworksCompilation* compilation,
+    const ANeuralNetworksCompilation::input_shapes_t& input_shapes,
+    std::shared_ptr<ANeuralNetworksCompilation>& specialised);
+
+/**
+ * Pad each dimension of input_shapes to the smallest bucket it fits in.
+ * Dimensions without buckets or larger than the largest bucket are unchanged.
+ */
+void padToDimensionBuckets(
+    const ANeuralNetworksCompilation& compilation,
+    ANeuralNetworksCompilation::input_shapes_t& input_shapes);
+
+/**
+ * Infer the shapes of the model outputs from the unpadded input shapes.
+ * Only valid for a finished compilation with dimension buckets.
+ */
+ResultCode inferDynamicOutputShapes(
+    const ANeuralNetworksCompilation& compilation,
+    const ANeuralNetworksCompilation::input_shapes_t& input_shapes,
+    std::vector<std::vector<uint32_t>>& output_shapes);
+
 #endif  // SRC_BACKENDS_IMGDNN_COMPILATION_HPP
@@ -20,7 +20,10 @@
 
 #include "backends/imgdnn/compilation.hpp"
 #include "common/device.hpp"
+#include "common/host_kernels.hpp"
 #include "common/model.hpp"
+#include "common/passes/passes.hpp"
+#include "common/slice_bounds.hpp"
 #include "common/utils.hpp"
 
 namespace {
@@ -43,14 +46,32 @@ struct Converter {
   using indexed_img_tensors = std::unordered_map<int64_t, imgdnn_tensor>;
   indexed_img_tensors img_tensors;
 
-  imgdnn_err_code ret;
+  // NCHW tensors of the operands which are in NHWC format in the model.
+  // Operations that can be computed in NCHW use them directly so that
+  // consecutive convolutions, pooling and elementwise operations do not
+  // transpose their inputs and outputs. The NHWC tensor is only created by
+  // getImgTensor if another operation needs it.
+  // 1D operands are stored reshaped to [C, 1, 1] to be broadcast along the
+  // channels of a NCHW tensor.
+  std::unordered_map<uint32_t, imgdnn_tensor> nchw_img_tensors;
+
+  // Source and order of the transposes created so that consecutive transposes
+  // can be merged
+  struct TransposeInfo {
+    imgdnn_tensor source;
+    std::vector<int> order;
+  };
+  std::unordered_map<imgdnn_tensor, TransposeInfo> transposed_img_tensors;
 
-  // Offset to convert an exclusive end bound to an inclusive one
-  static constexpr int INCLUSIVE_END = -1;
+  imgdnn_err_code ret;
 
  public:
   Converter(ANeuralNetworksCompilation* c)
-      : compilation(c), model(c->model), img_tensors() {}
+      : compilation(c),
+        model(&c->optimized_model),
+        img_tensors(),
+        nchw_img_tensors(),
+        transposed_img_tensors() {}
 
   Converter(const Converter&) = delete;
   Converter(Converter&&) = default;
@@ -67,6 +88,8 @@ struct Converter {
     // when executing. TensorFlow does not use
     // ANeuralNetworksModel_setOperandValueFromMemory so this is not an
     // important issue.
+    using statistics_clock_t = ANeuralNetworksCompilation::statistics_clock_t;
+    auto copy_start = statistics_clock_t::now();
     std::vector<cl::sycl::event> copy_events;
     for (auto& pair : model->const_device_operands) {
       auto& const_host_operand =
@@ -92,6 +115,9 @@ struct Converter {
     for (auto& event : copy_events) {
       event.wait_and_throw();
     }
+    compilation
+        ->durations[ANEURALNETWORKS_COMPILATION_DURATION_COPY_CONSTANTS] =
+        getNanoseconds(copy_start, statistics_clock_t::now());
 
     // Add network inputs
     for (uint32_t op_idx : model->inputs) {
@@ -111,13 +137,11 @@ struct Converter {
     }
 
     // Add network operations
-    // NNAPI doesn't assume any order in which the operations must be
-    // added but IMGDNN requires that they are added in execution order (by
-    // construction).
-    // TensorFlow already adds the operations in the correct order
-    // TODO: Sort the operations with a pre order traversal
+    // IMGDNN requires that the operations are added in execution order which
+    // is ensured by sortOperations.
     for (std::size_t op_idx = 0; op_idx < model->operations.size(); ++op_idx) {
       const auto& operation = model->operations[op_idx];
+      auto op_start = statistics_clock_t::now();
       switch (operation.type) {
         case ANEURALNETWORKS_EXP:
         case ANEURALNETWORKS_RELU:
@@ -193,10 +217,14 @@ struct Converter {
         auto output_idx = operation.outputs[i];
         const ANeuralNetworksOperandType& output_op =
             model->operands[output_idx];
+        // The output may only exist in NCHW format
+        auto it = img_tensors.find(output_idx);
+        bool is_nchw = it == img_tensors.end();
+        imgdnn_tensor img_output =
+            is_nchw ? nchw_img_tensors[output_idx] : it->second;
         imgdnn_tensor_descriptor img_td;
-        BACKEND_CALL_RET(ret, imgdnnGetTensorDescriptor,
-                         img_tensors[output_idx], &img_td);
-        if (!areShapesEqual(output_op, img_td)) {
+        BACKEND_CALL_RET(ret, imgdnnGetTensorDescriptor, img_output, &img_td);
+        if (!areShapesEqual(output_op, img_td, is_nchw)) {
           VLOG_AT(
               "Unexpected output shape when converting operation #"
               << op_idx << " (code=" << operation.type << "), output #" << i
@@ -208,11 +236,17 @@ struct Converter {
           return ANEURALNETWORKS_OP_FAILED;
         }
       }
+      auto& statistics = compilation->operation_statistics[operation.type];
+      statistics.duration +=
+          getNanoseconds(op_start, statistics_clock_t::now());
+      ++statistics.count;
     }
 
     // Add network outputs
     for (auto output_idx : model->outputs) {
-      compilation->imgdnn_outputs_.push_back(img_tensors[output_idx]);
+      imgdnn_tensor img_output;
+      TENSOROPT_RETURN_IF_ERROR(getImgTensor(output_idx, img_output));
+      compilation->imgdnn_outputs_.push_back(img_output);
     }
 
     return ANEURALNETWORKS_NO_ERROR;
@@ -223,14 +257,27 @@ struct Converter {
    * Return true if the TensorOpt and IMGDNN shapes are equal.
    * The 0D TensorOpt shape and 1D IMGDNN shape of size 1 are considered to
    * be equal. An IMGDNN shape cannot be 0D.
+   * If is_img_nchw is true the IMGDNN shape is the NCHW version of the NHWC
+   * TensorOpt shape.
    */
   bool areShapesEqual(const ANeuralNetworksOperandType& topt_op,
-                      const imgdnn_tensor_descriptor& img_td) {
+                      const imgdnn_tensor_descriptor& img_td,
+                      bool is_img_nchw = false) {
     if (topt_op.dimensionCount == 0 && img_td.dimensions == 1 &&
         img_td.size[0] == 1) {
       return true;
     }
     bool are_shapes_equal = topt_op.dimensionCount == img_td.dimensions;
+    if (is_img_nchw) {
+      static constexpr std::array<unsigned, 4> nchw_to_nhwc{0, 2, 3, 1};
+      unsigned dim = 0;
+      while (are_shapes_equal && dim < nchw_to_nhwc.size()) {
+        are_shapes_equal =
+            topt_op.dimensions[nchw_to_nhwc[dim]] == img_td.size[dim];
+        ++dim;
+      }
+      return are_shapes_equal && topt_op.dimensionCount == 4;
+    }
     unsigned dim = 0;
     while (are_shapes_equal && dim < topt_op.dimensionCount) {
       are_shapes_equal = topt_op.dimensions[dim] == img_td.size[dim];
@@ -397,6 +444,42 @@ struct Converter {
     return ANEURALNETWORKS_NO_ERROR;
   }
 
+  /**
+   * Create a fixed input IMGDNN tensor from the constant operand op_idx.
+   * img_td can describe a different shape or layout than the operand but must
+   * have the same number of elements as data.
+   */
+  ResultCode createFixedInputTensor(uint32_t op_idx, const void* data,
+                                    std::size_t length,
+                                    const imgdnn_tensor_descriptor& img_td,
+                                    imgdnn_tensor& img_tensor) {
+    if (std::find(model->inputs.begin(), model->inputs.end(), op_idx) !=
+        model->inputs.end()) {
+      VLOG_AT("Error: Operand at index "
+              << op_idx
+              << " cannot be both a constant model operand and an input");
+      return ANEURALNETWORKS_BAD_DATA;
+    }
+    if (std::find(model->outputs.begin(), model->outputs.end(), op_idx) !=
+        model->outputs.end()) {
+      VLOG_AT("Error: Operand at index "
+              << op_idx
+              << " cannot be both a constant model operand and an output");
+      return ANEURALNETWORKS_BAD_DATA;
+    }
+    uint32_t op_size = getOperandTypeSizeBytes(model->operands[op_idx]);
+    if (op_size != length) {
+      VLOG_AT("Error: Operand at index "
+              << op_idx << " was described with a total size of " << op_size
+              << "B but set with a value of size " << length << "B");
+      return ANEURALNETWORKS_BAD_DATA;
+    }
+    BACKEND_CALL_RET(img_tensor, imgdnnNetworkFixedInput,
+                     compilation->imgdnn_network_, &img_td, data, &ret);
+    IMGDNN_RETURN_ERR_IF_ERROR(ret);
+    return ANEURALNETWORKS_NO_ERROR;
+  }
+
   /**
    * Try to create a fixed input IMGDNN tensor.
    * If op_idx is set as a model constant input, img_tensor is created and added
@@ -407,33 +490,11 @@ struct Converter {
     const void* data = nullptr;
     std::size_t length;
     if (readConstHostOperandHelper(op_idx, &data, length)) {
-      if (std::find(model->inputs.begin(), model->inputs.end(), op_idx) !=
-          model->inputs.end()) {
-        VLOG_AT("Error: Operand at index "
-                << op_idx
-                << " cannot be both a constant model operand and an input");
-        return ANEURALNETWORKS_BAD_DATA;
-      }
-      if (std::find(model->outputs.begin(), model->outputs.end(), op_idx) !=
-          model->outputs.end()) {
-        VLOG_AT("Error: Operand at index "
-                << op_idx
-                << " cannot be both a constant model operand and an output");
-        return ANEURALNETWORKS_BAD_DATA;
-      }
       imgdnn_tensor_descriptor img_td;
-      const auto& op = model->operands[op_idx];
-      TENSOROPT_RETURN_IF_ERROR(RTOperandTypeToImg(op, img_td));
-      uint32_t op_size = getOperandTypeSizeBytes(op);
-      if (op_size != length) {
-        VLOG_AT("Error: Operand at index "
-                << op_idx << " was described with a total size of " << op_size
-                << "B but set with a value of size " << length << "B");
-        return ANEURALNETWORKS_BAD_DATA;
-      }
-      BACKEND_CALL_RET(img_tensor, imgdnnNetworkFixedInput,
-                       compilation->imgdnn_network_, &img_td, data, &ret);
-      IMGDNN_RETURN_ERR_IF_ERROR(ret);
+      TENSOROPT_RETURN_IF_ERROR(
+          RTOperandTypeToImg(model->operands[op_idx], img_td));
+      TENSOROPT_RETURN_IF_ERROR(
+          createFixedInputTensor(op_idx, data, length, img_td, img_tensor));
       img_tensors[op_idx] = img_tensor;
       added = true;
     } else {
@@ -453,6 +514,16 @@ struct Converter {
     }
     if (idx >= 0) {
       auto op_idx = static_cast<uint32_t>(idx);
+      auto nchw_it = nchw_img_tensors.find(op_idx);
+      if (nchw_it != nchw_img_tensors.end() &&
+          model->operands[op_idx].dimensionCount == 4) {
+        // The operand was only computed in NCHW format
+        static constexpr std::array<int, 4> nchw_to_nhwc{0, 2, 3, 1};
+        TENSOROPT_RETURN_IF_ERROR(
+            convertTransposeHelper(nchw_it->second, nchw_to_nhwc, img_tensor));
+        img_tensors[op_idx] = img_tensor;
+        return ANEURALNETWORKS_NO_ERROR;
+      }
       bool added;
       TENSOROPT_RETURN_IF_ERROR(addFixedInputTensor(op_idx, img_tensor, added));
       if (added) {
@@ -497,60 +568,195 @@ struct Converter {
     return ANEURALNETWORKS_OP_FAILED;
   }
 
+  /**
+   * Transpose img_in.
+   * If img_in is itself a transpose, the two transposes are merged into one
+   * transpose of the original tensor or removed if they cancel each other.
+   */
   template <class Container>
   ResultCode convertTransposeHelper(imgdnn_tensor img_in,
                                     const Container& order,
                                     imgdnn_tensor& img_out) {
+    std::vector<int> img_order(order.begin(), order.end());
+    auto it = transposed_img_tensors.find(img_in);
+    bool can_merge = it != transposed_img_tensors.end() &&
+                     it->second.order.size() == img_order.size();
+    for (std::size_t i = 0; can_merge && i < img_order.size(); ++i) {
+      can_merge = img_order[i] >= 0 &&
+                  static_cast<std::size_t>(img_order[i]) < img_order.size();
+    }
+    if (can_merge) {
+      const auto& source_order = it->second.order;
+      bool is_identity = true;
+      for (std::size_t i = 0; i < img_order.size(); ++i) {
+        img_order[i] = source_order[static_cast<std::size_t>(img_order[i])];
+        is_identity = is_identity && img_order[i] == static_cast<int>(i);
+      }
+      img_in = it->second.source;
+      if (is_identity) {
+        img_out = img_in;
+        return ANEURALNETWORKS_NO_ERROR;
+      }
+    }
     BACKEND_CALL_RET(img_out, imgdnnNetworkTransposeOp,
-                     compilation->imgdnn_network_, img_in, order.data(), &ret);
+                     compilation->imgdnn_network_, img_in, img_order.data(),
+                     &ret);
     IMGDNN_RETURN_ERR_IF_ERROR(ret);
+    ++compilation->num_img_transposes;
+    transposed_img_tensors[img_out] = {img_in, std::move(img_order)};
+    return ANEURALNETWORKS_NO_ERROR;
+  }
+
+  /**
+   * Get the NCHW tensor of a 4D operand in NHWC format.
+   * The operand is transposed at most once.
+   */
+  ResultCode getImgNCHWTensorFromNHWC(uint32_t op_idx,
+                                      imgdnn_tensor& img_nchw_out) {
+    auto it = nchw_img_tensors.find(op_idx);
+    if (it != nchw_img_tensors.end()) {
+      img_nchw_out = it->second;
+      return ANEURALNETWORKS_NO_ERROR;
+    }
+    imgdnn_tensor img_in;
+    TENSOROPT_RETURN_IF_ERROR(getImgTensor(op_idx, img_in));
+    static constexpr std::array<int, 4> nhwc_to_nchw{0, 3, 1, 2};
+    TENSOROPT_RETURN_IF_ERROR(
+        convertTransposeHelper(img_in, nhwc_to_nchw, img_nchw_out));
+    nchw_img_tensors[op_idx] = img_nchw_out;
+    return ANEURALNETWORKS_NO_ERROR;
+  }
+
+  /**
+   * Get a 1D operand of size C reshaped to [C, 1, 1] so that it is broadcast
+   * along the channels of a NCHW tensor.
+   */
+  ResultCode getImgChannelTensor(uint32_t op_idx, imgdnn_tensor& img_out) {
+    auto it = nchw_img_tensors.find(op_idx);
+    if (it != nchw_img_tensors.end()) {
+      img_out = it->second;
+      return ANEURALNETWORKS_NO_ERROR;
+    }
+    const auto& op = model->operands[op_idx];
+    imgdnn_tensor_descriptor img_td;
+    TENSOROPT_RETURN_IF_ERROR(RTOperandTypeToImg(op, img_td));
+    img_td.dimensions = 3;
+    img_td.size[1] = 1;
+    img_td.size[2] = 1;
+    const void* data = nullptr;
+    std::size_t length;
+    if (readConstHostOperandHelper(op_idx, &data, length)) {
+      // Constants are created with the expected shape directly
+      TENSOROPT_RETURN_IF_ERROR(
+          createFixedInputTensor(op_idx, data, length, img_td, img_out));
+    } else {
+      imgdnn_tensor img_in;
+      TENSOROPT_RETURN_IF_ERROR(getImgTensor(op_idx, img_in));
+      BACKEND_CALL_RET(img_out, imgdnnNetworkReshapeOp,
+                       compilation->imgdnn_network_, img_in, &img_td, &ret);
+      IMGDNN_RETURN_ERR_IF_ERROR(ret);
+    }
+    nchw_img_tensors[op_idx] = img_out;
     return ANEURALNETWORKS_NO_ERROR;
   }
 
   ResultCode getImgNCHWTensor(const ANeuralNetworksModel::Operation& operation,
                               uint32_t idx, bool is_input_nchw,
                               imgdnn_tensor& img_nchw_out) {
-    imgdnn_tensor img_in;
-    TENSOROPT_RETURN_IF_ERROR(getImgTensor(operation.inputs[idx], img_in));
     if (is_input_nchw) {
-      img_nchw_out = img_in;
+      TENSOROPT_RETURN_IF_ERROR(
+          getImgTensor(operation.inputs[idx], img_nchw_out));
       return ANEURALNETWORKS_NO_ERROR;
     }
-    static constexpr std::array<int, 4> nhwc_to_nchw{0, 3, 1, 2};
     TENSOROPT_RETURN_IF_ERROR(
-        convertTransposeHelper(img_in, nhwc_to_nchw, img_nchw_out));
+        getImgNCHWTensorFromNHWC(operation.inputs[idx], img_nchw_out));
     return ANEURALNETWORKS_NO_ERROR;
   }
 
   ResultCode getImgOIHWTensor(const ANeuralNetworksModel::Operation& operation,
                               uint32_t idx, bool is_input_hwio,
                               imgdnn_tensor& img_hwio_out) {
-    imgdnn_tensor img_in;
-    TENSOROPT_RETURN_IF_ERROR(getImgTensor(operation.inputs[idx], img_in));
-    if (is_input_hwio) {
-      static constexpr std::array<int, 4> hwio_to_oihw{3, 2, 0, 1};
-      TENSOROPT_RETURN_IF_ERROR(
-          convertTransposeHelper(img_in, hwio_to_oihw, img_hwio_out));
-    } else {  // ohwi to oihw
-      static constexpr std::array<int, 4> ohwi_to_oihw{0, 3, 1, 2};
-      TENSOROPT_RETURN_IF_ERROR(
-          convertTransposeHelper(img_in, ohwi_to_oihw, img_hwio_out));
+    static constexpr std::array<int, 4> hwio_to_oihw{3, 2, 0, 1};
+    static constexpr std::array<int, 4> ohwi_to_oihw{0, 3, 1, 2};
+    const auto& order = is_input_hwio ? hwio_to_oihw : ohwi_to_oihw;
+    auto op_idx = operation.inputs[idx];
+    const void* data = nullptr;
+    std::size_t length;
+    if (!img_tensors.count(op_idx) &&
+        readConstHostOperandHelper(op_idx, &data, length)) {
+      // Constant filters are permuted once on the host instead of on the
+      // device for each execution
+      TENSOROPT_RETURN_IF_ERROR(getConstImgOIHWTensor(
+          op_idx, data, length, is_input_hwio, order, img_hwio_out));
+      return ANEURALNETWORKS_NO_ERROR;
     }
+    imgdnn_tensor img_in;
+    TENSOROPT_RETURN_IF_ERROR(getImgTensor(op_idx, img_in));
+    TENSOROPT_RETURN_IF_ERROR(
+        convertTransposeHelper(img_in, order, img_hwio_out));
     return ANEURALNETWORKS_NO_ERROR;
   }
 
-  ResultCode getSameFormatImgTensor(bool is_input_nchw, imgdnn_tensor img_in,
-                                    imgdnn_tensor& img_out) {
-    if (is_input_nchw) {
-      img_out = img_in;
+  /**
+   * Get a fixed input IMGDNN tensor in OIHW format from the constant filter
+   * op_idx. The permuted data and the tensor are owned by the compilation.
+   */
+  ResultCode getConstImgOIHWTensor(uint32_t op_idx, const void* data,
+                                   std::size_t length, bool is_input_hwio,
+                                   const std::array<int, 4>& order,
+                                   imgdnn_tensor& img_oihw_out) {
+    const auto& op = model->operands[op_idx];
+    uint32_t op_size = getOperandTypeSizeBytes(op);
+    if (op.dimensionCount != order.size() || op_size != length) {
+      VLOG_AT("Error: Filter at index "
+              << op_idx << " must be a 4D tensor of size " << op_size
+              << "B but was set with a value of size " << length << "B");
+      return ANEURALNETWORKS_BAD_DATA;
+    }
+    auto& oihw_operand =
+        compilation->oihw_const_host_operands[{op_idx, is_input_hwio}];
+    if (oihw_operand.img_tensor) {
+      img_oihw_out = oihw_operand.img_tensor;
       return ANEURALNETWORKS_NO_ERROR;
     }
-    static constexpr std::array<int, 4> nchw_to_nhwc{0, 2, 3, 1};
-    TENSOROPT_RETURN_IF_ERROR(
-        convertTransposeHelper(img_in, nchw_to_nhwc, img_out));
+    auto& oihw_data = oihw_operand.data;
+    if (oihw_data.empty()) {
+      std::vector<int32_t> perms(order.begin(), order.end());
+      TENSOROPT_RETURN_IF_ERROR(hostTranspose(op, data, perms, op, oihw_data));
+    }
+    imgdnn_tensor_descriptor img_td;
+    TENSOROPT_RETURN_IF_ERROR(RTOperandTypeToImg(op, img_td));
+    for (std::size_t i = 0; i < order.size(); ++i) {
+      img_td.size[i] = op.dimensions[order[i]];
+    }
+    TENSOROPT_RETURN_IF_ERROR(createFixedInputTensor(
+        op_idx, oihw_data.data(), oihw_data.size(), img_td, img_oihw_out));
+    oihw_operand.img_tensor = img_oihw_out;
     return ANEURALNETWORKS_NO_ERROR;
   }
 
+  /**
+   * Set the NCHW result of an operation.
+   * If the operand is in NHWC format the result is kept in NCHW and only
+   * transposed if an operation requires it.
+   */
+  void setNCHWOutputImgTensor(uint32_t op_idx, bool is_output_nchw,
+                              imgdnn_tensor img_nchw_out) {
+    if (is_output_nchw) {
+      img_tensors[op_idx] = img_nchw_out;
+    } else {
+      nchw_img_tensors[op_idx] = img_nchw_out;
+    }
+  }
+
+  /**
+   * Return true if the 4D operand at op_idx has a NCHW tensor.
+   */
+  bool hasImgNCHWTensor(uint32_t op_idx) {
+    return model->operands[op_idx].dimensionCount == 4 &&
+           nchw_img_tensors.count(op_idx);
+  }
+
   ResultCode convertBinaryHelper(OperationCode op_code, imgdnn_tensor img_in0,
                                  imgdnn_tensor img_in1,
                                  imgdnn_tensor& img_out) {
@@ -700,19 +906,6 @@ struct Converter {
     return ANEURALNETWORKS_NO_ERROR;
   }
 
-  template <class Container>
-  ResultCode checkVectorSmallerOrEqualRank(uint32_t rank,
-                                           const Container& container,
-                                           const std::string& input_name) {
-    TENSOROPT_UNUSED_VARIABLE(input_name);
-    TENSOROPT_RETURN_IF_COND(
-        container.size() > rank,
-        "Error: '" << input_name << "' argument has " << container.size()
-                   << " elements but input rank is " << rank << ".",
-        ANEURALNETWORKS_OP_FAILED);
-    return ANEURALNETWORKS_NO_ERROR;
-  }
-
   ResultCode convertReshapeHelper(imgdnn_tensor img_in, uint32_t shape_op_idx,
                                   imgdnn_tensor& img_out) {
     imgdnn_tensor_descriptor img_td;
@@ -728,6 +921,15 @@ struct Converter {
     TENSOROPT_RETURN_IF_UNEXPECTED_SIZE(operation, inputs, 1);
     TENSOROPT_RETURN_IF_UNEXPECTED_SIZE(operation, outputs, 1);
 
+    // Stay in NCHW if the input was computed in this format
+    if (hasImgNCHWTensor(operation.inputs[0])) {
+      imgdnn_tensor img_nchw_out;
+      TENSOROPT_RETURN_IF_ERROR(convertUnaryHelper(
+          operation.type, nchw_img_tensors[operation.inputs[0]], img_nchw_out));
+      setNCHWOutputImgTensor(operation.outputs[0], false, img_nchw_out);
+      return ANEURALNETWORKS_NO_ERROR;
+    }
+
     imgdnn_tensor img_in;
     TENSOROPT_RETURN_IF_ERROR(getImgTensor(operation.inputs[0], img_in));
 
@@ -745,19 +947,62 @@ struct Converter {
     imgdnn_tensor img_in0;
     imgdnn_tensor img_in1;
     int32_t fuse_code = ANEURALNETWORKS_FUSED_NONE;
-    TENSOROPT_RETURN_IF_ERROR(getImgTensor(operation.inputs[0], img_in0));
-    TENSOROPT_RETURN_IF_ERROR(getImgTensor(operation.inputs[1], img_in1));
     TENSOROPT_RETURN_IF_ERROR(
         readOptionalConstHostOperand(operation, 2, fuse_code));
 
-    imgdnn_tensor& img_out = img_tensors[operation.outputs[0]];
+    bool is_nchw;
+    TENSOROPT_RETURN_IF_ERROR(getBinaryImgInputs(operation, img_in0, img_in1,
+                                                 is_nchw));
+    imgdnn_tensor img_res;
     TENSOROPT_RETURN_IF_ERROR(
-        convertBinaryHelper(operation.type, img_in0, img_in1, img_out));
-    TENSOROPT_RETURN_IF_ERROR(addOptionalFuseCode(fuse_code, img_out));
+        convertBinaryHelper(operation.type, img_in0, img_in1, img_res));
+    TENSOROPT_RETURN_IF_ERROR(addOptionalFuseCode(fuse_code, img_res));
+    if (is_nchw) {
+      setNCHWOutputImgTensor(operation.outputs[0], false, img_res);
+    } else {
+      img_tensors[operation.outputs[0]] = img_res;
+    }
 
     return ANEURALNETWORKS_NO_ERROR;
   }
 
+  /**
+   * Get the inputs of an elementwise binary operation.
+   * The operation is computed in NCHW if one of its inputs was computed in
+   * NCHW and the other input can be broadcast in NCHW.
+   */
+  ResultCode getBinaryImgInputs(
+      const ANeuralNetworksModel::Operation& operation, imgdnn_tensor& img_in0,
+      imgdnn_tensor& img_in1, bool& is_nchw) {
+    auto in0_idx = operation.inputs[0];
+    auto in1_idx = operation.inputs[1];
+    auto can_broadcast_nchw = [this](uint32_t op_idx) {
+      auto rank = model->operands[op_idx].dimensionCount;
+      return rank == 0 || rank == 1 || rank == 4;
+    };
+    is_nchw = model->operands[operation.outputs[0]].dimensionCount == 4 &&
+              (hasImgNCHWTensor(in0_idx) || hasImgNCHWTensor(in1_idx)) &&
+              can_broadcast_nchw(in0_idx) && can_broadcast_nchw(in1_idx);
+    if (!is_nchw) {
+      TENSOROPT_RETURN_IF_ERROR(getImgTensor(in0_idx, img_in0));
+      TENSOROPT_RETURN_IF_ERROR(getImgTensor(in1_idx, img_in1));
+      return ANEURALNETWORKS_NO_ERROR;
+    }
+    auto get_nchw_input = [this](uint32_t op_idx, imgdnn_tensor& img_in) {
+      switch (model->operands[op_idx].dimensionCount) {
+        case 0:
+          return getImgTensor(op_idx, img_in);
+        case 1:
+          return getImgChannelTensor(op_idx, img_in);
+        default:
+          return getImgNCHWTensorFromNHWC(op_idx, img_in);
+      }
+    };
+    TENSOROPT_RETURN_IF_ERROR(get_nchw_input(in0_idx, img_in0));
+    TENSOROPT_RETURN_IF_ERROR(get_nchw_input(in1_idx, img_in1));
+    return ANEURALNETWORKS_NO_ERROR;
+  }
+
   ResultCode convertPool(const ANeuralNetworksModel::Operation& operation) {
     TENSOROPT_RETURN_IF_UNEXPECTED_MINMAX_SIZE(operation, inputs, 6, 8);
     TENSOROPT_RETURN_IF_UNEXPECTED_SIZE(operation, outputs, 1);
@@ -817,14 +1062,18 @@ struct Converter {
                      img_strides, img_pad_begin, img_pad_end,
                      rt_to_img_op_code.at(operation.type), &ret);
     IMGDNN_RETURN_ERR_IF_ERROR(ret);
-    imgdnn_tensor& img_out = img_tensors[operation.outputs[0]];
-    TENSOROPT_RETURN_IF_ERROR(
-        getSameFormatImgTensor(is_input_nchw, img_nchw_out, img_out));
+    TENSOROPT_RETURN_IF_ERROR(addOptionalFuseCode(fuse_code, img_nchw_out));
+    setNCHWOutputImgTensor(operation.outputs[0], is_input_nchw, img_nchw_out);
     return ANEURALNETWORKS_NO_ERROR;
   }
 
   ResultCode convertConv2D(const ANeuralNetworksModel::Operation& operation) {
-    TENSOROPT_RETURN_IF_UNEXPECTED_MINMAX_SIZE(operation, inputs, 6, 11);
+    // Depthwise convolutions have an extra depth multiplier input before the
+    // FuseCode
+    bool is_depthwise = operation.type == ANEURALNETWORKS_DEPTHWISE_CONV_2D;
+    uint32_t fuse_idx = is_depthwise ? 7 : 6;
+    TENSOROPT_RETURN_IF_UNEXPECTED_MINMAX_SIZE(operation, inputs, 6,
+                                               fuse_idx + 5);
     TENSOROPT_RETURN_IF_UNEXPECTED_SIZE(operation, outputs, 1);
 
     imgdnn_tensor img_nchw_in;
@@ -835,8 +1084,8 @@ struct Converter {
     int32_t fuse_code = ANEURALNETWORKS_FUSED_NONE;
     bool is_input_nchw = false;
     bool is_filter_hwio = false;
-    int32_t dilation_w;
-    int32_t dilation_h;
+    int32_t dilation_w = 1;
+    int32_t dilation_h = 1;
     TENSOROPT_RETURN_IF_ERROR(
         readConstHostOperand(operation.inputs[3], padding_code));
     TENSOROPT_RETURN_IF_ERROR(
@@ -844,15 +1093,15 @@ struct Converter {
     TENSOROPT_RETURN_IF_ERROR(
         readConstHostOperand(operation.inputs[5], stride_h));
     TENSOROPT_RETURN_IF_ERROR(
-        readOptionalConstHostOperand(operation, 6, fuse_code));
+        readOptionalConstHostOperand(operation, fuse_idx, fuse_code));
     TENSOROPT_RETURN_IF_ERROR(
-        readOptionalConstHostOperand(operation, 7, is_input_nchw));
+        readOptionalConstHostOperand(operation, fuse_idx + 1, is_input_nchw));
     TENSOROPT_RETURN_IF_ERROR(
-        readOptionalConstHostOperand(operation, 8, is_filter_hwio));
+        readOptionalConstHostOperand(operation, fuse_idx + 2, is_filter_hwio));
     TENSOROPT_RETURN_IF_ERROR(
-        readOptionalConstHostOperand(operation, 9, dilation_w));
+        readOptionalConstHostOperand(operation, fuse_idx + 3, dilation_w));
     TENSOROPT_RETURN_IF_ERROR(
-        readOptionalConstHostOperand(operation, 10, dilation_h));
+        readOptionalConstHostOperand(operation, fuse_idx + 4, dilation_h));
     TENSOROPT_RETURN_IF_ERROR(
         getImgNCHWTensor(operation, 0, is_input_nchw, img_nchw_in));
     TENSOROPT_RETURN_IF_ERROR(
@@ -900,25 +1149,28 @@ struct Converter {
         return ANEURALNETWORKS_OP_FAILED;
     }
     IMGDNN_RETURN_ERR_IF_ERROR(ret);
-    imgdnn_tensor img_same_input_format_out;
-    TENSOROPT_RETURN_IF_ERROR(getSameFormatImgTensor(
-        is_input_nchw, img_nchw_out, img_same_input_format_out));
 
-    imgdnn_tensor& img_out = img_tensors[operation.outputs[0]];
+    // The bias is added in NCHW
+    imgdnn_tensor img_nchw_res;
     auto bias_op_idx = operation.inputs[2];
     const auto& bias_op = model->operands[bias_op_idx];
     if (bias_op.dimensionCount == 0) {
-      img_out = img_same_input_format_out;
+      img_nchw_res = img_nchw_out;
     } else if (bias_op.dimensionCount == 1) {
       imgdnn_tensor img_bias;
-      TENSOROPT_RETURN_IF_ERROR(getImgTensor(bias_op_idx, img_bias));
+      TENSOROPT_RETURN_IF_ERROR(getImgChannelTensor(bias_op_idx, img_bias));
       TENSOROPT_RETURN_IF_ERROR(convertBinaryHelper(
-          ANEURALNETWORKS_ADD, img_same_input_format_out, img_bias, img_out));
+          ANEURALNETWORKS_ADD, img_nchw_out, img_bias, img_nchw_res));
     } else {
       VLOG_AT("Error: Expected 0 or 1 dimensionCount for bias operand but got "
               << bias_op.dimensionCount);
       return ANEURALNETWORKS_OP_FAILED;
     }
+    // The activation is applied once the bias is added. IMGDNN does not
+    // provide a convolution with a fused bias or activation so these are
+    // separate operations of the network.
+    TENSOROPT_RETURN_IF_ERROR(addOptionalFuseCode(fuse_code, img_nchw_res));
+    setNCHWOutputImgTensor(operation.outputs[0], is_input_nchw, img_nchw_res);
     return ANEURALNETWORKS_NO_ERROR;
   }
 
@@ -959,7 +1211,6 @@ struct Converter {
 
     imgdnn_tensor img_in;
     std::vector<int32_t> permutations;
-    TENSOROPT_RETURN_IF_ERROR(getImgTensor(operation.inputs[0], img_in));
     TENSOROPT_RETURN_IF_ERROR(
         readConstHostOperand(operation.inputs[1], permutations));
     auto rank = model->operands[operation.inputs[0]].dimensionCount;
@@ -967,6 +1218,24 @@ struct Converter {
         checkVectorEqualRank(rank, permutations, "permutations"));
 
     imgdnn_tensor& img_out = img_tensors[operation.outputs[0]];
+    auto in_idx = operation.inputs[0];
+    if (!img_tensors.count(in_idx) && hasImgNCHWTensor(in_idx)) {
+      // Transpose the NCHW tensor directly instead of creating the NHWC one
+      static constexpr std::array<int, 4> nchw_to_nhwc{0, 2, 3, 1};
+      std::vector<int> nchw_permutations(permutations.size());
+      for (std::size_t i = 0; i < permutations.size(); ++i) {
+        TENSOROPT_RETURN_IF_COND(
+            permutations[i] < 0 || permutations[i] >= 4,
+            "Error: invalid permutation " << permutations[i],
+            ANEURALNETWORKS_OP_FAILED);
+        nchw_permutations[i] =
+            nchw_to_nhwc[static_cast<std::size_t>(permutations[i])];
+      }
+      TENSOROPT_RETURN_IF_ERROR(convertTransposeHelper(
+          nchw_img_tensors[in_idx], nchw_permutations, img_out));
+      return ANEURALNETWORKS_NO_ERROR;
+    }
+    TENSOROPT_RETURN_IF_ERROR(getImgTensor(in_idx, img_in));
     TENSOROPT_RETURN_IF_ERROR(
         convertTransposeHelper(img_in, permutations, img_out));
 
@@ -1043,28 +1312,14 @@ struct Converter {
         readConstHostOperand(operation.inputs[1], begins));
     TENSOROPT_RETURN_IF_ERROR(readConstHostOperand(operation.inputs[2], sizes));
 
-    auto input_op = model->operands[operation.inputs[0]];
-    auto rank = input_op.dimensionCount;
-    TENSOROPT_RETURN_IF_ERROR(checkVectorEqualRank(rank, begins, "begins"));
-    TENSOROPT_RETURN_IF_ERROR(checkVectorEqualRank(rank, sizes, "sizes"));
-    std::vector<std::size_t> img_starts(rank);
-    std::vector<std::size_t> img_ends(rank);
-    std::vector<std::size_t> img_strides(rank, 1);
-    for (unsigned i = 0; i < rank; ++i) {
-      img_starts[i] = static_cast<std::size_t>(begins[i]);
-      if (sizes[i] < 0) {
-        img_ends[i] = static_cast<std::size_t>(
-            static_cast<long>(input_op.dimensions[i]) + INCLUSIVE_END);
-      } else {  // sizes[i] cannot be 0
-        img_ends[i] =
-            img_starts[i] + static_cast<std::size_t>(sizes[i] + INCLUSIVE_END);
-      }
-    }
+    SliceBounds bounds;
+    TENSOROPT_RETURN_IF_ERROR(getSliceBounds(
+        model->operands[operation.inputs[0]], begins, sizes, bounds));
 
     imgdnn_tensor& img_out = img_tensors[operation.outputs[0]];
     BACKEND_CALL_RET(img_out, imgdnnNetworkSubTensor,
-                     compilation->imgdnn_network_, img_in, img_starts.data(),
-                     img_ends.data(), img_strides.data(), &ret);
+                     compilation->imgdnn_network_, img_in, bounds.starts.data(),
+                     bounds.ends.data(), bounds.strides.data(), &ret);
     IMGDNN_RETURN_ERR_IF_ERROR(ret);
 
     return ANEURALNETWORKS_NO_ERROR;
@@ -1101,76 +1356,23 @@ struct Converter {
     TENSOROPT_RETURN_IF_ERROR(
         readOptionalConstHostOperand(operation, 8, new_axis_mask));
 
-    auto input_op = model->operands[operation.inputs[0]];
-    auto rank = input_op.dimensionCount;
-    TENSOROPT_RETURN_IF_ERROR(
-        checkVectorSmallerOrEqualRank(rank, begins, "begins"));
-    TENSOROPT_RETURN_IF_COND(ends.size() != begins.size(),
-                             "Error: 'ends' argument is of size "
-                                 << ends.size() << " but expected "
-                                 << begins.size() << ".",
-                             ANEURALNETWORKS_OP_FAILED);
-    TENSOROPT_RETURN_IF_COND(strides.size() != begins.size(),
-                             "Error: 'strides' argument is of size "
-                                 << strides.size() << " but expected "
-                                 << begins.size() << ".",
-                             ANEURALNETWORKS_OP_FAILED);
-    if (ellipsis_mask.none()) {
-      TENSOROPT_RETURN_IF_ERROR(checkVectorEqualRank(rank, begins, "begins"));
-    } else if (begins.size() < rank) {
-      unsigned ellipsis = 0;
-      while (!ellipsis_mask[ellipsis] && ellipsis < rank) {
-        ++ellipsis;
-      }
-      if (ellipsis < rank) {
-        std::size_t diff = rank - begins.size();
-        begins.insert(begins.begin() + ellipsis, diff, 0);
-        ends.insert(ends.begin() + ellipsis, diff, -1);
-        strides.insert(strides.begin() + ellipsis, diff, 1);
-      }
-    }
-    std::vector<std::size_t> img_starts(rank);
-    std::vector<std::size_t> img_ends(rank);
-    std::vector<std::size_t> img_strides(rank);
-    for (unsigned i = 0; i < rank; ++i) {
-      if (begin_mask[i] || begins[i] < 0) {
-        img_starts[i] = 0;
-      } else {
-        img_starts[i] = static_cast<std::size_t>(begins[i]);
-      }
-      if (shrink_axis_mask[i]) {
-        img_ends[i] = img_starts[i] + (1 + INCLUSIVE_END);
-        img_strides[i] = 1;
-        continue;
-      }
-      if (end_mask[i] || ends[i] < 0) {
-        img_ends[i] = static_cast<std::size_t>(
-            static_cast<long>(input_op.dimensions[i]) + INCLUSIVE_END);
-      } else {  // ends[i] cannot be 0
-        img_ends[i] = static_cast<std::size_t>(ends[i] + INCLUSIVE_END);
-      }
-      if (strides[i] <= 0) {
-        VLOG_AT("Error: strides must be stricly positive but got ["
-                << arrayToString(strides, rank) << "].");
-        return ANEURALNETWORKS_OP_FAILED;
-      }
-      img_strides[i] = static_cast<std::size_t>(strides[i]);
-    }
+    SliceBounds bounds;
+    TENSOROPT_RETURN_IF_ERROR(getStridedSliceBounds(
+        model->operands[operation.inputs[0]], begins, ends, strides,
+        begin_mask, end_mask, shrink_axis_mask, ellipsis_mask, bounds));
 
     imgdnn_tensor img_strided_slice;
     BACKEND_CALL_RET(img_strided_slice, imgdnnNetworkSubTensor,
-                     compilation->imgdnn_network_, img_in, img_starts.data(),
-                     img_ends.data(), img_strides.data(), &ret);
+                     compilation->imgdnn_network_, img_in, bounds.starts.data(),
+                     bounds.ends.data(), bounds.strides.data(), &ret);
     IMGDNN_RETURN_ERR_IF_ERROR(ret);
 
+    // Shrunk and new axes are handled by reshaping the result to the shape of
+    // the output which is checked by the shape inference. No reshape is
+    // created if the shapes are equal.
     imgdnn_tensor& img_out = img_tensors[operation.outputs[0]];
-    if (new_axis_mask.none()) {
-      img_out = img_strided_slice;
-    } else {
-      // TensorOpt assumes the shape provided by the output is correct.
-      TENSOROPT_RETURN_IF_ERROR(convertReshapeHelper(
-          img_strided_slice, operation.outputs[0], img_out));
-    }
+    TENSOROPT_RETURN_IF_ERROR(convertReshapeHelper(
+        img_strided_slice, operation.outputs[0], img_out));
 
     return ANEURALNETWORKS_NO_ERROR;
   }
@@ -1224,10 +1426,21 @@ struct Converter {
 }  // end namespace
 
 ResultCode convertModel(ANeuralNetworksCompilation* compilation) {
+  using statistics_clock_t = ANeuralNetworksCompilation::statistics_clock_t;
+  auto& durations = compilation->durations;
+  auto start = statistics_clock_t::now();
+  compilation->optimized_model = *compilation->model;
+  TENSOROPT_RETURN_IF_ERROR(optimizeModel(compilation->optimized_model));
+  durations[ANEURALNETWORKS_COMPILATION_DURATION_OPTIMIZE] =
+      getNanoseconds(start, statistics_clock_t::now());
+
   imgdnn_err_code ret;
   BACKEND_CALL_RET(compilation->imgdnn_network_, imgdnnCreateNetwork, &ret);
   IMGDNN_RETURN_ERR_IF_ERROR(ret);
 
   Converter converter(compilation);
-  return converter();
+  TENSOROPT_RETURN_IF_ERROR(converter());
+  durations[ANEURALNETWORKS_COMPILATION_DURATION_CONVERT] =
+      getNanoseconds(start, statistics_clock_t::now());
+  return ANEURALNETWORKS_NO_ERROR;
 }
@@ -17,10 +17,27 @@
 
 #include <SYCL/codeplay.hpp>
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "backends/imgdnn/burst.hpp"
 #include "backends/imgdnn/compilation.hpp"
 #include "common/device.hpp"
 #include "common/event.hpp"
+#include "common/host_kernels.hpp"
 #include "common/memory.hpp"
+#include "common/shape_inference.hpp"
+#include "common/trace.hpp"
+#include "common/utils.hpp"
+
+/**
+ * Return the binding used to compute the execution.
+ */
+static imgdnn_binding getBinding(ANeuralNetworksExecution* execution,
+                                 ANeuralNetworksBurst* burst) {
+  return burst ? burst->imgdnn_binding_ : execution->imgdnn_binding_;
+}
 
 static ResultCode createCommon(ANeuralNetworksExecution* execution) {
   imgdnn_err_code ret;
@@ -52,14 +69,293 @@ static ResultCode createCommon(ANeuralNetworksExecution* execution) {
   return ANEURALNETWORKS_NO_ERROR;
 }
 
+/**
+ * Select the network object specialised for the input shapes of an execution
+ * created from a compilation with dynamic inputs.
+ * The binding is created again if the network object changed.
+ */
+static ResultCode selectSpecialisation(ANeuralNetworksExecution* execution) {
+  auto compilation = execution->dynamic_compilation;
+  execution->padded_input_shapes = execution->input_shapes;
+  padToDimensionBuckets(*compilation, execution->padded_input_shapes);
+  execution->output_shapes.clear();
+  if (execution->padded_input_shapes != execution->input_shapes) {
+    TENSOROPT_RETURN_IF_ERROR(inferDynamicOutputShapes(
+        *compilation, execution->input_shapes, execution->output_shapes));
+  }
+
+  std::shared_ptr<ANeuralNetworksCompilation> specialised;
+  TENSOROPT_RETURN_IF_ERROR(getSpecialisedCompilation(
+      compilation, execution->padded_input_shapes, specialised));
+  if (specialised == execution->specialised_compilation) {
+    return ANEURALNETWORKS_NO_ERROR;
+  }
+  if (execution->specialised_compilation) {
+    // The memories were imported in the context of the previous network
+    // object
+    execution->counters.num_memory_destroys +=
+        execution->memory_cache.imported_memories.size();
+    clearMemoryCache(execution->memory_cache);
+    BACKEND_CALL(imgdnnBindingDestroy, execution->imgdnn_binding_);
+  }
+  execution->specialised_compilation = specialised;
+  execution->imgdnn_network_object_ = specialised->imgdnn_network_object_;
+  execution->imgdnn_device_ = specialised->imgdnn_device_;
+  execution->imgdnn_context_ = specialised->imgdnn_context_;
+  return createCommon(execution);
+}
+
+/**
+ * Return the operand type of a model operand with the given shape.
+ * The type is only valid as long as shape is.
+ */
+static ANeuralNetworksOperandType getShapedOperandType(
+    const ANeuralNetworksModel& model, uint32_t operand,
+    const std::vector<uint32_t>& shape) {
+  auto type = model.operands[operand];
+  type.dimensionCount = static_cast<uint32_t>(shape.size());
+  type.dimensions = shape.data();
+  return type;
+}
+
+/**
+ * Return the shape of an output of the selected network object.
+ */
+static ResultCode getImgOutputShape(ANeuralNetworksExecution* execution,
+                                    uint32_t index,
+                                    std::vector<uint32_t>& shape) {
+  imgdnn_err_code ret;
+  imgdnn_tensor_descriptor descriptor;
+  BACKEND_CALL_RET(descriptor, imgdnnGetOutputDescriptor,
+                   execution->imgdnn_outputs_[index], &ret);
+  IMGDNN_RETURN_ERR_IF_ERROR(ret);
+  shape.assign(descriptor.size, descriptor.size + descriptor.dimensions);
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+/**
+ * Return the cache of the memories imported for the host pointers.
+ */
+static MemoryCache& getMemoryCache(ANeuralNetworksExecution* execution,
+                                   ANeuralNetworksBurst* burst) {
+  return burst ? burst->memory_cache : execution->memory_cache;
+}
+
+/**
+ * Bind host memory to an input.
+ * The memory imported by a previous computation is reused and the input is
+ * only bound again if the memory changed.
+ */
+static ResultCode bindHostInput(ANeuralNetworksExecution* execution,
+                                ANeuralNetworksBurst* burst, uint32_t index,
+                                const void* data, std::size_t length) {
+  imgdnn_memory img_memory;
+  bool bound;
+  TENSOROPT_RETURN_IF_ERROR(getCachedMemory(
+      getMemoryCache(execution, burst), execution->imgdnn_context_, index,
+      true, const_cast<void*>(data), length, false, execution->counters,
+      img_memory, bound));
+  if (!bound) {
+    imgdnn_err_code ret;
+    BACKEND_CALL_RET(ret, imgdnnBindingAddInput, getBinding(execution, burst),
+                     execution->imgdnn_inputs_[index], img_memory);
+    IMGDNN_RETURN_ERR_IF_ERROR(ret);
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+/**
+ * Bind host memory to an output, see bindHostInput.
+ */
+static ResultCode bindHostOutput(ANeuralNetworksExecution* execution,
+                                 ANeuralNetworksBurst* burst, uint32_t index,
+                                 void* data, std::size_t length) {
+  imgdnn_memory img_memory;
+  bool bound;
+  TENSOROPT_RETURN_IF_ERROR(getCachedMemory(
+      getMemoryCache(execution, burst), execution->imgdnn_context_, index,
+      false, data, length, false, execution->counters, img_memory, bound));
+  if (!bound) {
+    imgdnn_err_code ret;
+    BACKEND_CALL_RET(ret, imgdnnBindingAddOutput, getBinding(execution, burst),
+                     execution->imgdnn_outputs_[index], img_memory);
+    IMGDNN_RETURN_ERR_IF_ERROR(ret);
+  }
+  // Store the memory objects to be able to lock them once computed
+  execution->host_output_memories.emplace_back(data, length, img_memory);
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+/**
+ * Bind the host memories of the execution to the binding in use.
+ */
+static ResultCode bindHostMemories(ANeuralNetworksExecution* execution,
+                                   ANeuralNetworksBurst* burst) {
+  for (const auto& input_pair : execution->host_inputs) {
+    const auto& input = input_pair.second;
+    TENSOROPT_RETURN_IF_ERROR(bindHostInput(execution, burst, input.index,
+                                            input.data, input.length));
+  }
+  for (const auto& output_pair : execution->host_outputs) {
+    const auto& output = output_pair.second;
+    TENSOROPT_RETURN_IF_ERROR(bindHostOutput(execution, burst, output.index,
+                                             output.data, output.length));
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+/**
+ * Select the specialised network object and bind the host memories of the
+ * execution.
+ */
+static ResultCode bindDynamicExecution(ANeuralNetworksExecution* execution) {
+  TENSOROPT_RETURN_IF_ERROR(selectSpecialisation(execution));
+  const auto& model = *execution->dynamic_compilation->model;
+  const auto& input_shapes = execution->input_shapes;
+  const auto& padded_input_shapes = execution->padded_input_shapes;
+  {
+    std::lock_guard<std::mutex> lock(execution->identified_memory_mutex);
+    for (const auto& input_pair : execution->identified_memory_inputs) {
+      auto index = input_pair.first;
+      TENSOROPT_RETURN_IF_COND(
+          input_shapes[index] != padded_input_shapes[index],
+          "Error: input " << index << " cannot be padded from device memory",
+          ANEURALNETWORKS_BAD_DATA);
+    }
+    std::vector<uint32_t> padded_shape;
+    for (const auto& output_pair : execution->identified_memory_outputs) {
+      if (execution->output_shapes.empty()) {
+        break;
+      }
+      auto index = output_pair.first;
+      TENSOROPT_RETURN_IF_ERROR(
+          getImgOutputShape(execution, index, padded_shape));
+      TENSOROPT_RETURN_IF_COND(
+          execution->output_shapes[index] != padded_shape,
+          "Error: output " << index << " cannot be sliced to device memory",
+          ANEURALNETWORKS_BAD_DATA);
+    }
+  }
+
+  execution->padded_host_inputs.resize(model.inputs.size());
+  for (const auto& input_pair : execution->host_inputs) {
+    const auto& input = input_pair.second;
+    const auto& shape = input_shapes[input.index];
+    const auto& padded_shape = padded_input_shapes[input.index];
+    if (shape == padded_shape) {
+      TENSOROPT_RETURN_IF_ERROR(bindHostInput(
+          execution, nullptr, input.index, input.data, input.length));
+      continue;
+    }
+    auto operand = model.inputs[input.index];
+    auto& padded = execution->padded_host_inputs[input.index];
+    TENSOROPT_RETURN_IF_ERROR(
+        hostPad(getShapedOperandType(model, operand, shape), input.data,
+                getShapedOperandType(model, operand, padded_shape), padded));
+    TENSOROPT_RETURN_IF_ERROR(bindHostInput(execution, nullptr, input.index,
+                                            padded.data(), padded.size()));
+  }
+
+  std::vector<uint32_t> padded_shape;
+  execution->padded_host_outputs.resize(model.outputs.size());
+  for (const auto& output_pair : execution->host_outputs) {
+    const auto& output = output_pair.second;
+    if (execution->output_shapes.empty()) {
+      TENSOROPT_RETURN_IF_ERROR(bindHostOutput(
+          execution, nullptr, output.index, output.data, output.length));
+      continue;
+    }
+    TENSOROPT_RETURN_IF_ERROR(
+        getImgOutputShape(execution, output.index, padded_shape));
+    auto operand = model.outputs[output.index];
+    execution->sliced_host_outputs.push_back(output);
+    auto& padded = execution->padded_host_outputs[output.index];
+    padded.resize(getOperandTypeSizeBytes(
+        getShapedOperandType(model, operand, padded_shape)));
+    TENSOROPT_RETURN_IF_ERROR(bindHostOutput(execution, nullptr, output.index,
+                                             padded.data(), padded.size()));
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+/**
+ * Copy the padded outputs of a dynamic execution to the user's memory.
+ */
+static ResultCode slicePaddedOutputs(ANeuralNetworksExecution* execution) {
+  const auto& model = *execution->dynamic_compilation->model;
+  std::vector<uint32_t> padded_shape;
+  host_data_t sliced;
+  for (const auto& output : execution->sliced_host_outputs) {
+    const auto& shape = execution->output_shapes[output.index];
+    TENSOROPT_RETURN_IF_ERROR(
+        getImgOutputShape(execution, output.index, padded_shape));
+    SliceBounds bounds;
+    for (auto dim : shape) {
+      bounds.starts.push_back(0);
+      bounds.ends.push_back(dim - 1);
+      bounds.strides.push_back(1);
+    }
+    auto operand = model.outputs[output.index];
+    TENSOROPT_RETURN_IF_ERROR(hostSubTensor(
+        getShapedOperandType(model, operand, padded_shape),
+        execution->padded_host_outputs[output.index].data(), bounds,
+        getShapedOperandType(model, operand, shape), sliced));
+    TENSOROPT_RETURN_IF_COND(sliced.size() > output.length,
+                             "Error: output " << output.index
+                                              << " is too small, expected "
+                                              << sliced.size() << " bytes",
+                             ANEURALNETWORKS_BAD_DATA);
+    std::memcpy(output.data, sliced.data(), sliced.size());
+  }
+  execution->sliced_host_outputs.clear();
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+/**
+ * Set the concrete shape of an input of an execution created from a
+ * compilation with dynamic inputs.
+ * The declared shape is kept if type is a nullptr.
+ */
+static ResultCode setDynamicInputShape(ANeuralNetworksExecution* execution,
+                                       uint32_t index,
+                                       const ANeuralNetworksOperandType* type) {
+  const auto& model = *execution->dynamic_compilation->model;
+  TENSOROPT_RETURN_IF_COND(index >= model.inputs.size(),
+                           "Error: invalid input index " << index,
+                           ANEURALNETWORKS_BAD_DATA);
+  if (!type) {
+    return ANEURALNETWORKS_NO_ERROR;
+  }
+  auto shape = getOperandShape(*type);
+  TENSOROPT_RETURN_IF_COND(
+      !isShapeKnown(shape) ||
+          !isShapeCompatible(
+              getOperandShape(model.operands[model.inputs[index]]), shape),
+      "Error: type of input " << index << " does not match the model",
+      ANEURALNETWORKS_BAD_DATA);
+  execution->input_shapes[index] = std::move(shape);
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
 ResultCode ANeuralNetworksExecution_create(
     ANeuralNetworksCompilation* compilation,
     ANeuralNetworksExecution** execution) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_RETURN_IF_NULL(compilation);
   TENSOROPT_RETURN_IF_UNFINISHED(compilation);
   *execution = new ANeuralNetworksExecution();
   (*execution)->created_from_compilation = true;
   (*execution)->device = compilation->device;
+  if (compilation->has_dynamic_inputs) {
+    (*execution)->dynamic_compilation = compilation;
+    for (auto input : compilation->model->inputs) {
+      (*execution)->input_shapes.push_back(
+          getOperandShape(compilation->model->operands[input]));
+    }
+    (*execution)->identified_memory_lock = std::unique_lock<std::mutex>(
+        (*execution)->identified_memory_mutex, std::defer_lock);
+    return ANEURALNETWORKS_NO_ERROR;
+  }
   (*execution)->imgdnn_network_object_ = compilation->imgdnn_network_object_;
   (*execution)->imgdnn_device_ = compilation->imgdnn_device_;
   (*execution)->imgdnn_context_ = compilation->imgdnn_context_;
@@ -69,6 +365,7 @@ ResultCode ANeuralNetworksExecution_create(
 ResultCode ANeuralNetworksExecution_createFromBinary(
     const void* data, std::size_t data_size,
     const ANeuralNetworksDevice* device, ANeuralNetworksExecution** execution) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_RETURN_IF_NULL(data);
   *execution = new ANeuralNetworksExecution();
   (*execution)->device = device;
@@ -92,23 +389,65 @@ ResultCode ANeuralNetworksExecution_setInput(
     ANeuralNetworksExecution* execution, int32_t index,
     const ANeuralNetworksOperandType* type, const void* data,
     std::size_t length) {
-  TENSOROPT_UNUSED_VARIABLE(type);
+  TENSOROPT_TRACE_API();
+  TENSOROPT_TO_UINT32_INDEX(index, uindex);
+  if (execution->dynamic_compilation) {
+    TENSOROPT_RETURN_IF_ERROR(setDynamicInputShape(execution, uindex, type));
+  }
 
   // Optional inputs are not added
+  execution->host_inputs.erase(uindex);
   if (data && length > 0) {
-    imgdnn_err_code ret;
-    imgdnn_memory img_memory;
-    BACKEND_CALL_RET(img_memory, imgdnnImportMemory, execution->imgdnn_context_,
-                     const_cast<void*>(data), length,
-                     IMGDNN_IMPORT_MEM_TYPE_CPU, &ret);
-    IMGDNN_RETURN_ERR_IF_ERROR(ret);
-    TENSOROPT_TO_UINT32_INDEX(index, uindex);
-    BACKEND_CALL_RET(ret, imgdnnBindingAddInput, execution->imgdnn_binding_,
-                     execution->imgdnn_inputs_[uindex], img_memory);
-    IMGDNN_RETURN_ERR_IF_ERROR(ret);
-    // Store the memory objects to free them after the execution
-    execution->imgdnn_memories_.push_back(img_memory);
+    execution->host_inputs[uindex] =
+        ANeuralNetworksExecution::HostMemory(uindex, const_cast<void*>(data),
+                                             length);
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+/**
+ * Set the device memory of an input or output.
+ * A sub-buffer is created if only a range of memory is used. The sub-buffer
+ * of the previous call is reused if the buffer and range are the same so that
+ * the memory imported by a burst can be reused.
+ */
+static ResultCode setIdentifiedMemory(
+    ANeuralNetworksExecution* execution,
+    std::map<uint32_t, ANeuralNetworksExecution::IdentifiedMemory>& memories,
+    uint32_t index, const ANeuralNetworksMemory* memory, std::size_t offset,
+    std::size_t length) {
+  auto buffer_size = memory->buffer.get_count();
+  TENSOROPT_RETURN_IF_COND(
+      offset > buffer_size || length > buffer_size - offset,
+      "Error: range is out of the memory of size " << buffer_size,
+      ANEURALNETWORKS_BAD_DATA);
+  auto align = execution->device->mem_base_addr_align;
+  TENSOROPT_RETURN_IF_COND(
+      align > 0 && offset % align != 0,
+      "Error: offset must be a multiple of the device alignment " << align,
+      ANEURALNETWORKS_BAD_DATA);
+
+  // Memory object is const_casted here to be able to create accessors from
+  // the underlying buffer
+  auto cc_memory = const_cast<ANeuralNetworksMemory*>(memory);
+  std::lock_guard<std::mutex> lock(execution->identified_memory_mutex);
+  auto it = memories.find(index);
+  if (it != memories.end() && it->second.sub_buffer &&
+      it->second.memory == cc_memory && it->second.offset == offset &&
+      it->second.length == length &&
+      *it->second.parent_buffer == cc_memory->buffer) {
+    return ANEURALNETWORKS_NO_ERROR;
   }
+  ANeuralNetworksExecution::IdentifiedMemory identified_memory(
+      cc_memory, offset, length);
+  if (offset != 0 || length != buffer_size) {
+    identified_memory.parent_buffer =
+        std::make_shared<tensoropt_buffer_t>(cc_memory->buffer);
+    identified_memory.sub_buffer = std::make_shared<tensoropt_buffer_t>(
+        cc_memory->buffer, cl::sycl::id<1>(offset),
+        cl::sycl::range<1>(length));
+  }
+  memories[index] = identified_memory;
   return ANEURALNETWORKS_NO_ERROR;
 }
 
@@ -116,21 +455,18 @@ ResultCode ANeuralNetworksExecution_setInputFromMemory(
     ANeuralNetworksExecution* execution, int32_t index,
     const ANeuralNetworksOperandType* type, const ANeuralNetworksMemory* memory,
     std::size_t offset, std::size_t length) {
-  TENSOROPT_UNUSED_VARIABLE(type);
-  if (offset != 0) {
-    // TODO: handle offset by adding subtensors in the compilation stage?
-    VLOG_AT("Error: non-zero offsets are not supported");
-    return ANEURALNETWORKS_BAD_DATA;
+  TENSOROPT_TRACE_API();
+  TENSOROPT_TO_UINT32_INDEX(index, uindex);
+  if (execution->dynamic_compilation) {
+    TENSOROPT_RETURN_IF_ERROR(setDynamicInputShape(execution, uindex, type));
   }
 
   // Optional inputs are not added
+  execution->host_inputs.erase(uindex);
   if (memory && length > 0) {
-    // Memory object is const_casted here to be able to create accessors from
-    // the underlying buffer
-    auto cc_memory = const_cast<ANeuralNetworksMemory*>(memory);
-    TENSOROPT_TO_UINT32_INDEX(index, uindex);
-    std::lock_guard<std::mutex> lock(execution->identified_memory_mutex);
-    execution->identified_memory_inputs[uindex] = {cc_memory, offset, length};
+    TENSOROPT_RETURN_IF_ERROR(
+        setIdentifiedMemory(execution, execution->identified_memory_inputs,
+                            uindex, memory, offset, length));
   }
   return ANEURALNETWORKS_NO_ERROR;
 }
@@ -138,21 +474,15 @@ ResultCode ANeuralNetworksExecution_setInputFromMemory(
 ResultCode ANeuralNetworksExecution_setOutput(
     ANeuralNetworksExecution* execution, int32_t index,
     const ANeuralNetworksOperandType* type, void* data, std::size_t length) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_UNUSED_VARIABLE(type);
 
   // Optional outputs are not added
+  TENSOROPT_TO_UINT32_INDEX(index, uindex);
+  execution->host_outputs.erase(uindex);
   if (data && length > 0) {
-    imgdnn_err_code ret;
-    imgdnn_memory img_memory;
-    BACKEND_CALL_RET(img_memory, imgdnnImportMemory, execution->imgdnn_context_,
-                     data, length, IMGDNN_IMPORT_MEM_TYPE_CPU, &ret);
-    IMGDNN_RETURN_ERR_IF_ERROR(ret);
-    TENSOROPT_TO_UINT32_INDEX(index, uindex);
-    BACKEND_CALL_RET(ret, imgdnnBindingAddOutput, execution->imgdnn_binding_,
-                     execution->imgdnn_outputs_[uindex], img_memory);
-    IMGDNN_RETURN_ERR_IF_ERROR(ret);
-    // Store the memory objects to be able to lock and free them later
-    execution->host_output_memories.emplace_back(data, img_memory);
+    execution->host_outputs[uindex] =
+        ANeuralNetworksExecution::HostMemory(uindex, data, length);
   }
   return ANEURALNETWORKS_NO_ERROR;
 }
@@ -161,21 +491,16 @@ ResultCode ANeuralNetworksExecution_setOutputFromMemory(
     ANeuralNetworksExecution* execution, int32_t index,
     const ANeuralNetworksOperandType* type, const ANeuralNetworksMemory* memory,
     std::size_t offset, std::size_t length) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_UNUSED_VARIABLE(type);
-  if (offset != 0) {
-    // TODO: handle offset by adding subtensors in the compilation stage?
-    VLOG_AT("Error: non-zero offsets are not supported");
-    return ANEURALNETWORKS_BAD_DATA;
-  }
 
   // Optional outputs are not added
+  TENSOROPT_TO_UINT32_INDEX(index, uindex);
+  execution->host_outputs.erase(uindex);
   if (memory && length > 0) {
-    // Memory object is const_casted here to be able to create accessors from
-    // the underlying buffer
-    auto cc_memory = const_cast<ANeuralNetworksMemory*>(memory);
-    TENSOROPT_TO_UINT32_INDEX(index, uindex);
-    std::lock_guard<std::mutex> lock(execution->identified_memory_mutex);
-    execution->identified_memory_outputs[uindex] = {cc_memory, offset, length};
+    TENSOROPT_RETURN_IF_ERROR(
+        setIdentifiedMemory(execution, execution->identified_memory_outputs,
+                            uindex, memory, offset, length));
   }
   return ANEURALNETWORKS_NO_ERROR;
 }
@@ -209,13 +534,46 @@ static void imgdnnDescriptorToRTOperandType(
   op.dimensions = topt_dims.data();
 }
 
+/**
+ * Return whether the identified inputs and outputs have to be read from the
+ * model of a dynamic compilation because no specialisation was selected yet.
+ */
+static bool useDynamicModel(const ANeuralNetworksExecution* execution) {
+  return execution->dynamic_compilation && execution->imgdnn_inputs_.empty() &&
+         execution->imgdnn_outputs_.empty();
+}
+
+/**
+ * Copy the types of the operands op_indices of the model of a dynamic
+ * compilation. The unknown dimensions are 0.
+ */
+static void getDynamicOperandTypes(const ANeuralNetworksExecution* execution,
+                                   const std::vector<uint32_t>& op_indices,
+                                   ANeuralNetworksOperandType* types) {
+  const auto& model = *execution->dynamic_compilation->model;
+  for (std::size_t i = 0; i < op_indices.size(); ++i) {
+    types[i] = model.operands[op_indices[i]];
+  }
+}
+
 uint32_t ANeuralNetworksExecution_getIdentifiedInputCount(
     const ANeuralNetworksExecution* execution) {
+  TENSOROPT_TRACE_API();
+  if (useDynamicModel(execution)) {
+    return static_cast<uint32_t>(
+        execution->dynamic_compilation->model->inputs.size());
+  }
   return static_cast<uint32_t>(execution->imgdnn_inputs_.size());
 }
 
 ResultCode ANeuralNetworksExecution_getIdentifiedInputs(
     ANeuralNetworksExecution* execution, ANeuralNetworksOperandType* inputs) {
+  TENSOROPT_TRACE_API();
+  if (useDynamicModel(execution)) {
+    getDynamicOperandTypes(
+        execution, execution->dynamic_compilation->model->inputs, inputs);
+    return ANEURALNETWORKS_NO_ERROR;
+  }
   imgdnn_err_code ret;
   for (std::size_t i = 0; i < execution->imgdnn_inputs_.size(); ++i) {
     imgdnn_tensor_descriptor descriptor;
@@ -229,11 +587,22 @@ ResultCode ANeuralNetworksExecution_getIdentifiedInputs(
 
 uint32_t ANeuralNetworksExecution_getIdentifiedOutputCount(
     const ANeuralNetworksExecution* execution) {
+  TENSOROPT_TRACE_API();
+  if (useDynamicModel(execution)) {
+    return static_cast<uint32_t>(
+        execution->dynamic_compilation->model->outputs.size());
+  }
   return static_cast<uint32_t>(execution->imgdnn_outputs_.size());
 }
 
 ResultCode ANeuralNetworksExecution_getIdentifiedOutputs(
     ANeuralNetworksExecution* execution, ANeuralNetworksOperandType* outputs) {
+  TENSOROPT_TRACE_API();
+  if (useDynamicModel(execution)) {
+    getDynamicOperandTypes(
+        execution, execution->dynamic_compilation->model->outputs, outputs);
+    return ANEURALNETWORKS_NO_ERROR;
+  }
   imgdnn_err_code ret;
   for (std::size_t i = 0; i < execution->imgdnn_outputs_.size(); ++i) {
     imgdnn_tensor_descriptor descriptor;
@@ -247,9 +616,19 @@ ResultCode ANeuralNetworksExecution_getIdentifiedOutputs(
 
 ResultCode ANeuralNetworksExecution_getOutputOperandDimensions(
     ANeuralNetworksExecution* execution, int32_t index, uint32_t* dimensions) {
+  TENSOROPT_TRACE_API();
+  if (execution->dynamic_compilation) {
+    TENSOROPT_RETURN_IF_ERROR(selectSpecialisation(execution));
+  }
+  TENSOROPT_TO_UINT32_INDEX(index, uindex);
+  // The network object computes the padded outputs
+  if (!execution->output_shapes.empty()) {
+    const auto& shape = execution->output_shapes[uindex];
+    std::copy(shape.begin(), shape.end(), dimensions);
+    return ANEURALNETWORKS_NO_ERROR;
+  }
   imgdnn_err_code ret;
   imgdnn_tensor_descriptor descriptor;
-  TENSOROPT_TO_UINT32_INDEX(index, uindex);
   BACKEND_CALL_RET(descriptor, imgdnnGetOutputDescriptor,
                    execution->imgdnn_outputs_[uindex], &ret);
   IMGDNN_RETURN_ERR_IF_ERROR(ret);
@@ -261,6 +640,10 @@ ResultCode ANeuralNetworksExecution_getOutputOperandDimensions(
 
 ResultCode ANeuralNetworksExecution_getOutputOperandRank(
     ANeuralNetworksExecution* execution, int32_t index, uint32_t* rank) {
+  TENSOROPT_TRACE_API();
+  if (execution->dynamic_compilation) {
+    TENSOROPT_RETURN_IF_ERROR(selectSpecialisation(execution));
+  }
   imgdnn_err_code ret;
   imgdnn_tensor_descriptor descriptor;
   TENSOROPT_TO_UINT32_INDEX(index, uindex);
@@ -273,6 +656,7 @@ ResultCode ANeuralNetworksExecution_getOutputOperandRank(
 
 ResultCode ANeuralNetworksExecution_compute(
     ANeuralNetworksExecution* execution) {
+  TENSOROPT_TRACE_API();
   ANeuralNetworksEvent* event;
   TENSOROPT_RETURN_IF_ERROR(
       ANeuralNetworksExecution_startCompute(execution, &event));
@@ -310,86 +694,165 @@ inline imgdnn_memory importImgMemory(
   BACKEND_CALL_RET(img_memory, imgdnnImportMemory, execution->imgdnn_context_,
                    h.get(acc), length, IMGDNN_IMPORT_MEM_TYPE_OPENCL, &ret);
   interopCheckImgdnnErr(ret);
+  ++execution->counters.num_memory_imports;
+  execution->counters.imported_bytes += length;
   return img_memory;
 }
 
-ResultCode ANeuralNetworksExecution_startCompute(
-    ANeuralNetworksExecution* execution, ANeuralNetworksEvent** output_event) {
+/**
+ * Get the IMGDNN memory of an accessor for an input or output.
+ * Without a burst the memory is imported and added to task_memories to be
+ * destroyed after the execution.
+ * Return false if the memory is already bound.
+ */
+template <class AccT>
+inline bool getAccessorMemory(ANeuralNetworksExecution* execution,
+                              ANeuralNetworksBurst* burst, uint32_t index,
+                              bool is_input, const AccT& acc,
+                              const cl::sycl::codeplay::interop_handle& h,
+                              std::vector<imgdnn_memory>& task_memories,
+                              imgdnn_memory& img_memory) {
+  if (burst) {
+    bool bound;
+    auto ret = getCachedMemory(burst->memory_cache, execution->imgdnn_context_,
+                               index, is_input, h.get(acc), acc.get_size(),
+                               true, execution->counters, img_memory, bound);
+    return ret == ANEURALNETWORKS_NO_ERROR && !bound;
+  }
+  img_memory = importImgMemory(execution, acc, h);
+  task_memories.push_back(img_memory);
+  return true;
+}
+
+/**
+ * Submit the execution of the network object with the bindings of the
+ * execution or of the burst if it is not null.
+ */
+static ResultCode submitCompute(ANeuralNetworksExecution* execution,
+                                ANeuralNetworksBurst* burst,
+                                cl::sycl::event& sycl_event) {
+  ++execution->counters.num_computations;
+  execution->timing_measured = false;
+  if (execution->measure_timing) {
+    execution->submit_time = ANeuralNetworksExecution::timing_clock_t::now();
+  }
+  if (execution->dynamic_compilation) {
+    TENSOROPT_RETURN_IF_ERROR(bindDynamicExecution(execution));
+  } else {
+    TENSOROPT_RETURN_IF_ERROR(bindHostMemories(execution, burst));
+  }
   // identified_memory_lock will be unlocked during the interop_task.
   // The lock is stored inside the execution to keep it alive long enough.
+  auto lock_start = std::chrono::steady_clock::now();
   execution->identified_memory_lock.lock();
+  execution->counters.lock_wait_duration +=
+      getNanoseconds(lock_start, std::chrono::steady_clock::now());
   auto& queue = execution->device->queue;
-  auto sycl_event = queue->submit([execution](
-                                      cl::sycl::codeplay::handler& cgh) {
+  sycl_event = queue->submit([execution,
+                              burst](cl::sycl::codeplay::handler& cgh) {
     execution->input_indexed_accessors.clear();
     for (const auto& input_pair : execution->identified_memory_inputs) {
       execution->input_indexed_accessors.emplace_back(
-          input_pair.first, input_pair.second.memory->buffer
+          input_pair.first, input_pair.second.getBuffer()
                                 .get_access<cl::sycl::access::mode::read>(cgh));
     }
     execution->output_indexed_accessors.clear();
     for (const auto& output_pair : execution->identified_memory_outputs) {
       execution->output_indexed_accessors.emplace_back(
           output_pair.first,
-          output_pair.second.memory->buffer
+          output_pair.second.getBuffer()
               .get_access<cl::sycl::access::mode::write>(cgh));
     }
-    cgh.interop_task([execution](const cl::sycl::codeplay::interop_handle& h) {
-      // imgdnn_memories objects need to be copied locally so that the next
-      // execution is not blocked
+    cgh.interop_task([execution,
+                      burst](const cl::sycl::codeplay::interop_handle& h) {
+      TENSOROPT_TRACE_SCOPE("interop_task", "device");
+      // Memories imported for the accessors, destroyed once executed
       std::vector<imgdnn_memory> task_memories;
-      task_memories.reserve(execution->imgdnn_memories_.size() +
-                            execution->input_indexed_accessors.size() +
+      task_memories.reserve(execution->input_indexed_accessors.size() +
                             execution->output_indexed_accessors.size());
-      task_memories = execution->imgdnn_memories_;
-      execution->imgdnn_memories_.clear();
+      imgdnn_binding binding = getBinding(execution, burst);
       imgdnn_err_code ret;
       // Bind inputs
+      imgdnn_memory img_memory;
       for (const auto& acc_pair : execution->input_indexed_accessors) {
-        imgdnn_memory img_memory =
-            importImgMemory(execution, acc_pair.second, h);
-        BACKEND_CALL_RET(ret, imgdnnBindingAddInput, execution->imgdnn_binding_,
-                         execution->imgdnn_inputs_[acc_pair.first], img_memory);
-        interopCheckImgdnnErr(ret);
-        task_memories.push_back(img_memory);
+        if (getAccessorMemory(execution, burst, acc_pair.first, true,
+                              acc_pair.second, h, task_memories, img_memory)) {
+          BACKEND_CALL_RET(ret, imgdnnBindingAddInput, binding,
+                           execution->imgdnn_inputs_[acc_pair.first],
+                           img_memory);
+          interopCheckImgdnnErr(ret);
+        }
       }
 
       // Bind outputs
       for (const auto& acc_pair : execution->output_indexed_accessors) {
-        imgdnn_memory img_memory =
-            importImgMemory(execution, acc_pair.second, h);
-        BACKEND_CALL_RET(
-            ret, imgdnnBindingAddOutput, execution->imgdnn_binding_,
-            execution->imgdnn_outputs_[acc_pair.first], img_memory);
-        interopCheckImgdnnErr(ret);
-        task_memories.push_back(img_memory);
+        if (getAccessorMemory(execution, burst, acc_pair.first, false,
+                              acc_pair.second, h, task_memories, img_memory)) {
+          BACKEND_CALL_RET(ret, imgdnnBindingAddOutput, binding,
+                           execution->imgdnn_outputs_[acc_pair.first],
+                           img_memory);
+          interopCheckImgdnnErr(ret);
+        }
       }
       execution->identified_memory_lock.unlock();
 
       // The IMGDNN execution is made blocking so that the returned
       // SYCL event represents the execution of the whole graph.
+      using timing_clock_t = ANeuralNetworksExecution::timing_clock_t;
+      if (execution->measure_timing) {
+        execution->start_time = timing_clock_t::now();
+      }
       BACKEND_CALL_RET(ret, imgdnnNetworkObjectExecute,
-                       execution->imgdnn_network_object_,
-                       execution->imgdnn_binding_, true, 0, nullptr, nullptr);
+                       execution->imgdnn_network_object_, binding, true, 0,
+                       nullptr, nullptr);
       interopCheckImgdnnErr(ret);
+      if (execution->measure_timing) {
+        execution->end_time = timing_clock_t::now();
+      }
 
       for (auto img_mem : task_memories) {
         BACKEND_CALL_RET(ret, imgdnnMemoryDestroy, img_mem);
         interopCheckImgdnnErr(ret);
       }
+      execution->counters.num_memory_destroys += task_memories.size();
     });
   });
   execution->dimensions.clear();
+  return ANEURALNETWORKS_NO_ERROR;
+}
 
+ResultCode ANeuralNetworksExecution_startCompute(
+    ANeuralNetworksExecution* execution, ANeuralNetworksEvent** output_event) {
+  TENSOROPT_TRACE_API();
+  cl::sycl::event sycl_event;
+  TENSOROPT_RETURN_IF_ERROR(submitCompute(execution, nullptr, sycl_event));
   if (output_event) {
     *output_event = new ANeuralNetworksEvent(sycl_event, execution);
   }
-
   return ANEURALNETWORKS_NO_ERROR;
 }
 
+ResultCode ANeuralNetworksExecution_burstCompute(
+    ANeuralNetworksExecution* execution, ANeuralNetworksBurst* burst) {
+  TENSOROPT_TRACE_API();
+  TENSOROPT_RETURN_IF_NULL(execution);
+  TENSOROPT_RETURN_IF_NULL(burst);
+  TENSOROPT_RETURN_IF_COND(
+      execution->imgdnn_network_object_ !=
+          burst->compilation->imgdnn_network_object_,
+      "Error: the execution and the burst use different compilations",
+      ANEURALNETWORKS_BAD_DATA);
+  std::lock_guard<std::mutex> lock(burst->mutex);
+  cl::sycl::event sycl_event;
+  TENSOROPT_RETURN_IF_ERROR(submitCompute(execution, burst, sycl_event));
+  ANeuralNetworksEvent event(sycl_event, execution);
+  return ANeuralNetworksEvent_wait(&event);
+}
+
 ResultCode ANeuralNetworksExecution_notifyWait(
     ANeuralNetworksExecution* execution) {
+  using timing_clock_t = ANeuralNetworksExecution::timing_clock_t;
+  auto copy_start_time = timing_clock_t::now();
   imgdnn_err_code ret;
   // Lock the memory to copy data from device to host
   void* output_ptr = nullptr;
@@ -403,24 +866,86 @@ ResultCode ANeuralNetworksExecution_notifyWait(
         ANEURALNETWORKS_BAD_DATA);
     BACKEND_CALL_RET(ret, imgdnnMemoryUnlock, hom.img_mem);
     IMGDNN_RETURN_ERR_IF_ERROR(ret);
-
-    // Destroy output memory now it's been read
-    BACKEND_CALL_RET(ret, imgdnnMemoryDestroy, hom.img_mem);
-    IMGDNN_RETURN_ERR_IF_ERROR(ret);
+    execution->counters.host_output_bytes += hom.length;
   }
   execution->host_output_memories.clear();
+  if (execution->dynamic_compilation) {
+    TENSOROPT_RETURN_IF_ERROR(slicePaddedOutputs(execution));
+  }
+
+  if (execution->measure_timing) {
+    auto copy_end_time = timing_clock_t::now();
+    auto& durations = execution->durations;
+    durations[getDurationIndex(ANEURALNETWORKS_DURATION_ON_HARDWARE)] =
+        getNanoseconds(execution->start_time, execution->end_time);
+    durations[getDurationIndex(ANEURALNETWORKS_DURATION_IN_DRIVER)] =
+        getNanoseconds(execution->submit_time, copy_end_time);
+    durations[getDurationIndex(ANEURALNETWORKS_DURATION_IN_QUEUE)] =
+        getNanoseconds(execution->submit_time, execution->start_time);
+    durations[getDurationIndex(ANEURALNETWORKS_DURATION_COPY_TO_HOST)] =
+        getNanoseconds(copy_start_time, copy_end_time);
+    execution->timing_measured = true;
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode ANeuralNetworksExecution_getStatistics(
+    const ANeuralNetworksExecution* execution,
+    ANeuralNetworksExecutionStatistics* statistics) {
+  TENSOROPT_TRACE_API();
+  TENSOROPT_RETURN_IF_NULL(execution);
+  TENSOROPT_RETURN_IF_NULL(statistics);
+  const auto& counters = execution->counters;
+  statistics->num_computations = counters.num_computations;
+  statistics->num_memory_imports = counters.num_memory_imports;
+  statistics->num_memory_destroys = counters.num_memory_destroys;
+  statistics->imported_bytes = counters.imported_bytes;
+  statistics->host_output_bytes = counters.host_output_bytes;
+  statistics->lock_wait_duration = counters.lock_wait_duration;
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode ANeuralNetworksExecution_setMeasureTiming(
+    ANeuralNetworksExecution* execution, bool measure) {
+  TENSOROPT_TRACE_API();
+  TENSOROPT_RETURN_IF_NULL(execution);
+  execution->measure_timing = measure;
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode ANeuralNetworksExecution_getDuration(
+    const ANeuralNetworksExecution* execution, int32_t duration_code,
+    uint64_t* duration) {
+  TENSOROPT_TRACE_API();
+  TENSOROPT_RETURN_IF_NULL(execution);
+  TENSOROPT_RETURN_IF_NULL(duration);
+  auto duration_idx = getDurationIndex(duration_code);
+  TENSOROPT_RETURN_IF_COND(duration_idx == NUM_DURATIONS,
+                           "Error: invalid duration code " << duration_code,
+                           ANEURALNETWORKS_BAD_DATA);
+  if (!execution->timing_measured) {
+    *duration = UINT64_MAX;
+    return ANEURALNETWORKS_NO_ERROR;
+  }
+  *duration = execution->durations[duration_idx];
   return ANEURALNETWORKS_NO_ERROR;
 }
 
 void ANeuralNetworksExecution_free(ANeuralNetworksExecution* execution) {
+  TENSOROPT_TRACE_API();
   if (!execution) {
     return;
   }
+  clearMemoryCache(execution->memory_cache);
   // If compilation was provided it will free its own imgdnn object
   if (!execution->created_from_compilation) {
     BACKEND_CALL(imgdnnNetworkObjectDestroy, execution->imgdnn_network_object_);
     BACKEND_CALL(imgdnnContextDestroy, execution->imgdnn_context_);
   }
-  BACKEND_CALL(imgdnnBindingDestroy, execution->imgdnn_binding_);
+  // The binding of a dynamic execution is only created once a specialisation
+  // is selected
+  if (execution->imgdnn_binding_) {
+    BACKEND_CALL(imgdnnBindingDestroy, execution->imgdnn_binding_);
+  }
   delete execution;
 }
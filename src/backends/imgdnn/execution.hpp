@@ -16,13 +16,47 @@
 #ifndef SRC_BACKENDS_IMGDNN_EXECUTION_HPP
 #define SRC_BACKENDS_IMGDNN_EXECUTION_HPP
 
+#include <array>
+#include <chrono>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <vector>
 
 #include "backends/imgdnn/backend.hpp"
+#include "backends/imgdnn/memory_cache.hpp"
+#include "common/execution_counters.hpp"
+#include "common/memory.hpp"
 #include "tensoropt/execution.hpp"
 
+/**
+ * Number of durations stored by an execution. The NNAPI durations are
+ * followed by the durations specific to TensorOpt.
+ */
+constexpr std::size_t NUM_NNAPI_DURATIONS =
+    ANEURALNETWORKS_DURATION_IN_DRIVER + 1;
+constexpr std::size_t NUM_DURATIONS =
+    NUM_NNAPI_DURATIONS + ANEURALNETWORKS_DURATION_COPY_TO_HOST -
+    ANEURALNETWORKS_DURATION_IN_QUEUE + 1;
+
+/**
+ * Return the index of a DurationCode in ANeuralNetworksExecution::durations
+ * or NUM_DURATIONS if the code is not valid.
+ */
+inline std::size_t getDurationIndex(int32_t duration_code) {
+  if (duration_code >= ANEURALNETWORKS_DURATION_ON_HARDWARE &&
+      duration_code <= ANEURALNETWORKS_DURATION_IN_DRIVER) {
+    return static_cast<std::size_t>(duration_code);
+  }
+  if (duration_code >= ANEURALNETWORKS_DURATION_IN_QUEUE &&
+      duration_code <= ANEURALNETWORKS_DURATION_COPY_TO_HOST) {
+    return NUM_NNAPI_DURATIONS +
+           static_cast<std::size_t>(duration_code -
+                                    ANEURALNETWORKS_DURATION_IN_QUEUE);
+  }
+  return NUM_DURATIONS;
+}
+
 struct ANeuralNetworksExecution {
   struct IdentifiedMemory {
     IdentifiedMemory() = default;
@@ -33,26 +67,79 @@ struct ANeuralNetworksExecution {
     IdentifiedMemory& operator=(const IdentifiedMemory&) = default;
     IdentifiedMemory& operator=(IdentifiedMemory&&) = default;
 
+    /**
+     * Return the buffer to access, the sub-buffer if only a range of memory
+     * is used.
+     */
+    tensoropt_buffer_t& getBuffer() const {
+      return sub_buffer ? *sub_buffer : memory->buffer;
+    }
+
     ANeuralNetworksMemory* memory;  // weak_ptr
     std::size_t offset;
     std::size_t length;
+    // Sub-buffer of parent_buffer, the buffer of memory when the sub-buffer
+    // was created
+    std::shared_ptr<tensoropt_buffer_t> sub_buffer;
+    std::shared_ptr<tensoropt_buffer_t> parent_buffer;
   };
 
   struct HostOutputMemory {
     HostOutputMemory() = default;
-    HostOutputMemory(void* d, imgdnn_memory m) : data(d), img_mem(m) {}
+    HostOutputMemory(void* d, std::size_t l, imgdnn_memory m)
+        : data(d), length(l), img_mem(m) {}
     HostOutputMemory(const HostOutputMemory&) = default;
     HostOutputMemory(HostOutputMemory&&) = default;
     HostOutputMemory& operator=(const HostOutputMemory&) = default;
     HostOutputMemory& operator=(HostOutputMemory&&) = default;
 
     void* data;  // For debug purposes
+    std::size_t length;
     imgdnn_memory img_mem;
   };
 
+  struct HostMemory {
+    HostMemory() = default;
+    HostMemory(uint32_t i, void* d, std::size_t l)
+        : index(i), data(d), length(l) {}
+    HostMemory(const HostMemory&) = default;
+    HostMemory(HostMemory&&) = default;
+    HostMemory& operator=(const HostMemory&) = default;
+    HostMemory& operator=(HostMemory&&) = default;
+
+    uint32_t index;
+    void* data;
+    std::size_t length;
+  };
+
   bool created_from_compilation;
   const ANeuralNetworksDevice* device;  // weak_ptr
 
+  // Host memories set on the execution, indexed by input and output. They are
+  // bound each time a computation starts, to the execution's binding or to a
+  // burst's binding. Memories already bound to that binding are not bound
+  // again.
+  std::map<uint32_t, HostMemory> host_inputs;
+  std::map<uint32_t, HostMemory> host_outputs;
+
+  // Only set if the model has dynamic inputs. The network object is selected
+  // from the compilation's specialisations once the input shapes are known.
+  ANeuralNetworksCompilation* dynamic_compilation;  // weak_ptr
+  std::shared_ptr<ANeuralNetworksCompilation> specialised_compilation;
+  std::vector<std::vector<uint32_t>> input_shapes;
+
+  // Input shapes padded to the compilation's dimension buckets and output
+  // shapes computed from the unpadded inputs. output_shapes is empty if no
+  // input is padded. The padded host data is indexed by input and output so
+  // that its memory is reused across computations, the outputs in
+  // sliced_host_outputs are sliced to the user's memory in
+  // ANeuralNetworksExecution_notifyWait.
+  std::vector<std::vector<uint32_t>> padded_input_shapes;
+  std::vector<std::vector<uint32_t>> output_shapes;
+  std::vector<std::vector<uint8_t>> padded_host_inputs;
+  std::vector<std::vector<uint8_t>> padded_host_outputs;
+  std::vector<HostMemory> sliced_host_outputs;
+
   std::map<uint32_t, IdentifiedMemory> identified_memory_inputs;
   std::map<uint32_t, IdentifiedMemory> identified_memory_outputs;
   std::mutex identified_memory_mutex;
@@ -65,6 +152,13 @@ struct ANeuralNetworksExecution {
   // the host once computed
   std::vector<HostOutputMemory> host_output_memories;
 
+  // Memories imported for the host inputs and outputs, kept until the
+  // execution is freed so that the same buffers are only imported once
+  MemoryCache memory_cache;
+
+  // Counters returned by ANeuralNetworksExecution_getStatistics
+  ExecutionCounters counters;
+
   // Keep alive accessors during the interop_task
   using InputAccT = decltype(std::declval<tensoropt_buffer_t>()
                                  .get_access<cl::sycl::access::mode::read>(
@@ -75,6 +169,17 @@ struct ANeuralNetworksExecution {
   std::vector<std::pair<uint32_t, InputAccT>> input_indexed_accessors;
   std::vector<std::pair<uint32_t, OutputAccT>> output_indexed_accessors;
 
+  // Durations of the last computation indexed by getDurationIndex, measured if
+  // measure_timing is set. The execution on the device is timed inside the
+  // interop_task.
+  using timing_clock_t = std::chrono::steady_clock;
+  bool measure_timing;
+  bool timing_measured;
+  timing_clock_t::time_point submit_time;
+  timing_clock_t::time_point start_time;
+  timing_clock_t::time_point end_time;
+  std::array<uint64_t, NUM_DURATIONS> durations;
+
   // IMGDNN specifics
   imgdnn_network_object imgdnn_network_object_;
   imgdnn_device imgdnn_device_;
@@ -82,7 +187,6 @@ struct ANeuralNetworksExecution {
   imgdnn_binding imgdnn_binding_;
   std::vector<imgdnn_input> imgdnn_inputs_;
   std::vector<imgdnn_output> imgdnn_outputs_;
-  std::vector<imgdnn_memory> imgdnn_memories_;
 };
 
 #endif  // SRC_BACKENDS_IMGDNN_EXECUTION_HPP
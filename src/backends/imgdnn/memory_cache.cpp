@@ -0,0 +1,95 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "backends/imgdnn/memory_cache.hpp"
+
+#include <set>
+
+/**
+ * Number of memories above which the memories that are not bound are
+ * destroyed.
+ */
+static constexpr std::size_t MAX_CACHED_MEMORIES = 64;
+
+/**
+ * Destroy the memories that are not bound to any input or output.
+ */
+static void evictUnboundMemories(MemoryCache& cache,
+                                 ExecutionCounters& counters) {
+  std::set<imgdnn_memory> bound;
+  for (const auto& bound_pair : cache.bound_memories) {
+    bound.insert(bound_pair.second);
+  }
+  auto& imported = cache.imported_memories;
+  for (auto it = imported.begin(); it != imported.end();) {
+    if (bound.count(it->second)) {
+      ++it;
+      continue;
+    }
+    BACKEND_CALL(imgdnnMemoryDestroy, it->second);
+    ++counters.num_memory_destroys;
+    it = imported.erase(it);
+  }
+}
+
+ResultCode getCachedMemory(MemoryCache& cache, imgdnn_context context,
+                           uint32_t index, bool is_input, void* data,
+                           std::size_t length, bool is_opencl,
+                           ExecutionCounters& counters,
+                           imgdnn_memory& img_memory, bool& bound) {
+  imgdnn_err_code ret;
+  auto key = std::make_tuple(static_cast<const void*>(data), length, is_input);
+  auto it = cache.imported_memories.find(key);
+  bool reused = it != cache.imported_memories.end();
+  if (reused) {
+    img_memory = it->second;
+  } else {
+    if (cache.imported_memories.size() >= MAX_CACHED_MEMORIES) {
+      evictUnboundMemories(cache, counters);
+    }
+    BACKEND_CALL_RET(img_memory, imgdnnImportMemory, context, data, length,
+                     is_opencl ? IMGDNN_IMPORT_MEM_TYPE_OPENCL
+                               : IMGDNN_IMPORT_MEM_TYPE_CPU,
+                     &ret);
+    IMGDNN_RETURN_ERR_IF_ERROR(ret);
+    ++counters.num_memory_imports;
+    counters.imported_bytes += length;
+    cache.imported_memories[key] = img_memory;
+  }
+
+  // The host may have modified the input since the previous computation
+  if (reused && is_input && !is_opencl) {
+    void* host_ptr;
+    BACKEND_CALL_RET(host_ptr, imgdnnMemoryLock, img_memory,
+                     IMGDNN_LOCK_ACCESS_WRITE_ONLY, &ret);
+    IMGDNN_RETURN_ERR_IF_ERROR(ret);
+    TENSOROPT_UNUSED_VARIABLE(host_ptr);
+    BACKEND_CALL_RET(ret, imgdnnMemoryUnlock, img_memory);
+    IMGDNN_RETURN_ERR_IF_ERROR(ret);
+  }
+
+  auto& bound_memory = cache.bound_memories[std::make_pair(index, is_input)];
+  bound = bound_memory == img_memory;
+  bound_memory = img_memory;
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+void clearMemoryCache(MemoryCache& cache) {
+  for (const auto& memory_pair : cache.imported_memories) {
+    BACKEND_CALL(imgdnnMemoryDestroy, memory_pair.second);
+  }
+  cache.imported_memories.clear();
+  cache.bound_memories.clear();
+}
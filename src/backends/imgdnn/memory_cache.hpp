@@ -0,0 +1,64 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef SRC_BACKENDS_IMGDNN_MEMORY_CACHE_HPP
+#define SRC_BACKENDS_IMGDNN_MEMORY_CACHE_HPP
+
+#include <cstddef>
+#include <map>
+#include <tuple>
+#include <utility>
+
+#include "backends/imgdnn/backend.hpp"
+#include "common/execution_counters.hpp"
+
+/**
+ * Memories imported to IMGDNN kept alive across computations so that binding
+ * the same buffers again does not import them again.
+ */
+struct MemoryCache {
+  // Identify a memory by its host pointer or OpenCL buffer, its length and
+  // whether it is used as an input
+  using memory_key_t = std::tuple<const void*, std::size_t, bool>;
+  // Identify an input or output by its index and whether it is an input
+  using binding_key_t = std::pair<uint32_t, bool>;
+
+  std::map<memory_key_t, imgdnn_memory> imported_memories;
+  // Memory currently bound to each input and output
+  std::map<binding_key_t, imgdnn_memory> bound_memories;
+};
+
+/**
+ * Get the memory for the given data, importing it in context if it is not in
+ * the cache. data is a host pointer or an OpenCL buffer if is_opencl is true.
+ * Reused host inputs are locked and unlocked so that IMGDNN sees their new
+ * contents.
+ * bound is set to true if the memory is already bound to the input or output
+ * in which case it does not need to be added to the binding again.
+ * Memories which are not bound are destroyed once the cache is too large.
+ * The imports and destroys are added to counters.
+ */
+ResultCode getCachedMemory(MemoryCache& cache, imgdnn_context context,
+                           uint32_t index, bool is_input, void* data,
+                           std::size_t length, bool is_opencl,
+                           ExecutionCounters& counters,
+                           imgdnn_memory& img_memory, bool& bound);
+
+/**
+ * Destroy all the memories of the cache.
+ */
+void clearMemoryCache(MemoryCache& cache);
+
+#endif  // SRC_BACKENDS_IMGDNN_MEMORY_CACHE_HPP
@@ -15,11 +15,13 @@
  */
 #include "common/model.hpp"
 #include "common/macro.hpp"
+#include "common/trace.hpp"
 
 ResultCode ANeuralNetworksModel_getSupportedOperationsForDevices(
     const ANeuralNetworksModel* model,
     const ANeuralNetworksDevice* const* devices, uint32_t num_devices,
     bool* supported_ops) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_UNUSED_VARIABLE(model);
   TENSOROPT_UNUSED_VARIABLE(devices);
   TENSOROPT_UNUSED_VARIABLE(num_devices);
@@ -34,6 +36,7 @@ bool ANeuralNetworksModel_canAddOperation(
     const ANeuralNetworksModel* model,
     const ANeuralNetworksDevice* const* devices, uint32_t num_devices,
     ANeuralNetworksOperationType op) {
+  TENSOROPT_TRACE_API();
   static bool supported_ops[ANEURALNETWORKS_OPERATION_COUNT];
   static bool initialized = false;
   if (!initialized) {
@@ -0,0 +1,120 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "backends/imgdnn/network_object_registry.hpp"
+
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace {
+
+struct RegistryKey {
+  std::array<uint8_t, BYTE_SIZE_OF_MODEL_HASH> model_hash;
+  cl_context cl_context_;
+  cl_device_id cl_device_;
+  imgdnn_network_object_flags flags;
+  std::string options;
+
+  bool operator<(const RegistryKey& other) const {
+    return std::tie(model_hash, cl_context_, cl_device_, flags, options) <
+           std::tie(other.model_hash, other.cl_context_, other.cl_device_,
+                    other.flags, other.options);
+  }
+};
+
+struct RegistryEntry {
+  imgdnn_device imgdnn_device_;
+  imgdnn_context imgdnn_context_;
+  imgdnn_network_object imgdnn_network_object_;
+  unsigned ref_count;
+};
+
+struct Registry {
+  std::mutex mutex;
+  std::map<RegistryKey, RegistryEntry> entries;
+};
+
+Registry& getRegistry() {
+  // Never destroyed so that compilations can be freed during static
+  // destruction
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+RegistryKey makeKey(const ANeuralNetworksCompilation* compilation) {
+  return {compilation->model->hash, compilation->cl_context_,
+          compilation->cl_device_, compilation->imgdnn_flags_,
+          compilation->imgdnn_options_};
+}
+
+}  // end namespace
+
+bool acquireSharedNetworkObject(ANeuralNetworksCompilation* compilation) {
+  auto& registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto it = registry.entries.find(makeKey(compilation));
+  if (it == registry.entries.end()) {
+    return false;
+  }
+  auto& entry = it->second;
+  ++entry.ref_count;
+  // The compilation's own context is not needed anymore, the network object
+  // can only be used with the context it was created with.
+  BACKEND_CALL(imgdnnContextDestroy, compilation->imgdnn_context_);
+  compilation->imgdnn_device_ = entry.imgdnn_device_;
+  compilation->imgdnn_context_ = entry.imgdnn_context_;
+  compilation->imgdnn_network_object_ = entry.imgdnn_network_object_;
+  return true;
+}
+
+void registerNetworkObject(ANeuralNetworksCompilation* compilation) {
+  auto& registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto p = registry.entries.emplace(
+      makeKey(compilation),
+      RegistryEntry{compilation->imgdnn_device_, compilation->imgdnn_context_,
+                    compilation->imgdnn_network_object_, 1});
+  if (!p.second) {
+    // An identical compilation was finished concurrently, its network object
+    // is used instead.
+    auto& entry = p.first->second;
+    ++entry.ref_count;
+    BACKEND_CALL(imgdnnNetworkObjectDestroy,
+                 compilation->imgdnn_network_object_);
+    BACKEND_CALL(imgdnnContextDestroy, compilation->imgdnn_context_);
+    compilation->imgdnn_device_ = entry.imgdnn_device_;
+    compilation->imgdnn_context_ = entry.imgdnn_context_;
+    compilation->imgdnn_network_object_ = entry.imgdnn_network_object_;
+  }
+}
+
+void releaseNetworkObject(ANeuralNetworksCompilation* compilation) {
+  auto& registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto it = registry.entries.find(makeKey(compilation));
+  if (it == registry.entries.end()) {
+    VLOG_AT("Error: network object " << compilation->imgdnn_network_object_
+                                     << " is not registered");
+    return;
+  }
+  auto& entry = it->second;
+  if (--entry.ref_count > 0) {
+    return;
+  }
+  BACKEND_CALL(imgdnnNetworkObjectDestroy, entry.imgdnn_network_object_);
+  BACKEND_CALL(imgdnnContextDestroy, entry.imgdnn_context_);
+  registry.entries.erase(it);
+}
@@ -0,0 +1,49 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef SRC_BACKENDS_IMGDNN_NETWORK_OBJECT_REGISTRY_HPP
+#define SRC_BACKENDS_IMGDNN_NETWORK_OBJECT_REGISTRY_HPP
+
+#include "backends/imgdnn/compilation.hpp"
+
+/**
+ * The registry shares network objects between compilations of identical models
+ * on the same OpenCL context and device with the same options.
+ * A registered network object owns the IMGDNN context it was created with and
+ * is destroyed once the last compilation using it is released.
+ */
+
+/**
+ * Look for a network object matching the compilation.
+ * If one is found its context and network object replace the ones of the
+ * compilation and true is returned.
+ */
+bool acquireSharedNetworkObject(ANeuralNetworksCompilation* compilation);
+
+/**
+ * Register the network object of a finished compilation so that it can be
+ * shared. The registry takes ownership of the compilation's context and
+ * network object.
+ */
+void registerNetworkObject(ANeuralNetworksCompilation* compilation);
+
+/**
+ * Release the network object of a finished compilation.
+ * The network object and its context are destroyed if no other compilation
+ * uses them.
+ */
+void releaseNetworkObject(ANeuralNetworksCompilation* compilation);
+
+#endif  // SRC_BACKENDS_IMGDNN_NETWORK_OBJECT_REGISTRY_HPP
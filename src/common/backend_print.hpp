@@ -20,6 +20,7 @@
 #include <string>
 
 #include "common/macro.hpp"
+#include "common/trace.hpp"
 #include "common/utils.hpp"
 
 // Need to disambiguate nullptr
@@ -97,6 +98,7 @@ inline void backendPrintFunc(const std::string& func_name, FuncPtr,
   {                                             \
     backendPrintFunc(#FUNC, FUNC, __VA_ARGS__); \
     VLOG(std::endl);                            \
+    TENSOROPT_TRACE_SCOPE(#FUNC, "backend");    \
     FUNC(__VA_ARGS__);                          \
   }
 
@@ -104,19 +106,28 @@ inline void backendPrintFunc(const std::string& func_name, FuncPtr,
 #define BACKEND_CALL_RET(RET, FUNC, ...)        \
   {                                             \
     backendPrintFunc(#FUNC, FUNC, __VA_ARGS__); \
-    (RET) = FUNC(__VA_ARGS__);                  \
+    {                                           \
+      TENSOROPT_TRACE_SCOPE(#FUNC, "backend");  \
+      (RET) = FUNC(__VA_ARGS__);                \
+    }                                           \
     VLOG(" -> ");                               \
     backendPrintArg(RET);                       \
     VLOG(std::endl);                            \
   }
 #else  // VERBOSE_LOG
 // Execute FUNC(...)
-#define BACKEND_CALL(FUNC, ...) \
-  { FUNC(__VA_ARGS__); }
+#define BACKEND_CALL(FUNC, ...)              \
+  {                                          \
+    TENSOROPT_TRACE_SCOPE(#FUNC, "backend"); \
+    FUNC(__VA_ARGS__);                       \
+  }
 
 // Execute FUNC(...) and return its value
-#define BACKEND_CALL_RET(RET, FUNC, ...) \
-  { (RET) = FUNC(__VA_ARGS__); }
+#define BACKEND_CALL_RET(RET, FUNC, ...)     \
+  {                                          \
+    TENSOROPT_TRACE_SCOPE(#FUNC, "backend"); \
+    (RET) = FUNC(__VA_ARGS__);               \
+  }
 #endif
 
 #endif  // SRC_COMMON_BACKEND_PRINT_HPP
@@ -15,8 +15,10 @@
  */
 #include "common/device.hpp"
 #include "common/macro.hpp"
+#include "common/trace.hpp"
 
 ResultCode ANeuralNetworks_getDevice(uint32_t, ANeuralNetworksDevice** device) {
+  TENSOROPT_TRACE_API();
   auto owned_queue = std::make_shared<cl::sycl::queue>();
   TENSOROPT_RETURN_IF_ERROR(
       ANeuralNetworksDevice_create(owned_queue.get(), true, device));
@@ -26,11 +28,17 @@ ResultCode ANeuralNetworks_getDevice(uint32_t, ANeuralNetworksDevice** device) {
 
 ResultCode ANeuralNetworksDevice_create(cl::sycl::queue* queue, bool get_info,
                                         ANeuralNetworksDevice** device) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_RETURN_IF_NULL(queue);
   TENSOROPT_RETURN_IF_NULL(device);
   auto& deref_device = *device;
   deref_device = new ANeuralNetworksDevice();
   deref_device->queue = queue;
+  // The alignment is given in bits
+  deref_device->mem_base_addr_align =
+      queue->get_device()
+          .get_info<cl::sycl::info::device::mem_base_addr_align>() /
+      8;
   if (get_info) {
     namespace info = cl::sycl::info;
     deref_device->name =
@@ -58,12 +66,14 @@ ResultCode ANeuralNetworksDevice_create(cl::sycl::queue* queue, bool get_info,
 }
 
 ResultCode ANeuralNetworks_getDeviceCount(uint32_t* num_devices) {
+  TENSOROPT_TRACE_API();
   *num_devices = 1;
   return ANEURALNETWORKS_NO_ERROR;
 }
 
 ResultCode ANeuralNetworksDevice_getFeatureLevel(
     const ANeuralNetworksDevice* device, int64_t* feature_level) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_UNUSED_VARIABLE(device);
   TENSOROPT_RETURN_IF_NULL(feature_level);
   *feature_level = 29;
@@ -72,6 +82,7 @@ ResultCode ANeuralNetworksDevice_getFeatureLevel(
 
 ResultCode ANeuralNetworksDevice_getName(const ANeuralNetworksDevice* device,
                                          const char** name) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_RETURN_IF_NULL(name);
   *name = device->name.c_str();
   return ANEURALNETWORKS_NO_ERROR;
@@ -79,6 +90,7 @@ ResultCode ANeuralNetworksDevice_getName(const ANeuralNetworksDevice* device,
 
 ResultCode ANeuralNetworksDevice_getType(const ANeuralNetworksDevice* device,
                                          DeviceTypeCode* type) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_RETURN_IF_NULL(type);
   *type = device->type;
   return ANEURALNETWORKS_NO_ERROR;
@@ -86,12 +98,14 @@ ResultCode ANeuralNetworksDevice_getType(const ANeuralNetworksDevice* device,
 
 ResultCode ANeuralNetworksDevice_getVersion(const ANeuralNetworksDevice* device,
                                             const char** version) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_RETURN_IF_NULL(version);
   *version = device->version.c_str();
   return ANEURALNETWORKS_NO_ERROR;
 }
 
 void ANeuralNetworksDevice_free(ANeuralNetworksDevice* device) {
+  TENSOROPT_TRACE_API();
   if (device) {
     delete device;
   }
@@ -26,6 +26,8 @@ struct ANeuralNetworksDevice {
   std::string name;
   std::string version;
   DeviceTypeCode type;
+  // Alignment in bytes required for the offset of sub-buffers
+  std::size_t mem_base_addr_align;
 };
 
 #endif  // SRC_COMMON_DEVICE_HPP
@@ -16,15 +16,18 @@
 #include "common/event.hpp"
 #include "common/execution.hpp"
 #include "common/macro.hpp"
+#include "common/trace.hpp"
 
 ResultCode ANeuralNetworksEvent_getSyclEvent(ANeuralNetworksEvent* event,
                                              cl::sycl::event* sycl_event) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_RETURN_IF_NULL(event);
   *sycl_event = event->sycl_event;
   return ANEURALNETWORKS_NO_ERROR;
 }
 
 ResultCode ANeuralNetworksEvent_wait(ANeuralNetworksEvent* event) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_RETURN_IF_NULL(event);
   try {
     event->sycl_event.wait_and_throw();
@@ -39,6 +42,7 @@ ResultCode ANeuralNetworksEvent_wait(ANeuralNetworksEvent* event) {
 }
 
 void ANeuralNetworksEvent_free(ANeuralNetworksEvent* event) {
+  TENSOROPT_TRACE_API();
   if (event) {
     delete event;
   }
@@ -0,0 +1,36 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef SRC_COMMON_EXECUTION_COUNTERS_HPP
+#define SRC_COMMON_EXECUTION_COUNTERS_HPP
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Cumulative counters of an execution, see
+ * ANeuralNetworksExecution_getStatistics.
+ * The counters are atomic as some are updated by the interop tasks.
+ */
+struct ExecutionCounters {
+  std::atomic<uint64_t> num_computations{0};
+  std::atomic<uint64_t> num_memory_imports{0};
+  std::atomic<uint64_t> num_memory_destroys{0};
+  std::atomic<uint64_t> imported_bytes{0};
+  std::atomic<uint64_t> host_output_bytes{0};
+  std::atomic<uint64_t> lock_wait_duration{0};
+};
+
+#endif  // SRC_COMMON_EXECUTION_COUNTERS_HPP
@@ -0,0 +1,542 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/host_kernels.hpp"
+#include "common/macro.hpp"
+#include "common/utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+namespace {
+
+/**
+ * Dimensions of an operand, scalars are considered to be of shape [1].
+ */
+std::vector<std::size_t> getDims(const ANeuralNetworksOperandType& op) {
+  if (op.dimensionCount == 0) {
+    return {1};
+  }
+  return std::vector<std::size_t>(op.dimensions,
+                                  op.dimensions + op.dimensionCount);
+}
+
+/**
+ * Number of elements between two consecutive indices of each dimension.
+ */
+std::vector<std::size_t> getStrides(const std::vector<std::size_t>& dims) {
+  std::vector<std::size_t> strides(dims.size(), 1);
+  for (std::size_t i = dims.size() - 1; i > 0; --i) {
+    strides[i - 1] = strides[i] * dims[i];
+  }
+  return strides;
+}
+
+/**
+ * Call f with the linear index of each element of out_dims and the index in
+ * the input computed with in_strides for each dimension of the output.
+ */
+template <class F>
+void forEachElement(const std::vector<std::size_t>& out_dims,
+                    const std::vector<std::size_t>& in_strides,
+                    std::size_t in_offset, F f) {
+  std::vector<std::size_t> index(out_dims.size(), 0);
+  std::size_t nb_elements = 1;
+  for (auto dim : out_dims) {
+    nb_elements *= dim;
+  }
+  std::size_t in_idx = in_offset;
+  for (std::size_t out_idx = 0; out_idx < nb_elements; ++out_idx) {
+    f(out_idx, in_idx);
+    // Increment the index starting from the innermost dimension
+    for (std::size_t d = out_dims.size(); d-- > 0;) {
+      ++index[d];
+      in_idx += in_strides[d];
+      if (index[d] < out_dims[d]) {
+        break;
+      }
+      in_idx -= index[d] * in_strides[d];
+      index[d] = 0;
+    }
+  }
+}
+
+/**
+ * Same as forEachElement for two inputs.
+ */
+template <class F>
+void forEachElementPair(const std::vector<std::size_t>& out_dims,
+                        const std::vector<std::size_t>& in0_strides,
+                        const std::vector<std::size_t>& in1_strides, F f) {
+  std::vector<std::size_t> index(out_dims.size(), 0);
+  std::size_t nb_elements = 1;
+  for (auto dim : out_dims) {
+    nb_elements *= dim;
+  }
+  std::size_t in0_idx = 0;
+  std::size_t in1_idx = 0;
+  for (std::size_t out_idx = 0; out_idx < nb_elements; ++out_idx) {
+    f(out_idx, in0_idx, in1_idx);
+    for (std::size_t d = out_dims.size(); d-- > 0;) {
+      ++index[d];
+      in0_idx += in0_strides[d];
+      in1_idx += in1_strides[d];
+      if (index[d] < out_dims[d]) {
+        break;
+      }
+      in0_idx -= index[d] * in0_strides[d];
+      in1_idx -= index[d] * in1_strides[d];
+      index[d] = 0;
+    }
+  }
+}
+
+ResultCode checkOutputSize(const ANeuralNetworksOperandType& out_op,
+                           std::size_t nb_elements) {
+  TENSOROPT_RETURN_IF_COND(getOperandTypeSize(out_op) != nb_elements,
+                           "Error: expected output of "
+                               << getOperandTypeSize(out_op)
+                               << " elements but computed " << nb_elements,
+                           ANEURALNETWORKS_OP_FAILED);
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+enum class ElementKind { FLOAT, INT, UINT, BOOL, UNKNOWN };
+
+ElementKind getElementKind(ANeuralNetworksOperandCode code) {
+  switch (code) {
+    case ANEURALNETWORKS_FLOAT32:
+    case ANEURALNETWORKS_TENSOR_FLOAT32:
+      return ElementKind::FLOAT;
+    case ANEURALNETWORKS_INT32:
+    case ANEURALNETWORKS_TENSOR_INT32:
+      return ElementKind::INT;
+    case ANEURALNETWORKS_UINT32:
+      return ElementKind::UINT;
+    case ANEURALNETWORKS_BOOL:
+    case ANEURALNETWORKS_TENSOR_BOOL8:
+      return ElementKind::BOOL;
+    default:
+      return ElementKind::UNKNOWN;
+  }
+}
+
+template <class T>
+T applyFuseCode(T value, int32_t fuse_code) {
+  switch (fuse_code) {
+    case ANEURALNETWORKS_FUSED_RELU:
+      return std::max(value, T(0));
+    case ANEURALNETWORKS_FUSED_RELU1:
+      return std::min(std::max(value, T(-1)), T(1));
+    case ANEURALNETWORKS_FUSED_RELU6:
+      return std::min(std::max(value, T(0)), T(6));
+    default:
+      return value;
+  }
+}
+
+template <class T>
+ResultCode applyBinary(ANeuralNetworksOperationType op_type, T lhs, T rhs,
+                       T& res) {
+  switch (op_type) {
+    case ANEURALNETWORKS_ADD:
+      res = lhs + rhs;
+      break;
+    case ANEURALNETWORKS_SUB:
+      res = lhs - rhs;
+      break;
+    case ANEURALNETWORKS_MUL:
+      res = lhs * rhs;
+      break;
+    case ANEURALNETWORKS_DIV:
+      // Integer division by zero is left to the device
+      TENSOROPT_RETURN_IF_COND(std::is_integral<T>::value && rhs == T(0),
+                               "Error: integer division by zero",
+                               ANEURALNETWORKS_OP_FAILED);
+      res = lhs / rhs;
+      break;
+    case ANEURALNETWORKS_MAX:
+      res = std::max(lhs, rhs);
+      break;
+    case ANEURALNETWORKS_MIN:
+      res = std::min(lhs, rhs);
+      break;
+    default:
+      VLOG_AT("Error: unsupported binary operation " << op_type);
+      return ANEURALNETWORKS_OP_FAILED;
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+/**
+ * Strides to read an input broadcast to the output dimensions.
+ * Dimensions are aligned on the innermost one and broadcast dimensions have a
+ * stride of 0.
+ */
+ResultCode getBroadcastStrides(const std::vector<std::size_t>& in_dims,
+                               const std::vector<std::size_t>& out_dims,
+                               std::vector<std::size_t>& strides) {
+  TENSOROPT_RETURN_IF_COND(in_dims.size() > out_dims.size(),
+                           "Error: cannot broadcast input of rank "
+                               << in_dims.size() << " to rank "
+                               << out_dims.size(),
+                           ANEURALNETWORKS_OP_FAILED);
+  auto in_strides = getStrides(in_dims);
+  auto rank_diff = out_dims.size() - in_dims.size();
+  strides.assign(out_dims.size(), 0);
+  for (std::size_t i = 0; i < in_dims.size(); ++i) {
+    auto out_dim = out_dims[rank_diff + i];
+    if (in_dims[i] == out_dim) {
+      strides[rank_diff + i] = in_strides[i];
+    } else {
+      TENSOROPT_RETURN_IF_COND(in_dims[i] != 1,
+                               "Error: cannot broadcast dimension "
+                                   << in_dims[i] << " to " << out_dim,
+                               ANEURALNETWORKS_OP_FAILED);
+    }
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+template <class T>
+ResultCode hostBinaryTyped(ANeuralNetworksOperationType op_type,
+                           const ANeuralNetworksOperandType& in0_op,
+                           const void* in0,
+                           const ANeuralNetworksOperandType& in1_op,
+                           const void* in1, int32_t fuse_code,
+                           const ANeuralNetworksOperandType& out_op,
+                           host_data_t& out) {
+  // Scalars and tensors of size 1 can be broadcast to any rank
+  auto out_dims = getDims(out_op);
+  auto in0_dims = getDims(in0_op);
+  auto in1_dims = getDims(in1_op);
+  std::vector<std::size_t> in0_strides;
+  std::vector<std::size_t> in1_strides;
+  TENSOROPT_RETURN_IF_ERROR(
+      getBroadcastStrides(in0_dims, out_dims, in0_strides));
+  TENSOROPT_RETURN_IF_ERROR(
+      getBroadcastStrides(in1_dims, out_dims, in1_strides));
+
+  out.resize(getOperandTypeSizeBytes(out_op));
+  auto typed_in0 = static_cast<const T*>(in0);
+  auto typed_in1 = static_cast<const T*>(in1);
+  auto typed_out = reinterpret_cast<T*>(out.data());
+  ResultCode res = ANEURALNETWORKS_NO_ERROR;
+  forEachElementPair(
+      out_dims, in0_strides, in1_strides,
+      [&](std::size_t out_idx, std::size_t in0_idx, std::size_t in1_idx) {
+        if (res != ANEURALNETWORKS_NO_ERROR) {
+          return;
+        }
+        T value;
+        res = applyBinary(op_type, typed_in0[in0_idx], typed_in1[in1_idx],
+                          value);
+        typed_out[out_idx] = applyFuseCode(value, fuse_code);
+      });
+  return res;
+}
+
+template <class T>
+double readAsDouble(const void* data, std::size_t idx) {
+  T value;
+  std::memcpy(&value, static_cast<const uint8_t*>(data) + idx * sizeof(T),
+              sizeof(T));
+  return static_cast<double>(value);
+}
+
+template <class T>
+void writeFromDouble(double value, void* data, std::size_t idx) {
+  T typed_value = static_cast<T>(value);
+  std::memcpy(static_cast<uint8_t*>(data) + idx * sizeof(T), &typed_value,
+              sizeof(T));
+}
+
+}  // end namespace
+
+ResultCode hostCopy(const ANeuralNetworksOperandType& in_op, const void* in,
+                    const ANeuralNetworksOperandType& out_op,
+                    host_data_t& out) {
+  TENSOROPT_RETURN_IF_COND(in_op.type != out_op.type ||
+                               getOperandTypeSizeBytes(in_op) !=
+                                   getOperandTypeSizeBytes(out_op),
+                           "Error: cannot reshape operand of size "
+                               << getOperandTypeSizeBytes(in_op) << "B to "
+                               << getOperandTypeSizeBytes(out_op) << "B",
+                           ANEURALNETWORKS_OP_FAILED);
+  auto typed_in = static_cast<const uint8_t*>(in);
+  out.assign(typed_in, typed_in + getOperandTypeSizeBytes(in_op));
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode hostTranspose(const ANeuralNetworksOperandType& in_op,
+                         const void* in, const std::vector<int32_t>& perms,
+                         const ANeuralNetworksOperandType& out_op,
+                         host_data_t& out) {
+  auto in_dims = getDims(in_op);
+  TENSOROPT_RETURN_IF_COND(perms.size() != in_dims.size(),
+                           "Error: expected " << in_dims.size()
+                                              << " permutations but got "
+                                              << perms.size(),
+                           ANEURALNETWORKS_OP_FAILED);
+  auto in_strides = getStrides(in_dims);
+  std::vector<std::size_t> out_dims(perms.size());
+  std::vector<std::size_t> perm_strides(perms.size());
+  for (std::size_t i = 0; i < perms.size(); ++i) {
+    auto perm = static_cast<std::size_t>(perms[i]);
+    TENSOROPT_RETURN_IF_COND(perm >= in_dims.size(),
+                             "Error: invalid permutation " << perms[i],
+                             ANEURALNETWORKS_OP_FAILED);
+    out_dims[i] = in_dims[perm];
+    perm_strides[i] = in_strides[perm];
+  }
+  TENSOROPT_RETURN_IF_ERROR(
+      checkOutputSize(out_op, getOperandTypeSize(in_op)));
+
+  auto elt_size = getOperandCodeSizeBytes(in_op.type);
+  out.resize(getOperandTypeSizeBytes(out_op));
+  auto typed_in = static_cast<const uint8_t*>(in);
+  forEachElement(out_dims, perm_strides, 0,
+                 [&](std::size_t out_idx, std::size_t in_idx) {
+                   std::memcpy(out.data() + out_idx * elt_size,
+                               typed_in + in_idx * elt_size, elt_size);
+                 });
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode hostSubTensor(const ANeuralNetworksOperandType& in_op,
+                         const void* in, const SliceBounds& bounds,
+                         const ANeuralNetworksOperandType& out_op,
+                         host_data_t& out) {
+  auto in_dims = getDims(in_op);
+  TENSOROPT_RETURN_IF_COND(bounds.starts.size() != in_dims.size(),
+                           "Error: expected bounds of rank " << in_dims.size(),
+                           ANEURALNETWORKS_OP_FAILED);
+  auto in_strides = getStrides(in_dims);
+  std::vector<std::size_t> out_dims(in_dims.size());
+  std::vector<std::size_t> slice_strides(in_dims.size());
+  std::size_t in_offset = 0;
+  std::size_t nb_elements = 1;
+  for (std::size_t i = 0; i < in_dims.size(); ++i) {
+    TENSOROPT_RETURN_IF_COND(bounds.starts[i] > bounds.ends[i] ||
+                                 bounds.ends[i] >= in_dims[i],
+                             "Error: invalid bounds [" << bounds.starts[i]
+                                                       << ", " << bounds.ends[i]
+                                                       << "] for dimension "
+                                                       << in_dims[i],
+                             ANEURALNETWORKS_OP_FAILED);
+    out_dims[i] = (bounds.ends[i] - bounds.starts[i]) / bounds.strides[i] + 1;
+    slice_strides[i] = in_strides[i] * bounds.strides[i];
+    in_offset += bounds.starts[i] * in_strides[i];
+    nb_elements *= out_dims[i];
+  }
+  TENSOROPT_RETURN_IF_ERROR(checkOutputSize(out_op, nb_elements));
+
+  auto elt_size = getOperandCodeSizeBytes(in_op.type);
+  out.resize(getOperandTypeSizeBytes(out_op));
+  auto typed_in = static_cast<const uint8_t*>(in);
+  forEachElement(out_dims, slice_strides, in_offset,
+                 [&](std::size_t out_idx, std::size_t in_idx) {
+                   std::memcpy(out.data() + out_idx * elt_size,
+                               typed_in + in_idx * elt_size, elt_size);
+                 });
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode hostPad(const ANeuralNetworksOperandType& in_op, const void* in,
+                   const ANeuralNetworksOperandType& out_op, host_data_t& out) {
+  auto in_dims = getDims(in_op);
+  auto out_dims = getDims(out_op);
+  TENSOROPT_RETURN_IF_COND(in_dims.size() != out_dims.size(),
+                           "Error: expected output of rank " << in_dims.size(),
+                           ANEURALNETWORKS_OP_FAILED);
+  for (std::size_t i = 0; i < in_dims.size(); ++i) {
+    TENSOROPT_RETURN_IF_COND(in_dims[i] > out_dims[i],
+                             "Error: cannot pad dimension "
+                                 << in_dims[i] << " to " << out_dims[i],
+                             ANEURALNETWORKS_OP_FAILED);
+  }
+
+  auto elt_size = getOperandCodeSizeBytes(in_op.type);
+  out.assign(getOperandTypeSizeBytes(out_op), 0);
+  auto typed_in = static_cast<const uint8_t*>(in);
+  // Iterate over the input so that the padded elements are not visited
+  forEachElement(in_dims, getStrides(out_dims), 0,
+                 [&](std::size_t in_idx, std::size_t out_idx) {
+                   std::memcpy(out.data() + out_idx * elt_size,
+                               typed_in + in_idx * elt_size, elt_size);
+                 });
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode hostConcat(const std::vector<ANeuralNetworksOperandType>& in_ops,
+                      const std::vector<const void*>& ins, uint32_t axis,
+                      const ANeuralNetworksOperandType& out_op,
+                      host_data_t& out) {
+  auto out_dims = getDims(out_op);
+  TENSOROPT_RETURN_IF_COND(axis >= out_dims.size(),
+                           "Error: invalid concatenation axis " << axis,
+                           ANEURALNETWORKS_OP_FAILED);
+  auto elt_size = getOperandCodeSizeBytes(out_op.type);
+  std::size_t nb_outer = 1;
+  for (uint32_t i = 0; i < axis; ++i) {
+    nb_outer *= out_dims[i];
+  }
+  TENSOROPT_RETURN_IF_COND(nb_outer == 0, "Error: unexpected empty output",
+                           ANEURALNETWORKS_OP_FAILED);
+  // Size in bytes of each input copied for one outer index
+  std::vector<std::size_t> chunk_sizes(in_ops.size());
+  std::size_t nb_elements = 0;
+  for (std::size_t i = 0; i < in_ops.size(); ++i) {
+    TENSOROPT_RETURN_IF_COND(in_ops[i].type != out_op.type ||
+                                 in_ops[i].dimensionCount != out_dims.size(),
+                             "Error: unexpected type for concatenated operand #"
+                                 << i,
+                             ANEURALNETWORKS_OP_FAILED);
+    nb_elements += getOperandTypeSize(in_ops[i]);
+    chunk_sizes[i] = getOperandTypeSize(in_ops[i]) / nb_outer * elt_size;
+  }
+  TENSOROPT_RETURN_IF_ERROR(checkOutputSize(out_op, nb_elements));
+
+  out.resize(getOperandTypeSizeBytes(out_op));
+  auto out_ptr = out.data();
+  for (std::size_t outer = 0; outer < nb_outer; ++outer) {
+    for (std::size_t i = 0; i < ins.size(); ++i) {
+      std::memcpy(out_ptr,
+                  static_cast<const uint8_t*>(ins[i]) + outer * chunk_sizes[i],
+                  chunk_sizes[i]);
+      out_ptr += chunk_sizes[i];
+    }
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode hostCast(const ANeuralNetworksOperandType& in_op, const void* in,
+                    const ANeuralNetworksOperandType& out_op,
+                    host_data_t& out) {
+  auto in_kind = getElementKind(in_op.type);
+  auto out_kind = getElementKind(out_op.type);
+  TENSOROPT_RETURN_IF_COND(
+      in_kind == ElementKind::UNKNOWN || out_kind == ElementKind::UNKNOWN ||
+          out_op.scale != 0.f,
+      "Error: unsupported cast from " << in_op.type << " to " << out_op.type,
+      ANEURALNETWORKS_OP_FAILED);
+  auto nb_elements = getOperandTypeSize(in_op);
+  TENSOROPT_RETURN_IF_ERROR(checkOutputSize(out_op, nb_elements));
+
+  out.resize(getOperandTypeSizeBytes(out_op));
+  for (std::size_t i = 0; i < nb_elements; ++i) {
+    double value = 0;
+    switch (in_kind) {
+      case ElementKind::FLOAT:
+        value = readAsDouble<float>(in, i);
+        break;
+      case ElementKind::INT:
+        value = readAsDouble<int32_t>(in, i);
+        break;
+      case ElementKind::UINT:
+        value = readAsDouble<uint32_t>(in, i);
+        break;
+      default:
+        value = readAsDouble<uint8_t>(in, i);
+        break;
+    }
+    switch (out_kind) {
+      case ElementKind::FLOAT:
+        writeFromDouble<float>(value, out.data(), i);
+        break;
+      case ElementKind::INT:
+        writeFromDouble<int32_t>(value, out.data(), i);
+        break;
+      case ElementKind::UINT:
+        writeFromDouble<uint32_t>(value, out.data(), i);
+        break;
+      default:
+        writeFromDouble<uint8_t>(value != 0 ? 1 : 0, out.data(), i);
+        break;
+    }
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode hostUnary(ANeuralNetworksOperationType op_type,
+                     const ANeuralNetworksOperandType& in_op, const void* in,
+                     const ANeuralNetworksOperandType& out_op,
+                     host_data_t& out) {
+  TENSOROPT_RETURN_IF_COND(
+      getElementKind(in_op.type) != ElementKind::FLOAT ||
+          getElementKind(out_op.type) != ElementKind::FLOAT,
+      "Error: unsupported unary operation on type " << in_op.type,
+      ANEURALNETWORKS_OP_FAILED);
+  auto nb_elements = getOperandTypeSize(in_op);
+  TENSOROPT_RETURN_IF_ERROR(checkOutputSize(out_op, nb_elements));
+
+  out.resize(getOperandTypeSizeBytes(out_op));
+  auto typed_in = static_cast<const float*>(in);
+  auto typed_out = reinterpret_cast<float*>(out.data());
+  for (std::size_t i = 0; i < nb_elements; ++i) {
+    float x = typed_in[i];
+    switch (op_type) {
+      case ANEURALNETWORKS_EXP:
+        typed_out[i] = std::exp(x);
+        break;
+      case ANEURALNETWORKS_RELU:
+        typed_out[i] = applyFuseCode(x, ANEURALNETWORKS_FUSED_RELU);
+        break;
+      case ANEURALNETWORKS_RELU1:
+        typed_out[i] = applyFuseCode(x, ANEURALNETWORKS_FUSED_RELU1);
+        break;
+      case ANEURALNETWORKS_RELU6:
+        typed_out[i] = applyFuseCode(x, ANEURALNETWORKS_FUSED_RELU6);
+        break;
+      case ANEURALNETWORKS_RSQRT:
+        typed_out[i] = 1.f / std::sqrt(x);
+        break;
+      case ANEURALNETWORKS_SQRT:
+        typed_out[i] = std::sqrt(x);
+        break;
+      default:
+        VLOG_AT("Error: unsupported unary operation " << op_type);
+        return ANEURALNETWORKS_OP_FAILED;
+    }
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode hostBinary(ANeuralNetworksOperationType op_type,
+                      const ANeuralNetworksOperandType& in0_op,
+                      const void* in0,
+                      const ANeuralNetworksOperandType& in1_op,
+                      const void* in1, int32_t fuse_code,
+                      const ANeuralNetworksOperandType& out_op,
+                      host_data_t& out) {
+  auto kind = getElementKind(out_op.type);
+  TENSOROPT_RETURN_IF_COND(getElementKind(in0_op.type) != kind ||
+                               getElementKind(in1_op.type) != kind,
+                           "Error: unexpected types for binary operation",
+                           ANEURALNETWORKS_OP_FAILED);
+  switch (kind) {
+    case ElementKind::FLOAT:
+      return hostBinaryTyped<float>(op_type, in0_op, in0, in1_op, in1,
+                                    fuse_code, out_op, out);
+    case ElementKind::INT:
+      return hostBinaryTyped<int32_t>(op_type, in0_op, in0, in1_op, in1,
+                                      fuse_code, out_op, out);
+    default:
+      VLOG_AT("Error: unsupported binary operation on type " << out_op.type);
+      return ANEURALNETWORKS_OP_FAILED;
+  }
+}
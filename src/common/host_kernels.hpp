@@ -0,0 +1,81 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef SRC_COMMON_HOST_KERNELS_HPP
+#define SRC_COMMON_HOST_KERNELS_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "common/slice_bounds.hpp"
+#include "tensoropt/operation.hpp"
+
+/**
+ * Host implementations of operations used to evaluate constant operations when
+ * compiling a model. They follow the semantic of the IMGDNN conversion.
+ * Each input is described by its operand type and data. The result is written
+ * to out which is resized to the size of out_op.
+ * ANEURALNETWORKS_OP_FAILED is returned if the operation or types are not
+ * supported in which case the operation should be executed on the device.
+ */
+
+using host_data_t = std::vector<uint8_t>;
+
+ResultCode hostCopy(const ANeuralNetworksOperandType& in_op, const void* in,
+                    const ANeuralNetworksOperandType& out_op, host_data_t& out);
+
+ResultCode hostTranspose(const ANeuralNetworksOperandType& in_op,
+                         const void* in, const std::vector<int32_t>& perms,
+                         const ANeuralNetworksOperandType& out_op,
+                         host_data_t& out);
+
+ResultCode hostSubTensor(const ANeuralNetworksOperandType& in_op,
+                         const void* in, const SliceBounds& bounds,
+                         const ANeuralNetworksOperandType& out_op,
+                         host_data_t& out);
+
+/**
+ * Pad the end of each dimension of the input with zeros up to the output
+ * dimensions.
+ */
+ResultCode hostPad(const ANeuralNetworksOperandType& in_op, const void* in,
+                   const ANeuralNetworksOperandType& out_op, host_data_t& out);
+
+ResultCode hostConcat(const std::vector<ANeuralNetworksOperandType>& in_ops,
+                      const std::vector<const void*>& ins, uint32_t axis,
+                      const ANeuralNetworksOperandType& out_op,
+                      host_data_t& out);
+
+ResultCode hostCast(const ANeuralNetworksOperandType& in_op, const void* in,
+                    const ANeuralNetworksOperandType& out_op, host_data_t& out);
+
+ResultCode hostUnary(ANeuralNetworksOperationType op_type,
+                     const ANeuralNetworksOperandType& in_op, const void* in,
+                     const ANeuralNetworksOperandType& out_op,
+                     host_data_t& out);
+
+/**
+ * Binary operations broadcast their inputs to the output shape and apply the
+ * fuse code.
+ */
+ResultCode hostBinary(ANeuralNetworksOperationType op_type,
+                      const ANeuralNetworksOperandType& in0_op,
+                      const void* in0,
+                      const ANeuralNetworksOperandType& in1_op,
+                      const void* in1, int32_t fuse_code,
+                      const ANeuralNetworksOperandType& out_op,
+                      host_data_t& out);
+
+#endif  // SRC_COMMON_HOST_KERNELS_HPP
@@ -15,6 +15,7 @@
  */
 #include "common/memory.hpp"
 #include "common/macro.hpp"
+#include "common/trace.hpp"
 
 #ifndef _WIN32
 #include <sys/mman.h>
@@ -23,6 +24,7 @@
 ResultCode ANeuralNetworksMemory_createFromFd(std::size_t size, int protect,
                                               int fd, std::size_t offset,
                                               ANeuralNetworksMemory** memory) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_RETURN_IF_COND(fd < 0, "Error: invalid fid",
                            ANEURALNETWORKS_BAD_DATA);
 #ifdef _WIN32
@@ -46,6 +48,7 @@ ResultCode ANeuralNetworksMemory_createFromFd(std::size_t size, int protect,
 
 ResultCode ANeuralNetworksMemory_createFromHost(
     const void* data, std::size_t size, ANeuralNetworksMemory** memory) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_RETURN_IF_NULL(data);
   TENSOROPT_RETURN_IF_NULL(memory);
   *memory = new ANeuralNetworksMemory{tensoropt_buffer_t(
@@ -57,6 +60,7 @@ ResultCode ANeuralNetworksMemory_createFromHost(
 
 ResultCode ANeuralNetworksMemory_createFromBuffer(
     const tensoropt_buffer_t& buffer, ANeuralNetworksMemory** memory) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_RETURN_IF_NULL(memory);
   *memory = new ANeuralNetworksMemory{buffer};
   return ANEURALNETWORKS_NO_ERROR;
@@ -64,11 +68,13 @@ ResultCode ANeuralNetworksMemory_createFromBuffer(
 
 ResultCode ANeuralNetworksMemory_resetBuffer(ANeuralNetworksMemory* memory,
                                              const tensoropt_buffer_t& buffer) {
+  TENSOROPT_TRACE_API();
   memory->buffer = buffer;
   return ANEURALNETWORKS_NO_ERROR;
 }
 
 void ANeuralNetworksMemory_free(ANeuralNetworksMemory* memory) {
+  TENSOROPT_TRACE_API();
   if (memory) {
     delete memory;
   }
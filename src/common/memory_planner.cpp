@@ -0,0 +1,110 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/memory_planner.hpp"
+#include "common/macro.hpp"
+#include "common/shape_inference.hpp"
+#include "common/utils.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+struct Lifetime {
+  uint32_t operand;
+  std::size_t size;
+  std::size_t first;
+  std::size_t last;
+};
+
+std::size_t alignSize(std::size_t size) {
+  return (size + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+}
+
+bool overlap(const Lifetime& lhs, const Lifetime& rhs) {
+  return lhs.first <= rhs.last && rhs.first <= lhs.last;
+}
+
+}  // end namespace
+
+ResultCode planMemory(const ANeuralNetworksModel& model, MemoryPlan& plan) {
+  plan.offsets.clear();
+  plan.arena_size = 0;
+
+  // Index of each intermediate operand in lifetimes
+  std::unordered_map<uint32_t, std::size_t> lifetime_indices;
+  std::vector<Lifetime> lifetimes;
+  for (std::size_t i = 0; i < model.operations.size(); ++i) {
+    const auto& operation = model.operations[i];
+    for (auto input : operation.inputs) {
+      auto it = lifetime_indices.find(input);
+      if (it != lifetime_indices.end()) {
+        lifetimes[it->second].last = i;
+      }
+    }
+    for (auto output : operation.outputs) {
+      if (std::find(model.outputs.begin(), model.outputs.end(), output) !=
+          model.outputs.end()) {
+        continue;
+      }
+      const auto& op = model.operands[output];
+      TENSOROPT_RETURN_IF_COND(!isShapeKnown(getOperandShape(op)),
+                               "Error: the size of operand "
+                                   << output << " is unknown",
+                               ANEURALNETWORKS_BAD_DATA);
+      lifetime_indices[output] = lifetimes.size();
+      lifetimes.push_back({output, alignSize(getOperandTypeSizeBytes(op)), i,
+                           i});
+    }
+  }
+
+  // Place the largest operands first, each one at the lowest offset where it
+  // does not overlap with an operand already placed and alive at the same
+  // time.
+  std::vector<std::size_t> order(lifetimes.size());
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&lifetimes](std::size_t lhs, std::size_t rhs) {
+                     return lifetimes[lhs].size > lifetimes[rhs].size;
+                   });
+  std::vector<std::size_t> placed;
+  std::vector<std::pair<std::size_t, std::size_t>> used_ranges;
+  for (auto idx : order) {
+    const auto& lifetime = lifetimes[idx];
+    used_ranges.clear();
+    for (auto placed_idx : placed) {
+      const auto& other = lifetimes[placed_idx];
+      if (overlap(lifetime, other)) {
+        auto other_offset = plan.offsets[other.operand];
+        used_ranges.emplace_back(other_offset, other_offset + other.size);
+      }
+    }
+    std::sort(used_ranges.begin(), used_ranges.end());
+    std::size_t offset = 0;
+    for (const auto& range : used_ranges) {
+      if (offset + lifetime.size <= range.first) {
+        break;
+      }
+      offset = std::max(offset, range.second);
+    }
+    plan.offsets[lifetime.operand] = offset;
+    plan.arena_size = std::max(plan.arena_size, offset + lifetime.size);
+    placed.push_back(idx);
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
@@ -0,0 +1,51 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef SRC_COMMON_MEMORY_PLANNER_HPP
+#define SRC_COMMON_MEMORY_PLANNER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+#include "common/model.hpp"
+
+/**
+ * Alignment in bytes of each tensor in the arena.
+ */
+constexpr std::size_t ARENA_ALIGNMENT = 64;
+
+/**
+ * Placement of the intermediate operands of a model in a single arena.
+ * Intermediate operands are the outputs of operations which are not model
+ * outputs. Operands whose lifetimes do not overlap can share the same memory.
+ */
+struct MemoryPlan {
+  // Offset in bytes of each intermediate operand, indexed by operand index
+  std::unordered_map<uint32_t, std::size_t> offsets;
+  // Peak memory needed by the intermediate operands
+  std::size_t arena_size;
+};
+
+/**
+ * Compute the lifetime of each intermediate operand from the order of the
+ * operations and assign their offsets in the arena.
+ * The lifetime of an operand starts with the operation producing it and ends
+ * with its last use. The operations must be sorted and the shapes of the
+ * intermediate operands must be known.
+ */
+ResultCode planMemory(const ANeuralNetworksModel& model, MemoryPlan& plan);
+
+#endif  // SRC_COMMON_MEMORY_PLANNER_HPP
@@ -15,21 +15,108 @@
  */
 #include "common/model.hpp"
 #include "common/macro.hpp"
+#include "common/trace.hpp"
 
+#include <cstring>
 #include <utility>
 
+namespace {
+
+/**
+ * Tag written before each record so that different sequences of calls cannot
+ * produce the same stream of bytes.
+ */
+enum HashRecord : uint8_t {
+  HASH_OPERAND = 0,
+  HASH_HOST_VALUE,
+  HASH_DEVICE_VALUE,
+  HASH_OPERATION,
+  HASH_INPUTS,
+  HASH_OUTPUTS
+};
+
+void hashRecord(Sha256& hasher, HashRecord record, uint32_t index) {
+  uint8_t tag = record;
+  hasher.update(&tag, sizeof(tag));
+  hasher.updateU32(index);
+}
+
+void hashIndices(Sha256& hasher, const std::vector<uint32_t>& indices) {
+  hasher.updateU32(static_cast<uint32_t>(indices.size()));
+  for (uint32_t index : indices) {
+    hasher.updateU32(index);
+  }
+}
+
+void hashData(Sha256& hasher, const void* data, std::size_t length) {
+  hasher.updateU32(static_cast<uint32_t>(length));
+  hasher.update(data, length);
+}
+
+}  // end namespace
+
+ANeuralNetworksModel::ANeuralNetworksModel(const ANeuralNetworksModel& other)
+    : operands_dimensions(other.operands_dimensions),
+      operands(other.operands),
+      const_host_operands(other.const_host_operands),
+      const_host_operands_owned(other.const_host_operands_owned),
+      const_device_operands(other.const_device_operands),
+      is_supported_ops_filled(other.is_supported_ops_filled),
+      supported_ops(other.supported_ops),
+      operations(other.operations),
+      inputs(other.inputs),
+      outputs(other.outputs),
+      hasher(other.hasher),
+      hash(other.hash),
+      finished(other.finished) {
+  for (std::size_t i = 0; i < operands.size(); ++i) {
+    operands[i].dimensions = operands_dimensions[i].data();
+  }
+}
+
+ANeuralNetworksModel& ANeuralNetworksModel::operator=(
+    const ANeuralNetworksModel& other) {
+  if (this != &other) {
+    ANeuralNetworksModel copy(other);
+    *this = std::move(copy);
+  }
+  return *this;
+}
+
 ResultCode ANeuralNetworksModel_create(ANeuralNetworksModel** model) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_RETURN_IF_NULL(model);
   *model = new ANeuralNetworksModel();
   return ANEURALNETWORKS_NO_ERROR;
 }
 
 ResultCode ANeuralNetworksModel_finish(ANeuralNetworksModel* model) {
+  TENSOROPT_TRACE_API();
+  if (model->finished) {
+    return ANEURALNETWORKS_NO_ERROR;
+  }
+  // Inputs and outputs can be identified multiple times so they are only
+  // hashed once the model is finished.
+  hashRecord(model->hasher, HASH_INPUTS, 0);
+  hashIndices(model->hasher, model->inputs);
+  hashRecord(model->hasher, HASH_OUTPUTS, 0);
+  hashIndices(model->hasher, model->outputs);
+  model->hash = model->hasher.digest();
   model->finished = true;
   return ANEURALNETWORKS_NO_ERROR;
 }
 
+ResultCode ANeuralNetworksModel_getHash(const ANeuralNetworksModel* model,
+                                        uint8_t* hash) {
+  TENSOROPT_TRACE_API();
+  TENSOROPT_RETURN_IF_NULL(hash);
+  TENSOROPT_RETURN_IF_UNFINISHED(model);
+  std::memcpy(hash, model->hash.data(), model->hash.size());
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
 void ANeuralNetworksModel_free(ANeuralNetworksModel* model) {
+  TENSOROPT_TRACE_API();
   if (model) {
     delete model;
   }
@@ -42,6 +129,7 @@ void ANeuralNetworksModel_free(ANeuralNetworksModel* model) {
 ResultCode ANeuralNetworksModel_addOperand(
     ANeuralNetworksModel* model, const ANeuralNetworksOperandType* type,
     uint32_t* operand_index) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_RETURN_IF_FINISHED(model);
   if (operand_index) {
     *operand_index = static_cast<uint32_t>(model->operands.size());
@@ -54,17 +142,31 @@ ResultCode ANeuralNetworksModel_addOperand(
   ANeuralNetworksOperandType internal_type = *type;
   internal_type.dimensions = internal_dims.data();
   model->operands.push_back(internal_type);
+
+  auto& hasher = model->hasher;
+  hashRecord(hasher, HASH_OPERAND,
+             static_cast<uint32_t>(model->operands.size() - 1));
+  hasher.updateU32(static_cast<uint32_t>(type->type));
+  hashIndices(hasher, internal_dims);
+  uint32_t scale_bits;
+  static_assert(sizeof(scale_bits) == sizeof(type->scale),
+                "Unexpected size of scale");
+  std::memcpy(&scale_bits, &type->scale, sizeof(scale_bits));
+  hasher.updateU32(scale_bits);
+  hasher.updateU32(static_cast<uint32_t>(type->zeroPoint));
   return ANEURALNETWORKS_NO_ERROR;
 }
 
 uint32_t ANeuralNetworksModel_getOperandCount(
     const ANeuralNetworksModel* model) {
+  TENSOROPT_TRACE_API();
   return static_cast<uint32_t>(model->operands.size());
 }
 
 ResultCode ANeuralNetworksModel_getOperandType(
     const ANeuralNetworksModel* model, int32_t index,
     ANeuralNetworksOperandType* type) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_TO_UINT32_INDEX(index, uindex);
   *type = model->operands[uindex];
   return ANEURALNETWORKS_NO_ERROR;
@@ -73,6 +175,7 @@ ResultCode ANeuralNetworksModel_getOperandType(
 ResultCode ANeuralNetworksModel_setOperandValue(ANeuralNetworksModel* model,
                                                 int32_t index, const void* data,
                                                 std::size_t length) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_RETURN_IF_FINISHED(model);
   TENSOROPT_TO_UINT32_INDEX(index, uindex);
   if (length <= ANEURALNETWORKS_MAX_SIZE_OF_IMMEDIATELY_COPIED_VALUES) {
@@ -92,6 +195,9 @@ ResultCode ANeuralNetworksModel_setOperandValue(ANeuralNetworksModel* model,
 
   // Replace previous Operand value from Memory if it was set
   model->const_device_operands.erase(uindex);
+
+  hashRecord(model->hasher, HASH_HOST_VALUE, uindex);
+  hashData(model->hasher, data, length);
   return ANEURALNETWORKS_NO_ERROR;
 }
 
@@ -99,6 +205,7 @@ ResultCode ANeuralNetworksModel_setOperandValueFromMemory(
     ANeuralNetworksModel* model, int32_t index,
     const ANeuralNetworksMemory* memory, std::size_t offset,
     std::size_t length) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_RETURN_IF_FINISHED(model);
   TENSOROPT_TO_UINT32_INDEX(index, uindex);
   ANeuralNetworksModel::ConstDeviceOperand op(*memory, offset, length);
@@ -111,6 +218,13 @@ ResultCode ANeuralNetworksModel_setOperandValueFromMemory(
   // Replace previous Operand value from host if it was set
   model->const_host_operands.erase(uindex);
   model->const_host_operands_owned.erase(uindex);
+
+  // The content of the memory is hashed rather than its handle so that the
+  // same weights give the same hash. This waits for any pending write to the
+  // buffer.
+  hashRecord(model->hasher, HASH_DEVICE_VALUE, uindex);
+  auto acc = op.memory.buffer.get_access<cl::sycl::access::mode::read>();
+  hashData(model->hasher, acc.get_pointer() + offset, length);
   return ANEURALNETWORKS_NO_ERROR;
 }
 
@@ -130,23 +244,33 @@ ResultCode ANeuralNetworksModel_addOperation(ANeuralNetworksModel* model,
                                              const uint32_t* inputs,
                                              uint32_t output_count,
                                              const uint32_t* outputs) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_RETURN_IF_FINISHED(model);
   model->operations.emplace_back();
   auto& operation = model->operations.back();
   operation.type = op;
   operation.inputs.assign(inputs, inputs + input_count);
   operation.outputs.assign(outputs, outputs + output_count);
+
+  auto& hasher = model->hasher;
+  hashRecord(hasher, HASH_OPERATION,
+             static_cast<uint32_t>(model->operations.size() - 1));
+  hasher.updateU32(static_cast<uint32_t>(op));
+  hashIndices(hasher, operation.inputs);
+  hashIndices(hasher, operation.outputs);
   return ANEURALNETWORKS_NO_ERROR;
 }
 
 uint32_t ANeuralNetworksModel_getOperationCount(
     const ANeuralNetworksModel* model) {
+  TENSOROPT_TRACE_API();
   return static_cast<uint32_t>(model->operations.size());
 }
 
 ResultCode ANeuralNetworksModel_getOperationType(
     const ANeuralNetworksModel* model, int32_t index,
     ANeuralNetworksOperationType* op) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_TO_UINT32_INDEX(index, uindex);
   *op = model->operations[uindex].type;
   return ANEURALNETWORKS_NO_ERROR;
@@ -154,6 +278,7 @@ ResultCode ANeuralNetworksModel_getOperationType(
 
 ResultCode ANeuralNetworksModel_getOperationInputCount(
     const ANeuralNetworksModel* model, int32_t index, uint32_t* input_count) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_TO_UINT32_INDEX(index, uindex);
   *input_count = static_cast<uint32_t>(model->operations[uindex].inputs.size());
   return ANEURALNETWORKS_NO_ERROR;
@@ -161,6 +286,7 @@ ResultCode ANeuralNetworksModel_getOperationInputCount(
 
 ResultCode ANeuralNetworksModel_getOperationInputs(
     const ANeuralNetworksModel* model, int32_t index, const uint32_t** inputs) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_TO_UINT32_INDEX(index, uindex);
   *inputs = model->operations[uindex].inputs.data();
   return ANEURALNETWORKS_NO_ERROR;
@@ -168,6 +294,7 @@ ResultCode ANeuralNetworksModel_getOperationInputs(
 
 ResultCode ANeuralNetworksModel_getOperationOutputCount(
     const ANeuralNetworksModel* model, int32_t index, uint32_t* output_count) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_TO_UINT32_INDEX(index, uindex);
   *output_count =
       static_cast<uint32_t>(model->operations[uindex].outputs.size());
@@ -177,6 +304,7 @@ ResultCode ANeuralNetworksModel_getOperationOutputCount(
 ResultCode ANeuralNetworksModel_getOperationOutputs(
     const ANeuralNetworksModel* model, int32_t index,
     const uint32_t** outputs) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_TO_UINT32_INDEX(index, uindex);
   *outputs = model->operations[uindex].outputs.data();
   return ANEURALNETWORKS_NO_ERROR;
@@ -189,6 +317,7 @@ ResultCode ANeuralNetworksModel_getOperationOutputs(
 ResultCode ANeuralNetworksModel_identifyInputs(ANeuralNetworksModel* model,
                                                uint32_t input_count,
                                                const uint32_t* inputs) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_RETURN_IF_FINISHED(model);
   model->inputs.assign(inputs, inputs + input_count);
   return ANEURALNETWORKS_NO_ERROR;
@@ -197,6 +326,7 @@ ResultCode ANeuralNetworksModel_identifyInputs(ANeuralNetworksModel* model,
 ResultCode ANeuralNetworksModel_identifyOutputs(ANeuralNetworksModel* model,
                                                 uint32_t output_count,
                                                 const uint32_t* outputs) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_RETURN_IF_FINISHED(model);
   model->outputs.assign(outputs, outputs + output_count);
   return ANEURALNETWORKS_NO_ERROR;
@@ -205,6 +335,7 @@ ResultCode ANeuralNetworksModel_identifyOutputs(ANeuralNetworksModel* model,
 ResultCode ANeuralNetworksModel_identifyInputsAndOutputs(
     ANeuralNetworksModel* model, uint32_t input_count, const uint32_t* inputs,
     uint32_t output_count, const uint32_t* outputs) {
+  TENSOROPT_TRACE_API();
   TENSOROPT_RETURN_IF_FINISHED(model);
   TENSOROPT_RETURN_IF_ERROR(
       ANeuralNetworksModel_identifyInputs(model, input_count, inputs));
@@ -215,20 +346,24 @@ ResultCode ANeuralNetworksModel_identifyInputsAndOutputs(
 
 uint32_t ANeuralNetworksModel_getIdentifiedInputCount(
     const ANeuralNetworksModel* model) {
+  TENSOROPT_TRACE_API();
   return static_cast<uint32_t>(model->inputs.size());
 }
 
 const uint32_t* ANeuralNetworksModel_getIdentifiedInputs(
     const ANeuralNetworksModel* model) {
+  TENSOROPT_TRACE_API();
   return model->inputs.data();
 }
 
 uint32_t ANeuralNetworksModel_getIdentifiedOutputCount(
     const ANeuralNetworksModel* model) {
+  TENSOROPT_TRACE_API();
   return static_cast<uint32_t>(model->outputs.size());
 }
 
 const uint32_t* ANeuralNetworksModel_getIdentifiedOutputs(
     const ANeuralNetworksModel* model) {
+  TENSOROPT_TRACE_API();
   return model->outputs.data();
 }
@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "common/memory.hpp"
+#include "common/sha256.hpp"
 #include "tensoropt/model.hpp"
 
 struct ANeuralNetworksModel {
@@ -52,6 +53,19 @@ struct ANeuralNetworksModel {
 
   using owned_const_host_data = std::vector<uint8_t>;
 
+  ANeuralNetworksModel() = default;
+
+  /**
+   * Copy a model, the operand types point to the copied dimensions.
+   * Host data that is not owned by the model is not copied.
+   */
+  ANeuralNetworksModel(const ANeuralNetworksModel& other);
+  ANeuralNetworksModel& operator=(const ANeuralNetworksModel& other);
+
+  // Moving the dimensions keeps their data valid
+  ANeuralNetworksModel(ANeuralNetworksModel&&) = default;
+  ANeuralNetworksModel& operator=(ANeuralNetworksModel&&) = default;
+
   std::vector<std::vector<uint32_t>> operands_dimensions;
   std::vector<ANeuralNetworksOperandType> operands;
   std::unordered_map<uint32_t, ConstHostOperand> const_host_operands;
@@ -62,6 +76,9 @@ struct ANeuralNetworksModel {
   std::vector<Operation> operations;
   std::vector<uint32_t> inputs;
   std::vector<uint32_t> outputs;
+  // Updated as the model is built, hash is only valid once finished
+  Sha256 hasher;
+  std::array<uint8_t, BYTE_SIZE_OF_MODEL_HASH> hash;
   bool finished;
 };
 
@@ -0,0 +1,90 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/passes/passes.hpp"
+#include "common/macro.hpp"
+#include "common/passes/graph_utils.hpp"
+
+#include <unordered_map>
+
+namespace {
+
+bool isReshape(ANeuralNetworksOperationType type) {
+  return type == ANEURALNETWORKS_RESHAPE || type == ANEURALNETWORKS_SQUEEZE;
+}
+
+/**
+ * Return true if both operands have the same known shape.
+ */
+bool haveSameKnownShape(const ANeuralNetworksModel& model, uint32_t lhs_idx,
+                        uint32_t rhs_idx) {
+  const auto& lhs = model.operands[lhs_idx];
+  const auto& rhs = model.operands[rhs_idx];
+  if (lhs.dimensionCount != rhs.dimensionCount) {
+    return false;
+  }
+  for (uint32_t i = 0; i < lhs.dimensionCount; ++i) {
+    if (lhs.dimensions[i] == 0 || lhs.dimensions[i] != rhs.dimensions[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // end namespace
+
+ResultCode collapseReshapes(ANeuralNetworksModel& model) {
+  // Operand produced by a reshape mapped to the input of the first reshape of
+  // the chain
+  std::unordered_map<uint32_t, uint32_t> reshape_sources;
+  std::unordered_map<uint32_t, uint32_t> replaced_operands;
+  std::vector<bool> removed(model.operations.size(), false);
+  for (std::size_t i = 0; i < model.operations.size(); ++i) {
+    auto& operation = model.operations[i];
+    // Operations are sorted so the inputs are already replaced
+    for (auto& input_idx : operation.inputs) {
+      auto it = replaced_operands.find(input_idx);
+      if (it != replaced_operands.end()) {
+        input_idx = it->second;
+      }
+    }
+    if (!isReshape(operation.type) || operation.inputs.empty() ||
+        operation.outputs.size() != 1) {
+      continue;
+    }
+    auto output_idx = operation.outputs[0];
+    auto source_idx = operation.inputs[0];
+    auto source_it = reshape_sources.find(source_idx);
+    if (source_it != reshape_sources.end()) {
+      source_idx = source_it->second;
+      // The shape input of a RESHAPE does not depend on its input so the
+      // reshape can be applied to the start of the chain directly
+      if (operation.type == ANEURALNETWORKS_RESHAPE) {
+        VLOG_ENDL("Collapsing reshape #" << i << " with its input reshapes");
+        operation.inputs[0] = source_idx;
+      }
+    }
+    if (haveSameKnownShape(model, source_idx, output_idx) &&
+        !isModelOutput(model, output_idx)) {
+      VLOG_ENDL("Removing reshape #" << i << " which keeps the same shape");
+      replaced_operands[output_idx] = source_idx;
+      removed[i] = true;
+      continue;
+    }
+    reshape_sources[output_idx] = source_idx;
+  }
+  removeOperations(model, removed);
+  return ANEURALNETWORKS_NO_ERROR;
+}
@@ -0,0 +1,115 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/passes/passes.hpp"
+#include "common/macro.hpp"
+#include "common/passes/graph_utils.hpp"
+
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+using Operation = ANeuralNetworksModel::Operation;
+
+/**
+ * Constants up to this size are compared by value, larger constants are
+ * compared by operand index to avoid copying weights.
+ */
+constexpr std::size_t MAX_CONST_SIZE_COMPARED_BY_VALUE = 64;
+
+template <class T>
+void appendValue(std::string& key, const T& value) {
+  key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void appendOperandType(std::string& key, const ANeuralNetworksOperandType& op) {
+  appendValue(key, op.type);
+  appendValue(key, op.dimensionCount);
+  key.append(reinterpret_cast<const char*>(op.dimensions),
+             op.dimensionCount * sizeof(uint32_t));
+}
+
+/**
+ * Build a key identifying the result of an operation.
+ * Two operations with the same key compute the same outputs.
+ */
+std::string getOperationKey(const ANeuralNetworksModel& model,
+                            const Operation& operation) {
+  std::string key;
+  appendValue(key, operation.type);
+  appendValue(key, operation.inputs.size());
+  for (auto input_idx : operation.inputs) {
+    const void* data;
+    std::size_t length;
+    if (getConstHostOperand(model, input_idx, &data, length) &&
+        length <= MAX_CONST_SIZE_COMPARED_BY_VALUE) {
+      key += 'c';
+      appendOperandType(key, model.operands[input_idx]);
+      appendValue(key, length);
+      key.append(static_cast<const char*>(data), length);
+    } else {
+      key += 'o';
+      appendValue(key, input_idx);
+    }
+  }
+  appendValue(key, operation.outputs.size());
+  for (auto output_idx : operation.outputs) {
+    appendOperandType(key, model.operands[output_idx]);
+  }
+  return key;
+}
+
+}  // end namespace
+
+ResultCode eliminateCommonSubexpressions(ANeuralNetworksModel& model) {
+  std::unordered_map<uint32_t, uint32_t> replaced_operands;
+  std::unordered_map<std::string, std::size_t> computed_operations;
+  std::vector<bool> removed(model.operations.size(), false);
+  for (std::size_t i = 0; i < model.operations.size(); ++i) {
+    auto& operation = model.operations[i];
+    // Operations are sorted so the inputs are already replaced
+    for (auto& input_idx : operation.inputs) {
+      auto it = replaced_operands.find(input_idx);
+      if (it != replaced_operands.end()) {
+        input_idx = it->second;
+      }
+    }
+    auto key = getOperationKey(model, operation);
+    auto computed_it = computed_operations.find(key);
+    if (computed_it == computed_operations.end()) {
+      computed_operations[key] = i;
+      continue;
+    }
+    // Outputs of the model cannot be replaced
+    bool has_model_output = false;
+    for (auto output_idx : operation.outputs) {
+      has_model_output = has_model_output || isModelOutput(model, output_idx);
+    }
+    if (has_model_output) {
+      continue;
+    }
+    const auto& computed = model.operations[computed_it->second];
+    VLOG_ENDL("Replacing operation #" << i << " (code=" << operation.type
+                                      << ") with operation #"
+                                      << computed_it->second);
+    for (std::size_t j = 0; j < operation.outputs.size(); ++j) {
+      replaced_operands[operation.outputs[j]] = computed.outputs[j];
+    }
+    removed[i] = true;
+  }
+  removeOperations(model, removed);
+  return ANEURALNETWORKS_NO_ERROR;
+}
@@ -0,0 +1,59 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/passes/passes.hpp"
+#include "common/macro.hpp"
+#include "common/passes/graph_utils.hpp"
+
+#include <unordered_set>
+
+ResultCode eliminateDeadOperations(ANeuralNetworksModel& model) {
+  std::unordered_set<uint32_t> live_operands(model.outputs.begin(),
+                                             model.outputs.end());
+  // Operations are sorted so a single backward walk is enough
+  std::vector<bool> dead_operations(model.operations.size(), true);
+  for (std::size_t i = model.operations.size(); i-- > 0;) {
+    const auto& operation = model.operations[i];
+    for (auto output_idx : operation.outputs) {
+      if (live_operands.count(output_idx)) {
+        dead_operations[i] = false;
+        break;
+      }
+    }
+    if (dead_operations[i]) {
+      VLOG_ENDL("Removing dead operation #" << i
+                                            << " (code=" << operation.type
+                                            << ")");
+    } else {
+      live_operands.insert(operation.inputs.begin(), operation.inputs.end());
+    }
+  }
+  removeOperations(model, dead_operations);
+
+  // Unused constants are not uploaded to the device
+  auto erase_dead = [&](auto& const_operands) {
+    for (auto it = const_operands.begin(); it != const_operands.end();) {
+      if (live_operands.count(it->first)) {
+        ++it;
+      } else {
+        it = const_operands.erase(it);
+      }
+    }
+  };
+  erase_dead(model.const_host_operands);
+  erase_dead(model.const_host_operands_owned);
+  erase_dead(model.const_device_operands);
+  return ANEURALNETWORKS_NO_ERROR;
+}
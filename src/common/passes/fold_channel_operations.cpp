@@ -0,0 +1,217 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/passes/passes.hpp"
+#include "common/macro.hpp"
+#include "common/passes/graph_utils.hpp"
+#include "common/utils.hpp"
+
+#include <unordered_map>
+
+namespace {
+
+using Operation = ANeuralNetworksModel::Operation;
+
+/**
+ * Description of a convolution whose filter and bias are host constants.
+ */
+struct ConvolutionInfo {
+  uint32_t num_channels;
+  // Axis of the channels in the output of the convolution
+  uint32_t output_channel_axis;
+  // Axis of the output channels in the filter
+  uint32_t filter_channel_axis;
+};
+
+/**
+ * Return true if the convolution can absorb a per-channel operation.
+ */
+bool getConvolutionInfo(const ANeuralNetworksModel& model,
+                        const Operation& operation, ConvolutionInfo& info) {
+  if (operation.type != ANEURALNETWORKS_CONV_2D &&
+      operation.type != ANEURALNETWORKS_DEPTHWISE_CONV_2D) {
+    return false;
+  }
+  int32_t fuse_code;
+  if (operation.inputs.size() < 3 || operation.outputs.size() != 1 ||
+      model.operands[operation.outputs[0]].dimensionCount != 4 ||
+      !readFuseCode(model, operation, fuse_code) ||
+      fuse_code != ANEURALNETWORKS_FUSED_NONE) {
+    return false;
+  }
+  auto fuse_idx =
+      static_cast<uint32_t>(getFuseCodeInputIndex(operation.type));
+  bool is_input_nchw = false;
+  bool is_filter_hwio = false;
+  if (!readOptionalConstHostOperand(model, operation, fuse_idx + 1,
+                                    is_input_nchw) ||
+      !readOptionalConstHostOperand(model, operation, fuse_idx + 2,
+                                    is_filter_hwio)) {
+    return false;
+  }
+
+  const auto& filter_op = model.operands[operation.inputs[1]];
+  const auto& bias_op = model.operands[operation.inputs[2]];
+  const void* data;
+  std::size_t length;
+  if (filter_op.type != ANEURALNETWORKS_TENSOR_FLOAT32 ||
+      filter_op.dimensionCount != 4 ||
+      !getConstHostOperand(model, operation.inputs[1], &data, length) ||
+      length != getOperandTypeSizeBytes(filter_op)) {
+    return false;
+  }
+  info.filter_channel_axis = is_filter_hwio ? 3 : 0;
+  info.num_channels = filter_op.dimensions[info.filter_channel_axis];
+  info.output_channel_axis = is_input_nchw ? 1 : 3;
+  if (bias_op.dimensionCount == 0) {
+    return true;
+  }
+  return bias_op.type == ANEURALNETWORKS_TENSOR_FLOAT32 &&
+         bias_op.dimensionCount == 1 &&
+         bias_op.dimensions[0] == info.num_channels &&
+         getConstHostOperand(model, operation.inputs[2], &data, length) &&
+         length == getOperandTypeSizeBytes(bias_op);
+}
+
+/**
+ * Read a host constant which is broadcast to the output of the convolution
+ * only along its channels. The values are expanded to one value per channel.
+ * Return false if the operand cannot be read this way.
+ */
+bool readChannelValues(const ANeuralNetworksModel& model, uint32_t idx,
+                       const ConvolutionInfo& info,
+                       std::vector<float>& values) {
+  const auto& op = model.operands[idx];
+  if (op.type != ANEURALNETWORKS_TENSOR_FLOAT32 || op.dimensionCount > 4 ||
+      !readConstHostOperand(model, idx, values) ||
+      values.size() != getOperandTypeSize(op)) {
+    return false;
+  }
+  // Dimensions are aligned from the end when broadcasting
+  auto first_axis = 4 - op.dimensionCount;
+  for (uint32_t i = 0; i < op.dimensionCount; ++i) {
+    if (op.dimensions[i] != 1 &&
+        (first_axis + i != info.output_channel_axis ||
+         op.dimensions[i] != info.num_channels)) {
+      return false;
+    }
+  }
+  if (values.size() == 1) {
+    values.resize(info.num_channels, values[0]);
+  }
+  return true;
+}
+
+/**
+ * Fold a MUL or ADD with per-channel values into the filter and bias of a
+ * convolution. New operands are created as the filter and bias may be shared
+ * with other operations.
+ */
+void foldChannelOperation(ANeuralNetworksModel& model, Operation& convolution,
+                          const ConvolutionInfo& info,
+                          ANeuralNetworksOperationType type,
+                          const std::vector<float>& values) {
+  std::vector<float> bias(info.num_channels, 0.f);
+  auto bias_idx = convolution.inputs[2];
+  if (model.operands[bias_idx].dimensionCount == 1) {
+    readConstHostOperand(model, bias_idx, bias);
+  }
+  if (type == ANEURALNETWORKS_MUL) {
+    std::vector<float> filter;
+    auto filter_idx = convolution.inputs[1];
+    readConstHostOperand(model, filter_idx, filter);
+    const auto& filter_op = model.operands[filter_idx];
+    // Number of consecutive elements with the same output channel
+    std::size_t inner_size = 1;
+    for (uint32_t i = info.filter_channel_axis + 1; i < 4; ++i) {
+      inner_size *= filter_op.dimensions[i];
+    }
+    for (std::size_t i = 0; i < filter.size(); ++i) {
+      filter[i] *= values[(i / inner_size) % info.num_channels];
+    }
+    for (uint32_t c = 0; c < info.num_channels; ++c) {
+      bias[c] *= values[c];
+    }
+    ANeuralNetworksModel::owned_const_host_data filter_data(
+        filter.size() * sizeof(float));
+    std::memcpy(filter_data.data(), filter.data(), filter_data.size());
+    convolution.inputs[1] =
+        addOwnedConstOperand(model, filter_op, std::move(filter_data));
+  } else {
+    for (uint32_t c = 0; c < info.num_channels; ++c) {
+      bias[c] += values[c];
+    }
+  }
+  ANeuralNetworksOperandType bias_type{ANEURALNETWORKS_TENSOR_FLOAT32, 1,
+                                       &info.num_channels, 0.f, 0};
+  ANeuralNetworksModel::owned_const_host_data bias_data(bias.size() *
+                                                        sizeof(float));
+  std::memcpy(bias_data.data(), bias.data(), bias_data.size());
+  convolution.inputs[2] =
+      addOwnedConstOperand(model, bias_type, std::move(bias_data));
+}
+
+}  // end namespace
+
+ResultCode foldChannelOperations(ANeuralNetworksModel& model) {
+  auto uses = countOperandUses(model);
+  std::unordered_map<uint32_t, std::size_t> producers;
+  std::vector<bool> folded(model.operations.size(), false);
+  for (std::size_t i = 0; i < model.operations.size(); ++i) {
+    auto& operation = model.operations[i];
+    for (auto output_idx : operation.outputs) {
+      producers[output_idx] = i;
+    }
+    if ((operation.type != ANEURALNETWORKS_MUL &&
+         operation.type != ANEURALNETWORKS_ADD) ||
+        operation.inputs.size() < 2 || operation.outputs.size() != 1) {
+      continue;
+    }
+    // Look for the convolution in either input
+    for (uint32_t conv_input = 0; conv_input < 2; ++conv_input) {
+      auto input_idx = operation.inputs[conv_input];
+      auto producer_it = producers.find(input_idx);
+      if (producer_it == producers.end() || uses[input_idx] != 1 ||
+          isModelOutput(model, input_idx)) {
+        continue;
+      }
+      auto& convolution = model.operations[producer_it->second];
+      ConvolutionInfo info;
+      std::vector<float> values;
+      int32_t fuse_code;
+      if (!getConvolutionInfo(model, convolution, info) ||
+          !readChannelValues(model, operation.inputs[1 - conv_input], info,
+                             values) ||
+          !readFuseCode(model, operation, fuse_code)) {
+        continue;
+      }
+      // The FuseCode of the folded operation is moved to the convolution
+      if (fuse_code != ANEURALNETWORKS_FUSED_NONE &&
+          !setFuseCode(model, convolution, fuse_code)) {
+        continue;
+      }
+      VLOG_ENDL("Folding operation (code=" << operation.type
+                                           << ") in convolution (code="
+                                           << convolution.type << ")");
+      foldChannelOperation(model, convolution, info, operation.type, values);
+      convolution.outputs[0] = operation.outputs[0];
+      producers[operation.outputs[0]] = producer_it->second;
+      folded[i] = true;
+      break;
+    }
+  }
+  removeOperations(model, folded);
+  return ANEURALNETWORKS_NO_ERROR;
+}
@@ -0,0 +1,179 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/passes/passes.hpp"
+#include "common/host_kernels.hpp"
+#include "common/macro.hpp"
+#include "common/passes/graph_utils.hpp"
+#include "common/utils.hpp"
+
+namespace {
+
+using Operation = ANeuralNetworksModel::Operation;
+
+/**
+ * Return true if all the inputs of the operation are host constants of the
+ * expected size.
+ */
+bool hasOnlyHostConstInputs(const ANeuralNetworksModel& model,
+                            const Operation& operation) {
+  for (auto input_idx : operation.inputs) {
+    const void* data;
+    std::size_t length;
+    if (!getConstHostOperand(model, input_idx, &data, length) ||
+        length != getOperandTypeSizeBytes(model.operands[input_idx])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Evaluate an operation whose inputs are all host constants.
+ */
+ResultCode evaluateOperation(const ANeuralNetworksModel& model,
+                             const Operation& operation, host_data_t& out) {
+  auto get_data = [&](uint32_t i) {
+    const void* data = nullptr;
+    std::size_t length;
+    getConstHostOperand(model, operation.inputs[i], &data, length);
+    return data;
+  };
+  auto get_op = [&](uint32_t i) -> const ANeuralNetworksOperandType& {
+    return model.operands[operation.inputs[i]];
+  };
+  const auto& out_op = model.operands[operation.outputs[0]];
+
+  switch (operation.type) {
+    case ANEURALNETWORKS_RESHAPE:
+    case ANEURALNETWORKS_SQUEEZE:
+      return hostCopy(get_op(0), get_data(0), out_op, out);
+
+    case ANEURALNETWORKS_TRANSPOSE: {
+      std::vector<int32_t> perms;
+      readConstHostOperand(model, operation.inputs[1], perms);
+      return hostTranspose(get_op(0), get_data(0), perms, out_op, out);
+    }
+
+    case ANEURALNETWORKS_CAST:
+      return hostCast(get_op(0), get_data(0), out_op, out);
+
+    case ANEURALNETWORKS_SLICE: {
+      TENSOROPT_RETURN_IF_UNEXPECTED_SIZE(operation, inputs, 3);
+      std::vector<int32_t> begins;
+      std::vector<int32_t> sizes;
+      readConstHostOperand(model, operation.inputs[1], begins);
+      readConstHostOperand(model, operation.inputs[2], sizes);
+      SliceBounds bounds;
+      TENSOROPT_RETURN_IF_ERROR(
+          getSliceBounds(get_op(0), begins, sizes, bounds));
+      return hostSubTensor(get_op(0), get_data(0), bounds, out_op, out);
+    }
+
+    case ANEURALNETWORKS_STRIDED_SLICE: {
+      TENSOROPT_RETURN_IF_UNEXPECTED_MINMAX_SIZE(operation, inputs, 4, 9);
+      std::vector<int32_t> begins;
+      std::vector<int32_t> ends;
+      std::vector<int32_t> strides;
+      std::bitset<32> begin_mask;
+      std::bitset<32> end_mask;
+      std::bitset<32> shrink_axis_mask;
+      std::bitset<32> ellipsis_mask;
+      readConstHostOperand(model, operation.inputs[1], begins);
+      readConstHostOperand(model, operation.inputs[2], ends);
+      readConstHostOperand(model, operation.inputs[3], strides);
+      readOptionalConstHostOperand(model, operation, 4, begin_mask);
+      readOptionalConstHostOperand(model, operation, 5, end_mask);
+      readOptionalConstHostOperand(model, operation, 6, shrink_axis_mask);
+      readOptionalConstHostOperand(model, operation, 7, ellipsis_mask);
+      // The new axis mask only changes the shape of the output
+      SliceBounds bounds;
+      TENSOROPT_RETURN_IF_ERROR(getStridedSliceBounds(
+          get_op(0), begins, ends, strides, begin_mask, end_mask,
+          shrink_axis_mask, ellipsis_mask, bounds));
+      return hostSubTensor(get_op(0), get_data(0), bounds, out_op, out);
+    }
+
+    case ANEURALNETWORKS_CONCATENATION: {
+      TENSOROPT_RETURN_IF_UNEXPECTED_MIN_SIZE(operation, inputs, 2);
+      auto nb_tensors = static_cast<uint32_t>(operation.inputs.size() - 1);
+      std::vector<ANeuralNetworksOperandType> in_ops;
+      std::vector<const void*> ins;
+      for (uint32_t i = 0; i < nb_tensors; ++i) {
+        in_ops.push_back(get_op(i));
+        ins.push_back(get_data(i));
+      }
+      int32_t axis = 0;
+      readConstHostOperand(model, operation.inputs[nb_tensors], axis);
+      if (axis < 0) {
+        axis += static_cast<int32_t>(get_op(0).dimensionCount);
+      }
+      return hostConcat(in_ops, ins, static_cast<uint32_t>(axis), out_op, out);
+    }
+
+    case ANEURALNETWORKS_EXP:
+    case ANEURALNETWORKS_RELU:
+    case ANEURALNETWORKS_RELU1:
+    case ANEURALNETWORKS_RELU6:
+    case ANEURALNETWORKS_RSQRT:
+    case ANEURALNETWORKS_SQRT:
+      TENSOROPT_RETURN_IF_UNEXPECTED_SIZE(operation, inputs, 1);
+      return hostUnary(operation.type, get_op(0), get_data(0), out_op, out);
+
+    case ANEURALNETWORKS_ADD:
+    case ANEURALNETWORKS_MUL:
+    case ANEURALNETWORKS_SUB:
+    case ANEURALNETWORKS_DIV:
+    case ANEURALNETWORKS_MAX:
+    case ANEURALNETWORKS_MIN: {
+      TENSOROPT_RETURN_IF_UNEXPECTED_MINMAX_SIZE(operation, inputs, 2, 3);
+      int32_t fuse_code = ANEURALNETWORKS_FUSED_NONE;
+      readOptionalConstHostOperand(model, operation, 2, fuse_code);
+      return hostBinary(operation.type, get_op(0), get_data(0), get_op(1),
+                        get_data(1), fuse_code, out_op, out);
+    }
+
+    default:
+      return ANEURALNETWORKS_OP_FAILED;
+  }
+}
+
+}  // end namespace
+
+ResultCode foldConstants(ANeuralNetworksModel& model) {
+  std::vector<Operation> operations;
+  operations.reserve(model.operations.size());
+  for (auto& operation : model.operations) {
+    // Constants cannot be outputs of the model
+    bool can_fold = operation.outputs.size() == 1 &&
+                    !isModelOutput(model, operation.outputs[0]) &&
+                    hasOnlyHostConstInputs(model, operation);
+    host_data_t value;
+    // Operations that cannot be evaluated are left to the device which will
+    // report any error
+    if (can_fold && evaluateOperation(model, operation, value) ==
+                        ANEURALNETWORKS_NO_ERROR) {
+      VLOG_ENDL("Folding operation (code=" << operation.type
+                                           << ") to constant operand "
+                                           << operation.outputs[0]);
+      // Operations are sorted so later operations can use the new constant
+      setOwnedConstOperand(model, operation.outputs[0], std::move(value));
+    } else {
+      operations.push_back(std::move(operation));
+    }
+  }
+  model.operations = std::move(operations);
+  return ANEURALNETWORKS_NO_ERROR;
+}
@@ -0,0 +1,81 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/passes/passes.hpp"
+#include "common/macro.hpp"
+#include "common/passes/graph_utils.hpp"
+
+#include <unordered_map>
+
+namespace {
+
+/**
+ * Return the FuseCode equivalent to an activation operation or
+ * ANEURALNETWORKS_FUSED_NONE if the operation is not an activation.
+ */
+int32_t getActivationFuseCode(ANeuralNetworksOperationType type) {
+  switch (type) {
+    case ANEURALNETWORKS_RELU:
+      return ANEURALNETWORKS_FUSED_RELU;
+    case ANEURALNETWORKS_RELU1:
+      return ANEURALNETWORKS_FUSED_RELU1;
+    case ANEURALNETWORKS_RELU6:
+      return ANEURALNETWORKS_FUSED_RELU6;
+    default:
+      return ANEURALNETWORKS_FUSED_NONE;
+  }
+}
+
+}  // end namespace
+
+ResultCode fuseActivations(ANeuralNetworksModel& model) {
+  auto uses = countOperandUses(model);
+  std::unordered_map<uint32_t, std::size_t> producers;
+  std::vector<bool> fused(model.operations.size(), false);
+  for (std::size_t i = 0; i < model.operations.size(); ++i) {
+    auto& operation = model.operations[i];
+    for (auto output_idx : operation.outputs) {
+      producers[output_idx] = i;
+    }
+    auto activation = getActivationFuseCode(operation.type);
+    if (activation == ANEURALNETWORKS_FUSED_NONE ||
+        operation.inputs.size() != 1 || operation.outputs.size() != 1) {
+      continue;
+    }
+    // The intermediate operand disappears so it must not be used elsewhere
+    auto input_idx = operation.inputs[0];
+    auto producer_it = producers.find(input_idx);
+    if (producer_it == producers.end() || uses[input_idx] != 1 ||
+        isModelOutput(model, input_idx)) {
+      continue;
+    }
+    auto& producer = model.operations[producer_it->second];
+    int32_t fuse_code;
+    if (producer.outputs.size() != 1 ||
+        !readFuseCode(model, producer, fuse_code) ||
+        fuse_code != ANEURALNETWORKS_FUSED_NONE ||
+        !setFuseCode(model, producer, activation)) {
+      continue;
+    }
+    VLOG_ENDL("Fusing activation (code=" << operation.type
+                                         << ") in operation (code="
+                                         << producer.type << ")");
+    producer.outputs[0] = operation.outputs[0];
+    producers[operation.outputs[0]] = producer_it->second;
+    fused[i] = true;
+  }
+  removeOperations(model, fused);
+  return ANEURALNETWORKS_NO_ERROR;
+}
@@ -0,0 +1,158 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/passes/graph_utils.hpp"
+
+#include <algorithm>
+#include <utility>
+
+bool isConstOperand(const ANeuralNetworksModel& model, uint32_t idx) {
+  return model.const_host_operands.count(idx) ||
+         model.const_host_operands_owned.count(idx) ||
+         model.const_device_operands.count(idx);
+}
+
+bool isModelOutput(const ANeuralNetworksModel& model, uint32_t idx) {
+  return std::find(model.outputs.begin(), model.outputs.end(), idx) !=
+         model.outputs.end();
+}
+
+bool getConstHostOperand(const ANeuralNetworksModel& model, uint32_t idx,
+                         const void** data, std::size_t& length) {
+  auto owned_it = model.const_host_operands_owned.find(idx);
+  if (owned_it != model.const_host_operands_owned.end()) {
+    *data = owned_it->second.data();
+    length = owned_it->second.size();
+    return true;
+  }
+  auto it = model.const_host_operands.find(idx);
+  if (it != model.const_host_operands.end()) {
+    *data = it->second.data;
+    length = it->second.length;
+    return true;
+  }
+  return false;
+}
+
+void setOwnedConstOperand(ANeuralNetworksModel& model, uint32_t idx,
+                          ANeuralNetworksModel::owned_const_host_data data) {
+  model.const_host_operands.erase(idx);
+  model.const_device_operands.erase(idx);
+  model.const_host_operands_owned[idx] = std::move(data);
+}
+
+std::vector<uint32_t> countOperandUses(const ANeuralNetworksModel& model) {
+  std::vector<uint32_t> uses(model.operands.size(), 0);
+  for (const auto& operation : model.operations) {
+    for (auto input_idx : operation.inputs) {
+      ++uses[input_idx];
+    }
+  }
+  return uses;
+}
+
+int getFuseCodeInputIndex(ANeuralNetworksOperationType type) {
+  switch (type) {
+    case ANEURALNETWORKS_ADD:
+    case ANEURALNETWORKS_DIV:
+    case ANEURALNETWORKS_MAX:
+    case ANEURALNETWORKS_MIN:
+    case ANEURALNETWORKS_MUL:
+    case ANEURALNETWORKS_SUB:
+      return 2;
+
+    case ANEURALNETWORKS_AVERAGE_POOL_2D:
+    case ANEURALNETWORKS_MAX_POOL_2D:
+    case ANEURALNETWORKS_CONV_2D:
+      return 6;
+
+    case ANEURALNETWORKS_DEPTHWISE_CONV_2D:
+      return 7;
+
+    default:
+      return -1;
+  }
+}
+
+bool readFuseCode(const ANeuralNetworksModel& model,
+                  const ANeuralNetworksModel::Operation& operation,
+                  int32_t& fuse_code) {
+  int fuse_idx = getFuseCodeInputIndex(operation.type);
+  if (fuse_idx < 0) {
+    return false;
+  }
+  fuse_code = ANEURALNETWORKS_FUSED_NONE;
+  return readOptionalConstHostOperand(
+      model, operation, static_cast<uint32_t>(fuse_idx), fuse_code);
+}
+
+bool setFuseCode(ANeuralNetworksModel& model,
+                 ANeuralNetworksModel::Operation& operation,
+                 int32_t fuse_code) {
+  int fuse_idx = getFuseCodeInputIndex(operation.type);
+  if (fuse_idx < 0 ||
+      operation.inputs.size() < static_cast<std::size_t>(fuse_idx)) {
+    return false;
+  }
+  // The FuseCode operand may be shared with other operations so a new one is
+  // created
+  ANeuralNetworksOperandType fuse_type{ANEURALNETWORKS_INT32, 0, nullptr, 0.f,
+                                       0};
+  ANeuralNetworksModel::owned_const_host_data fuse_data(sizeof(fuse_code));
+  std::memcpy(fuse_data.data(), &fuse_code, sizeof(fuse_code));
+  auto fuse_op_idx =
+      addOwnedConstOperand(model, fuse_type, std::move(fuse_data));
+  auto ufuse_idx = static_cast<std::size_t>(fuse_idx);
+  if (ufuse_idx < operation.inputs.size()) {
+    operation.inputs[ufuse_idx] = fuse_op_idx;
+  } else {
+    operation.inputs.push_back(fuse_op_idx);
+  }
+  return true;
+}
+
+void removeOperations(ANeuralNetworksModel& model,
+                      const std::vector<bool>& removed) {
+  std::vector<ANeuralNetworksModel::Operation> operations;
+  operations.reserve(model.operations.size());
+  for (std::size_t i = 0; i < model.operations.size(); ++i) {
+    if (!removed[i]) {
+      operations.push_back(std::move(model.operations[i]));
+    }
+  }
+  model.operations = std::move(operations);
+}
+
+void setOperandDimensions(ANeuralNetworksModel& model, uint32_t idx,
+                          const std::vector<uint32_t>& dimensions) {
+  auto& internal_dims = model.operands_dimensions[idx];
+  internal_dims = dimensions;
+  model.operands[idx].dimensionCount =
+      static_cast<uint32_t>(internal_dims.size());
+  model.operands[idx].dimensions = internal_dims.data();
+}
+
+uint32_t addOwnedConstOperand(
+    ANeuralNetworksModel& model, const ANeuralNetworksOperandType& type,
+    ANeuralNetworksModel::owned_const_host_data data) {
+  auto idx = static_cast<uint32_t>(model.operands.size());
+  model.operands_dimensions.emplace_back(
+      type.dimensions, type.dimensions + type.dimensionCount);
+  ANeuralNetworksOperandType internal_type = type;
+  internal_type.dimensions = model.operands_dimensions.back().data();
+  model.operands.push_back(internal_type);
+  model.const_host_operands_owned[idx] = std::move(data);
+  return idx;
+}
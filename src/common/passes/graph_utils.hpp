@@ -0,0 +1,158 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef SRC_COMMON_PASSES_GRAPH_UTILS_HPP
+#define SRC_COMMON_PASSES_GRAPH_UTILS_HPP
+
+#include <bitset>
+#include <cstring>
+#include <vector>
+
+#include "common/model.hpp"
+
+/**
+ * Return true if the operand at index idx has a constant value.
+ */
+bool isConstOperand(const ANeuralNetworksModel& model, uint32_t idx);
+
+/**
+ * Return true if the operand at index idx is an identified output.
+ */
+bool isModelOutput(const ANeuralNetworksModel& model, uint32_t idx);
+
+/**
+ * Try to get a constant operand set from the host.
+ * Constants set from device memory are not read by the passes.
+ * Return whether a host constant exists at idx.
+ */
+bool getConstHostOperand(const ANeuralNetworksModel& model, uint32_t idx,
+                         const void** data, std::size_t& length);
+
+/**
+ * Try to read a scalar host constant at index idx.
+ */
+template <class T>
+bool readConstHostOperand(const ANeuralNetworksModel& model, uint32_t idx,
+                          T& value) {
+  const void* data;
+  std::size_t length;
+  if (!getConstHostOperand(model, idx, &data, length) || length != sizeof(T)) {
+    return false;
+  }
+  std::memcpy(&value, data, sizeof(T));
+  return true;
+}
+
+/**
+ * Try to read a vector host constant at index idx.
+ */
+template <class T>
+bool readConstHostOperand(const ANeuralNetworksModel& model, uint32_t idx,
+                          std::vector<T>& values) {
+  const void* data;
+  std::size_t length;
+  if (!getConstHostOperand(model, idx, &data, length)) {
+    return false;
+  }
+  auto typed_data = static_cast<const T*>(data);
+  values.assign(typed_data, typed_data + (length / sizeof(T)));
+  return true;
+}
+
+/**
+ * Try to read a bitset host constant at index idx.
+ */
+inline bool readConstHostOperand(const ANeuralNetworksModel& model,
+                                 uint32_t idx, std::bitset<32>& values) {
+  int32_t value;
+  if (!readConstHostOperand(model, idx, value)) {
+    return false;
+  }
+  values = std::bitset<32>(static_cast<unsigned long long>(value));
+  return true;
+}
+
+/**
+ * Try to read an optional input of an operation.
+ * value is unchanged and true is returned if the input is not provided.
+ */
+template <class T>
+bool readOptionalConstHostOperand(
+    const ANeuralNetworksModel& model,
+    const ANeuralNetworksModel::Operation& operation, uint32_t idx, T& value) {
+  if (idx >= operation.inputs.size()) {
+    return true;
+  }
+  return readConstHostOperand(model, operation.inputs[idx], value);
+}
+
+/**
+ * Return the number of times each operand is used as an input of an
+ * operation, indexed by operand index.
+ */
+std::vector<uint32_t> countOperandUses(const ANeuralNetworksModel& model);
+
+/**
+ * Return the index of the FuseCode input of an operation type or -1 if the
+ * operation does not have one.
+ */
+int getFuseCodeInputIndex(ANeuralNetworksOperationType type);
+
+/**
+ * Read the FuseCode of an operation, the value is ANEURALNETWORKS_FUSED_NONE
+ * if the optional input is not provided.
+ * Return false if the operation does not have a FuseCode or if it is not a
+ * host constant.
+ */
+bool readFuseCode(const ANeuralNetworksModel& model,
+                  const ANeuralNetworksModel::Operation& operation,
+                  int32_t& fuse_code);
+
+/**
+ * Set the FuseCode of an operation to a new constant operand.
+ * Return false if the operation does not have a FuseCode or if a previous
+ * optional input is missing.
+ */
+bool setFuseCode(ANeuralNetworksModel& model,
+                 ANeuralNetworksModel::Operation& operation, int32_t fuse_code);
+
+/**
+ * Remove the operations for which removed is true, keeping the order of the
+ * other operations.
+ */
+void removeOperations(ANeuralNetworksModel& model,
+                      const std::vector<bool>& removed);
+
+/**
+ * Set the dimensions of an operand.
+ */
+void setOperandDimensions(ANeuralNetworksModel& model, uint32_t idx,
+                          const std::vector<uint32_t>& dimensions);
+
+/**
+ * Add a new operand whose value is owned by the model and return its index.
+ */
+uint32_t addOwnedConstOperand(ANeuralNetworksModel& model,
+                              const ANeuralNetworksOperandType& type,
+                              ANeuralNetworksModel::owned_const_host_data data);
+
+/**
+ * Set the value of an operand to data owned by the model.
+ * Any previous value is replaced.
+ */
+void setOwnedConstOperand(ANeuralNetworksModel& model, uint32_t idx,
+                          ANeuralNetworksModel::owned_const_host_data data);
+
+#endif  // SRC_COMMON_PASSES_GRAPH_UTILS_HPP
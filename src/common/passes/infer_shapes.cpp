@@ -0,0 +1,36 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/passes/passes.hpp"
+#include "common/macro.hpp"
+#include "common/passes/graph_utils.hpp"
+#include "common/shape_inference.hpp"
+
+ResultCode inferOperandShapes(ANeuralNetworksModel& model) {
+  for (auto input_idx : model.inputs) {
+    if (!isShapeKnown(getOperandShape(model.operands[input_idx]))) {
+      // Shapes are inferred once the input shapes are known
+      return ANEURALNETWORKS_NO_ERROR;
+    }
+  }
+  std::vector<Shape> shapes;
+  TENSOROPT_RETURN_IF_ERROR(inferShapes(model, {}, shapes));
+  for (uint32_t i = 0; i < model.operands.size(); ++i) {
+    if (!isShapeKnown(getOperandShape(model.operands[i]))) {
+      setOperandDimensions(model, i, shapes[i]);
+    }
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
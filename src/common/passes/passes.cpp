@@ -0,0 +1,31 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/passes/passes.hpp"
+#include "common/macro.hpp"
+
+ResultCode optimizeModel(ANeuralNetworksModel& model) {
+  TENSOROPT_RETURN_IF_ERROR(sortOperations(model));
+  TENSOROPT_RETURN_IF_ERROR(inferOperandShapes(model));
+  TENSOROPT_RETURN_IF_ERROR(foldConstants(model));
+  TENSOROPT_RETURN_IF_ERROR(collapseReshapes(model));
+  TENSOROPT_RETURN_IF_ERROR(eliminateCommonSubexpressions(model));
+  TENSOROPT_RETURN_IF_ERROR(eliminateDeadOperations(model));
+  TENSOROPT_RETURN_IF_ERROR(foldChannelOperations(model));
+  TENSOROPT_RETURN_IF_ERROR(fuseActivations(model));
+  // Remove the constants replaced by the previous passes
+  TENSOROPT_RETURN_IF_ERROR(eliminateDeadOperations(model));
+  return ANEURALNETWORKS_NO_ERROR;
+}
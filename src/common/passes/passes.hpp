@@ -0,0 +1,91 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef SRC_COMMON_PASSES_PASSES_HPP
+#define SRC_COMMON_PASSES_PASSES_HPP
+
+#include "common/model.hpp"
+
+/**
+ * Run all the passes on a model before it is converted to a backend network.
+ * The model must be a copy owned by the compilation as it is modified in
+ * place.
+ */
+ResultCode optimizeModel(ANeuralNetworksModel& model);
+
+/**
+ * Sort the operations so that each operation is after the operations producing
+ * its inputs. The order of independent operations is kept.
+ * Return ANEURALNETWORKS_BAD_DATA if the graph has a cycle, if an operand is
+ * the output of multiple operations or if an operand is used but is neither
+ * an input, a constant nor the output of an operation.
+ */
+ResultCode sortOperations(ANeuralNetworksModel& model);
+
+/**
+ * Check the declared shapes of the operands against the inferred shapes and
+ * set the unknown dimensions. Nothing is done if the shape of an input of the
+ * model is unknown.
+ * The operations must be sorted.
+ */
+ResultCode inferOperandShapes(ANeuralNetworksModel& model);
+
+/**
+ * Evaluate on the host the operations whose inputs are all host constants.
+ * Their outputs become constants owned by the model.
+ * The operations must be sorted.
+ */
+ResultCode foldConstants(ANeuralNetworksModel& model);
+
+/**
+ * Remove the operations which do not contribute to an output of the model and
+ * the constants which are not used anymore.
+ * The operations must be sorted.
+ */
+ResultCode eliminateDeadOperations(ANeuralNetworksModel& model);
+
+/**
+ * Merge the operations of the same type with the same inputs. Constant inputs
+ * are compared by value if they are small.
+ * The operations must be sorted.
+ */
+ResultCode eliminateCommonSubexpressions(ANeuralNetworksModel& model);
+
+/**
+ * Apply a RESHAPE following a chain of RESHAPE and SQUEEZE operations to the
+ * input of the chain and remove the reshapes which keep the same shape.
+ * The reshapes left without uses are removed by eliminateDeadOperations.
+ * The operations must be sorted and the shapes inferred.
+ */
+ResultCode collapseReshapes(ANeuralNetworksModel& model);
+
+/**
+ * Fold a MUL or ADD following a convolution into the filter and bias of the
+ * convolution if the other operand is a host constant with one value per
+ * channel. This is the pattern left by batch normalizations.
+ * The operations must be sorted.
+ */
+ResultCode foldChannelOperations(ANeuralNetworksModel& model);
+
+/**
+ * Merge RELU, RELU1 and RELU6 operations into the FuseCode of the operation
+ * producing their input if it is their only use. This only removes operations
+ * from the model, the backend may still apply the FuseCode as a separate
+ * operation.
+ * The operations must be sorted.
+ */
+ResultCode fuseActivations(ANeuralNetworksModel& model);
+
+#endif  // SRC_COMMON_PASSES_PASSES_HPP
@@ -0,0 +1,129 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/passes/passes.hpp"
+#include "common/macro.hpp"
+#include "common/passes/graph_utils.hpp"
+
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+
+ResultCode sortOperations(ANeuralNetworksModel& model) {
+  const auto nb_operations = static_cast<uint32_t>(model.operations.size());
+  const auto nb_operands = static_cast<uint32_t>(model.operands.size());
+
+  // Index of the operation producing each operand
+  std::unordered_map<uint32_t, uint32_t> producers;
+  for (uint32_t op_idx = 0; op_idx < nb_operations; ++op_idx) {
+    for (auto output_idx : model.operations[op_idx].outputs) {
+      TENSOROPT_RETURN_IF_COND(output_idx >= nb_operands,
+                               "Error: operation #"
+                                   << op_idx << " has an invalid output index "
+                                   << output_idx,
+                               ANEURALNETWORKS_BAD_DATA);
+      auto p = producers.emplace(output_idx, op_idx);
+      TENSOROPT_RETURN_IF_COND(!p.second,
+                               "Error: operand "
+                                   << output_idx
+                                   << " is the output of operations #"
+                                   << p.first->second << " and #" << op_idx,
+                               ANEURALNETWORKS_BAD_DATA);
+    }
+  }
+
+  std::unordered_set<uint32_t> model_inputs(model.inputs.begin(),
+                                            model.inputs.end());
+  auto is_source = [&](uint32_t idx) {
+    return model_inputs.count(idx) || isConstOperand(model, idx);
+  };
+
+  // Number of inputs of each operation that are not computed yet and
+  // operations using the outputs of each operation
+  std::vector<uint32_t> nb_pending_inputs(nb_operations, 0);
+  std::vector<std::vector<uint32_t>> consumers(nb_operations);
+  for (uint32_t op_idx = 0; op_idx < nb_operations; ++op_idx) {
+    for (auto input_idx : model.operations[op_idx].inputs) {
+      TENSOROPT_RETURN_IF_COND(input_idx >= nb_operands,
+                               "Error: operation #"
+                                   << op_idx << " has an invalid input index "
+                                   << input_idx,
+                               ANEURALNETWORKS_BAD_DATA);
+      auto it = producers.find(input_idx);
+      if (it != producers.end()) {
+        ++nb_pending_inputs[op_idx];
+        consumers[it->second].push_back(op_idx);
+      } else {
+        TENSOROPT_RETURN_IF_COND(!is_source(input_idx),
+                                 "Error: input operand "
+                                     << input_idx << " of operation #"
+                                     << op_idx
+                                     << " is not an input of the model, a "
+                                        "constant or the output of an "
+                                        "operation",
+                                 ANEURALNETWORKS_BAD_DATA);
+      }
+    }
+  }
+  for (auto output_idx : model.outputs) {
+    TENSOROPT_RETURN_IF_COND(
+        !producers.count(output_idx) && !is_source(output_idx),
+        "Error: output operand " << output_idx
+                                 << " of the model is never computed",
+        ANEURALNETWORKS_BAD_DATA);
+  }
+
+  // Kahn's algorithm picking the ready operation with the smallest index so
+  // that a model already in execution order is not modified.
+  std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>>
+      ready;
+  for (uint32_t op_idx = 0; op_idx < nb_operations; ++op_idx) {
+    if (nb_pending_inputs[op_idx] == 0) {
+      ready.push(op_idx);
+    }
+  }
+  std::vector<uint32_t> order;
+  order.reserve(nb_operations);
+  while (!ready.empty()) {
+    auto op_idx = ready.top();
+    ready.pop();
+    order.push_back(op_idx);
+    for (auto consumer_idx : consumers[op_idx]) {
+      if (--nb_pending_inputs[consumer_idx] == 0) {
+        ready.push(consumer_idx);
+      }
+    }
+  }
+
+  if (order.size() != nb_operations) {
+    for (uint32_t op_idx = 0; op_idx < nb_operations; ++op_idx) {
+      TENSOROPT_RETURN_IF_COND(nb_pending_inputs[op_idx] > 0,
+                               "Error: operation #"
+                                   << op_idx << " (code="
+                                   << model.operations[op_idx].type
+                                   << ") is part of or depends on a cycle",
+                               ANEURALNETWORKS_BAD_DATA);
+    }
+  }
+
+  std::vector<ANeuralNetworksModel::Operation> sorted_operations;
+  sorted_operations.reserve(nb_operations);
+  for (auto op_idx : order) {
+    sorted_operations.push_back(std::move(model.operations[op_idx]));
+  }
+  model.operations = std::move(sorted_operations);
+  return ANEURALNETWORKS_NO_ERROR;
+}
@@ -0,0 +1,160 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/sha256.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr std::array<uint32_t, 64> ROUND_CONSTANTS{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+inline uint32_t rotateRight(uint32_t x, unsigned n) {
+  return (x >> n) | (x << (32 - n));
+}
+
+}  // end namespace
+
+constexpr std::size_t Sha256::DIGEST_SIZE;
+constexpr std::size_t Sha256::BLOCK_SIZE;
+
+Sha256::Sha256()
+    : state{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f,
+            0x9b05688c, 0x1f83d9ab, 0x5be0cd19},
+      buffer(),
+      buffer_size(0),
+      total_length(0) {}
+
+void Sha256::update(const void* data, std::size_t length) {
+  auto bytes = static_cast<const uint8_t*>(data);
+  total_length += length;
+  // Complete the pending block first
+  if (buffer_size > 0) {
+    std::size_t copy_size = std::min(length, BLOCK_SIZE - buffer_size);
+    std::memcpy(buffer.data() + buffer_size, bytes, copy_size);
+    buffer_size += copy_size;
+    bytes += copy_size;
+    length -= copy_size;
+    if (buffer_size < BLOCK_SIZE) {
+      return;
+    }
+    processBlock(buffer.data());
+    buffer_size = 0;
+  }
+  // Process full blocks directly from the input
+  while (length >= BLOCK_SIZE) {
+    processBlock(bytes);
+    bytes += BLOCK_SIZE;
+    length -= BLOCK_SIZE;
+  }
+  std::memcpy(buffer.data(), bytes, length);
+  buffer_size = length;
+}
+
+void Sha256::updateU32(uint32_t value) {
+  uint8_t bytes[4] = {static_cast<uint8_t>(value),
+                      static_cast<uint8_t>(value >> 8),
+                      static_cast<uint8_t>(value >> 16),
+                      static_cast<uint8_t>(value >> 24)};
+  update(bytes, sizeof(bytes));
+}
+
+Sha256::digest_t Sha256::digest() const {
+  // Pad a copy so that more data can still be added to this hasher
+  Sha256 padded(*this);
+  uint64_t bit_length = total_length * 8;
+  static constexpr uint8_t PADDING_START = 0x80;
+  static constexpr uint8_t ZERO = 0;
+  padded.update(&PADDING_START, 1);
+  while (padded.buffer_size != BLOCK_SIZE - sizeof(bit_length)) {
+    padded.update(&ZERO, 1);
+  }
+  uint8_t length_bytes[sizeof(bit_length)];
+  for (unsigned i = 0; i < sizeof(bit_length); ++i) {
+    length_bytes[i] = static_cast<uint8_t>(bit_length >> (56 - 8 * i));
+  }
+  padded.update(length_bytes, sizeof(length_bytes));
+
+  digest_t res;
+  for (unsigned i = 0; i < padded.state.size(); ++i) {
+    res[4 * i] = static_cast<uint8_t>(padded.state[i] >> 24);
+    res[4 * i + 1] = static_cast<uint8_t>(padded.state[i] >> 16);
+    res[4 * i + 2] = static_cast<uint8_t>(padded.state[i] >> 8);
+    res[4 * i + 3] = static_cast<uint8_t>(padded.state[i]);
+  }
+  return res;
+}
+
+void Sha256::processBlock(const uint8_t* block) {
+  std::array<uint32_t, 64> w;
+  for (unsigned i = 0; i < 16; ++i) {
+    w[i] = (static_cast<uint32_t>(block[4 * i]) << 24) |
+           (static_cast<uint32_t>(block[4 * i + 1]) << 16) |
+           (static_cast<uint32_t>(block[4 * i + 2]) << 8) |
+           static_cast<uint32_t>(block[4 * i + 3]);
+  }
+  for (unsigned i = 16; i < 64; ++i) {
+    uint32_t s0 = rotateRight(w[i - 15], 7) ^ rotateRight(w[i - 15], 18) ^
+                  (w[i - 15] >> 3);
+    uint32_t s1 = rotateRight(w[i - 2], 17) ^ rotateRight(w[i - 2], 19) ^
+                  (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  uint32_t a = state[0];
+  uint32_t b = state[1];
+  uint32_t c = state[2];
+  uint32_t d = state[3];
+  uint32_t e = state[4];
+  uint32_t f = state[5];
+  uint32_t g = state[6];
+  uint32_t h = state[7];
+  for (unsigned i = 0; i < 64; ++i) {
+    uint32_t s1 = rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25);
+    uint32_t ch = (e & f) ^ (~e & g);
+    uint32_t tmp1 = h + s1 + ch + ROUND_CONSTANTS[i] + w[i];
+    uint32_t s0 = rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22);
+    uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+    uint32_t tmp2 = s0 + maj;
+    h = g;
+    g = f;
+    f = e;
+    e = d + tmp1;
+    d = c;
+    c = b;
+    b = a;
+    a = tmp1 + tmp2;
+  }
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
+}
@@ -0,0 +1,55 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef SRC_COMMON_SHA256_HPP
+#define SRC_COMMON_SHA256_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Incremental SHA-256 hasher.
+ * Data can be added with update at any time, digest returns the hash of all
+ * the data added so far without modifying the state.
+ */
+struct Sha256 {
+  static constexpr std::size_t DIGEST_SIZE = 32;
+  using digest_t = std::array<uint8_t, DIGEST_SIZE>;
+
+  Sha256();
+
+  void update(const void* data, std::size_t length);
+
+  /**
+   * Add an integer in little-endian order so that the hash does not depend on
+   * the host.
+   */
+  void updateU32(uint32_t value);
+
+  digest_t digest() const;
+
+ private:
+  static constexpr std::size_t BLOCK_SIZE = 64;
+
+  void processBlock(const uint8_t* block);
+
+  std::array<uint32_t, 8> state;
+  std::array<uint8_t, BLOCK_SIZE> buffer;
+  std::size_t buffer_size;
+  uint64_t total_length;
+};
+
+#endif  // SRC_COMMON_SHA256_HPP
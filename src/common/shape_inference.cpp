@@ -0,0 +1,618 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/shape_inference.hpp"
+#include "common/macro.hpp"
+#include "common/passes/graph_utils.hpp"
+#include "common/slice_bounds.hpp"
+#include "common/utils.hpp"
+
+#include <algorithm>
+#include <bitset>
+
+namespace {
+
+using Operation = ANeuralNetworksModel::Operation;
+
+/**
+ * Read a constant parameter of the operation.
+ */
+template <class T>
+ResultCode readParam(const ANeuralNetworksModel& model,
+                     const Operation& operation, uint32_t idx, T& value) {
+  TENSOROPT_RETURN_IF_COND(idx >= operation.inputs.size(),
+                           "Error: missing input " << idx << " for operation "
+                                                   << operation.type,
+                           ANEURALNETWORKS_BAD_DATA);
+  TENSOROPT_RETURN_IF_COND(
+      !readConstHostOperand(model, operation.inputs[idx], value),
+      "Error: input " << idx << " of operation " << operation.type
+                      << " is not a host constant",
+      ANEURALNETWORKS_OP_FAILED);
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+/**
+ * Read a constant parameter of the operation if it is provided.
+ */
+template <class T>
+ResultCode readOptionalParam(const ANeuralNetworksModel& model,
+                             const Operation& operation, uint32_t idx,
+                             T& value) {
+  if (idx < operation.inputs.size()) {
+    TENSOROPT_RETURN_IF_ERROR(readParam(model, operation, idx, value));
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+/**
+ * Convert a possibly negative axis to an index in [0, rank).
+ */
+ResultCode getAxis(int32_t axis, std::size_t rank, std::size_t& res) {
+  auto srank = static_cast<int32_t>(rank);
+  TENSOROPT_RETURN_IF_COND(axis < -srank || axis >= srank,
+                           "Error: invalid axis " << axis << " for rank "
+                                                  << rank,
+                           ANEURALNETWORKS_BAD_DATA);
+  res = static_cast<std::size_t>(axis < 0 ? axis + srank : axis);
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode checkRank(const Shape& shape, std::size_t rank) {
+  TENSOROPT_RETURN_IF_COND(shape.size() != rank,
+                           "Error: expected an input of rank "
+                               << rank << " but got " << shape.size(),
+                           ANEURALNETWORKS_BAD_DATA);
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode inferBroadcast(const Shape& lhs, const Shape& rhs, Shape& out) {
+  out.assign(std::max(lhs.size(), rhs.size()), 1);
+  auto lhs_offset = out.size() - lhs.size();
+  auto rhs_offset = out.size() - rhs.size();
+  for (std::size_t i = 0; i < out.size(); ++i) {
+    uint32_t lhs_dim = i < lhs_offset ? 1 : lhs[i - lhs_offset];
+    uint32_t rhs_dim = i < rhs_offset ? 1 : rhs[i - rhs_offset];
+    TENSOROPT_RETURN_IF_COND(
+        lhs_dim != rhs_dim && lhs_dim != 1 && rhs_dim != 1,
+        "Error: cannot broadcast dimensions " << lhs_dim << " and " << rhs_dim,
+        ANEURALNETWORKS_BAD_DATA);
+    out[i] = lhs_dim == 1 ? rhs_dim : lhs_dim;
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+/**
+ * Compute the output size of a window sliding along one dimension.
+ */
+ResultCode inferWindowSize(int32_t padding_code, uint32_t input,
+                           int32_t filter, int32_t stride, int32_t dilation,
+                           uint32_t& output) {
+  TENSOROPT_RETURN_IF_COND(filter <= 0 || stride <= 0 || dilation <= 0,
+                           "Error: invalid filter " << filter << ", stride "
+                                                    << stride << " or dilation "
+                                                    << dilation,
+                           ANEURALNETWORKS_BAD_DATA);
+  auto ustride = static_cast<uint32_t>(stride);
+  auto effective_filter =
+      static_cast<uint32_t>((filter - 1) * dilation + 1);
+  if (padding_code == ANEURALNETWORKS_PADDING_SAME) {
+    output = roundRatioUp(input, ustride);
+  } else if (padding_code == ANEURALNETWORKS_PADDING_VALID) {
+    TENSOROPT_RETURN_IF_COND(effective_filter > input,
+                             "Error: filter of size "
+                                 << effective_filter
+                                 << " is bigger than input " << input,
+                             ANEURALNETWORKS_BAD_DATA);
+    output = (input - effective_filter) / ustride + 1;
+  } else {
+    VLOG_AT("Error: unknown padding " << padding_code);
+    return ANEURALNETWORKS_BAD_DATA;
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+/**
+ * Build the NHWC or NCHW output shape of a 2D window operation.
+ */
+ResultCode inferWindowShape(const Shape& input, bool is_nchw, uint32_t channels,
+                            int32_t padding_code, int32_t filter_h,
+                            int32_t filter_w, int32_t stride_h,
+                            int32_t stride_w, int32_t dilation_h,
+                            int32_t dilation_w, Shape& out) {
+  TENSOROPT_RETURN_IF_ERROR(checkRank(input, 4));
+  std::size_t h_axis = is_nchw ? 2 : 1;
+  out = input;
+  TENSOROPT_RETURN_IF_ERROR(inferWindowSize(padding_code, input[h_axis],
+                                            filter_h, stride_h, dilation_h,
+                                            out[h_axis]));
+  TENSOROPT_RETURN_IF_ERROR(inferWindowSize(padding_code, input[h_axis + 1],
+                                            filter_w, stride_w, dilation_w,
+                                            out[h_axis + 1]));
+  out[is_nchw ? 1 : 3] = channels;
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode inferPool(const ANeuralNetworksModel& model,
+                     const Operation& operation, const Shape& input,
+                     Shape& out) {
+  int32_t padding_code;
+  int32_t stride_w;
+  int32_t stride_h;
+  int32_t filter_w;
+  int32_t filter_h;
+  bool is_nchw = false;
+  TENSOROPT_RETURN_IF_ERROR(readParam(model, operation, 1, padding_code));
+  TENSOROPT_RETURN_IF_ERROR(readParam(model, operation, 2, stride_w));
+  TENSOROPT_RETURN_IF_ERROR(readParam(model, operation, 3, stride_h));
+  TENSOROPT_RETURN_IF_ERROR(readParam(model, operation, 4, filter_w));
+  TENSOROPT_RETURN_IF_ERROR(readParam(model, operation, 5, filter_h));
+  TENSOROPT_RETURN_IF_ERROR(readOptionalParam(model, operation, 7, is_nchw));
+  TENSOROPT_RETURN_IF_ERROR(checkRank(input, 4));
+  return inferWindowShape(input, is_nchw, input[is_nchw ? 1 : 3], padding_code,
+                          filter_h, filter_w, stride_h, stride_w, 1, 1, out);
+}
+
+ResultCode inferConv(const ANeuralNetworksModel& model,
+                     const Operation& operation, const Shape& input,
+                     const Shape& filter, Shape& out) {
+  uint32_t fuse_idx =
+      operation.type == ANEURALNETWORKS_DEPTHWISE_CONV_2D ? 7 : 6;
+  int32_t padding_code;
+  int32_t stride_w;
+  int32_t stride_h;
+  bool is_nchw = false;
+  bool is_filter_hwio = false;
+  int32_t dilation_w = 1;
+  int32_t dilation_h = 1;
+  TENSOROPT_RETURN_IF_ERROR(readParam(model, operation, 3, padding_code));
+  TENSOROPT_RETURN_IF_ERROR(readParam(model, operation, 4, stride_w));
+  TENSOROPT_RETURN_IF_ERROR(readParam(model, operation, 5, stride_h));
+  TENSOROPT_RETURN_IF_ERROR(
+      readOptionalParam(model, operation, fuse_idx + 1, is_nchw));
+  TENSOROPT_RETURN_IF_ERROR(
+      readOptionalParam(model, operation, fuse_idx + 2, is_filter_hwio));
+  TENSOROPT_RETURN_IF_ERROR(
+      readOptionalParam(model, operation, fuse_idx + 3, dilation_w));
+  TENSOROPT_RETURN_IF_ERROR(
+      readOptionalParam(model, operation, fuse_idx + 4, dilation_h));
+  TENSOROPT_RETURN_IF_ERROR(checkRank(input, 4));
+  TENSOROPT_RETURN_IF_ERROR(checkRank(filter, 4));
+  // Filters are in OHWI or HWIO format
+  std::size_t filter_h_axis = is_filter_hwio ? 0 : 1;
+  uint32_t channels = filter[is_filter_hwio ? 3 : 0];
+  if (operation.type == ANEURALNETWORKS_CONV_2D) {
+    auto input_channels = input[is_nchw ? 1 : 3];
+    auto filter_channels = filter[is_filter_hwio ? 2 : 3];
+    TENSOROPT_RETURN_IF_COND(input_channels != filter_channels,
+                             "Error: input has " << input_channels
+                                                 << " channels but filter has "
+                                                 << filter_channels,
+                             ANEURALNETWORKS_BAD_DATA);
+  }
+  return inferWindowShape(
+      input, is_nchw, channels, padding_code,
+      static_cast<int32_t>(filter[filter_h_axis]),
+      static_cast<int32_t>(filter[filter_h_axis + 1]), stride_h, stride_w,
+      dilation_h, dilation_w, out);
+}
+
+ResultCode inferMatmul(const ANeuralNetworksModel& model,
+                       const Operation& operation, const Shape& lhs,
+                       const Shape& rhs, Shape& out) {
+  bool lhs_t;
+  bool rhs_t;
+  TENSOROPT_RETURN_IF_ERROR(readParam(model, operation, 2, lhs_t));
+  TENSOROPT_RETURN_IF_ERROR(readParam(model, operation, 3, rhs_t));
+  TENSOROPT_RETURN_IF_ERROR(checkRank(lhs, 2));
+  TENSOROPT_RETURN_IF_ERROR(checkRank(rhs, 2));
+  auto lhs_k = lhs[lhs_t ? 0 : 1];
+  auto rhs_k = rhs[rhs_t ? 1 : 0];
+  TENSOROPT_RETURN_IF_COND(lhs_k != rhs_k,
+                           "Error: matmul inner dimensions " << lhs_k << " and "
+                                                             << rhs_k
+                                                             << " differ",
+                           ANEURALNETWORKS_BAD_DATA);
+  out = {lhs[lhs_t ? 1 : 0], rhs[rhs_t ? 0 : 1]};
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode inferReshape(const ANeuralNetworksModel& model,
+                        const Operation& operation, const Shape& input,
+                        Shape& out) {
+  std::vector<int32_t> new_shape;
+  TENSOROPT_RETURN_IF_ERROR(readParam(model, operation, 1, new_shape));
+  uint32_t input_size = 1;
+  for (auto dim : input) {
+    input_size *= dim;
+  }
+  uint32_t known_size = 1;
+  std::size_t unknown_axis = new_shape.size();
+  out.resize(new_shape.size());
+  for (std::size_t i = 0; i < new_shape.size(); ++i) {
+    if (new_shape[i] == -1 && unknown_axis == new_shape.size()) {
+      unknown_axis = i;
+      continue;
+    }
+    TENSOROPT_RETURN_IF_COND(new_shape[i] <= 0,
+                             "Error: invalid reshape dimension "
+                                 << new_shape[i],
+                             ANEURALNETWORKS_BAD_DATA);
+    out[i] = static_cast<uint32_t>(new_shape[i]);
+    known_size *= out[i];
+  }
+  if (unknown_axis < new_shape.size()) {
+    out[unknown_axis] = input_size / known_size;
+    known_size *= out[unknown_axis];
+  }
+  TENSOROPT_RETURN_IF_COND(known_size != input_size,
+                           "Error: cannot reshape " << input_size
+                                                    << " elements to "
+                                                    << known_size,
+                           ANEURALNETWORKS_BAD_DATA);
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode inferSqueeze(const ANeuralNetworksModel& model,
+                        const Operation& operation, const Shape& input,
+                        Shape& out) {
+  std::vector<int32_t> axes;
+  TENSOROPT_RETURN_IF_ERROR(readOptionalParam(model, operation, 1, axes));
+  std::vector<bool> squeezable(input.size(), axes.empty());
+  for (auto axis : axes) {
+    std::size_t uaxis;
+    TENSOROPT_RETURN_IF_ERROR(getAxis(axis, input.size(), uaxis));
+    squeezable[uaxis] = true;
+  }
+  out.clear();
+  for (std::size_t i = 0; i < input.size(); ++i) {
+    if (!squeezable[i] || input[i] != 1) {
+      out.push_back(input[i]);
+    }
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode inferConcat(const ANeuralNetworksModel& model,
+                       const Operation& operation,
+                       const std::vector<Shape>& inputs, Shape& out) {
+  TENSOROPT_RETURN_IF_COND(inputs.size() < 2,
+                           "Error: concatenation needs at least one input",
+                           ANEURALNETWORKS_BAD_DATA);
+  auto nb_tensors = static_cast<uint32_t>(inputs.size() - 1);
+  int32_t axis;
+  TENSOROPT_RETURN_IF_ERROR(readParam(model, operation, nb_tensors, axis));
+  std::size_t uaxis;
+  TENSOROPT_RETURN_IF_ERROR(getAxis(axis, inputs[0].size(), uaxis));
+  out = inputs[0];
+  for (uint32_t i = 1; i < nb_tensors; ++i) {
+    const auto& input = inputs[i];
+    TENSOROPT_RETURN_IF_ERROR(checkRank(input, out.size()));
+    for (std::size_t d = 0; d < out.size(); ++d) {
+      if (d == uaxis) {
+        out[d] += input[d];
+      } else {
+        TENSOROPT_RETURN_IF_COND(out[d] != input[d],
+                                 "Error: cannot concatenate dimensions "
+                                     << out[d] << " and " << input[d],
+                                 ANEURALNETWORKS_BAD_DATA);
+      }
+    }
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+/**
+ * Compute the size of each dimension of a sub-tensor.
+ */
+ResultCode getSliceShape(const Shape& input, const SliceBounds& bounds,
+                         Shape& out) {
+  out.resize(input.size());
+  for (std::size_t i = 0; i < input.size(); ++i) {
+    TENSOROPT_RETURN_IF_COND(bounds.starts[i] > bounds.ends[i] ||
+                                 bounds.ends[i] >= input[i],
+                             "Error: invalid bounds [" << bounds.starts[i]
+                                                       << ", " << bounds.ends[i]
+                                                       << "] for dimension "
+                                                       << input[i],
+                             ANEURALNETWORKS_BAD_DATA);
+    out[i] = static_cast<uint32_t>((bounds.ends[i] - bounds.starts[i]) /
+                                       bounds.strides[i] +
+                                   1);
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ANeuralNetworksOperandType getOperandType(ANeuralNetworksOperandCode type,
+                                          const Shape& shape) {
+  return {type, static_cast<uint32_t>(shape.size()), shape.data(), 0.f, 0};
+}
+
+ResultCode inferSlice(const ANeuralNetworksModel& model,
+                      const Operation& operation, const Shape& input,
+                      Shape& out) {
+  std::vector<int32_t> begins;
+  std::vector<int32_t> sizes;
+  TENSOROPT_RETURN_IF_ERROR(readParam(model, operation, 1, begins));
+  TENSOROPT_RETURN_IF_ERROR(readParam(model, operation, 2, sizes));
+  const auto& input_op = model.operands[operation.inputs[0]];
+  SliceBounds bounds;
+  TENSOROPT_RETURN_IF_COND(
+      getSliceBounds(getOperandType(input_op.type, input), begins, sizes,
+                     bounds) != ANEURALNETWORKS_NO_ERROR,
+      "Error: invalid slice parameters", ANEURALNETWORKS_BAD_DATA);
+  return getSliceShape(input, bounds, out);
+}
+
+ResultCode inferStridedSlice(const ANeuralNetworksModel& model,
+                             const Operation& operation, const Shape& input,
+                             Shape& out) {
+  std::vector<int32_t> begins;
+  std::vector<int32_t> ends;
+  std::vector<int32_t> strides;
+  std::bitset<32> begin_mask;
+  std::bitset<32> end_mask;
+  std::bitset<32> shrink_axis_mask;
+  std::bitset<32> ellipsis_mask;
+  std::bitset<32> new_axis_mask;
+  TENSOROPT_RETURN_IF_ERROR(readParam(model, operation, 1, begins));
+  TENSOROPT_RETURN_IF_ERROR(readParam(model, operation, 2, ends));
+  TENSOROPT_RETURN_IF_ERROR(readParam(model, operation, 3, strides));
+  TENSOROPT_RETURN_IF_ERROR(readOptionalParam(model, operation, 4, begin_mask));
+  TENSOROPT_RETURN_IF_ERROR(readOptionalParam(model, operation, 5, end_mask));
+  TENSOROPT_RETURN_IF_ERROR(
+      readOptionalParam(model, operation, 6, shrink_axis_mask));
+  TENSOROPT_RETURN_IF_ERROR(
+      readOptionalParam(model, operation, 7, ellipsis_mask));
+  TENSOROPT_RETURN_IF_ERROR(
+      readOptionalParam(model, operation, 8, new_axis_mask));
+  const auto& input_op = model.operands[operation.inputs[0]];
+  SliceBounds bounds;
+  TENSOROPT_RETURN_IF_COND(
+      getStridedSliceBounds(getOperandType(input_op.type, input), begins, ends,
+                            strides, begin_mask, end_mask, shrink_axis_mask,
+                            ellipsis_mask, bounds) != ANEURALNETWORKS_NO_ERROR,
+      "Error: invalid strided slice parameters", ANEURALNETWORKS_BAD_DATA);
+  Shape slice_shape;
+  TENSOROPT_RETURN_IF_ERROR(getSliceShape(input, bounds, slice_shape));
+  // Shrunk axes are removed and new axes of size 1 are inserted
+  out.clear();
+  for (std::size_t i = 0; i < slice_shape.size(); ++i) {
+    while (out.size() < new_axis_mask.size() && new_axis_mask[out.size()]) {
+      out.push_back(1);
+    }
+    if (!shrink_axis_mask[i]) {
+      out.push_back(slice_shape[i]);
+    }
+  }
+  while (out.size() < new_axis_mask.size() && new_axis_mask[out.size()]) {
+    out.push_back(1);
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode inferTranspose(const ANeuralNetworksModel& model,
+                          const Operation& operation, const Shape& input,
+                          Shape& out) {
+  std::vector<int32_t> perms;
+  TENSOROPT_RETURN_IF_ERROR(readParam(model, operation, 1, perms));
+  TENSOROPT_RETURN_IF_ERROR(checkRank(input, perms.size()));
+  out.resize(perms.size());
+  for (std::size_t i = 0; i < perms.size(); ++i) {
+    TENSOROPT_RETURN_IF_COND(
+        perms[i] < 0 || static_cast<std::size_t>(perms[i]) >= input.size(),
+        "Error: invalid permutation " << perms[i], ANEURALNETWORKS_BAD_DATA);
+    out[i] = input[static_cast<std::size_t>(perms[i])];
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+uint32_t getShapeSize(const Shape& shape) {
+  uint32_t size = 1;
+  for (auto dim : shape) {
+    size *= dim;
+  }
+  return size;
+}
+
+}  // end namespace
+
+ResultCode inferOutputShapes(const ANeuralNetworksModel& model,
+                             const Operation& operation,
+                             const std::vector<Shape>& input_shapes,
+                             std::vector<Shape>& output_shapes) {
+  TENSOROPT_RETURN_IF_COND(
+      input_shapes.size() != operation.inputs.size() ||
+          operation.inputs.empty() || operation.outputs.size() != 1,
+      "Error: unexpected number of inputs or outputs for operation "
+          << operation.type,
+      ANEURALNETWORKS_BAD_DATA);
+  output_shapes.resize(1);
+  auto& out = output_shapes[0];
+  const auto& input = input_shapes[0];
+  switch (operation.type) {
+    case ANEURALNETWORKS_ADD:
+    case ANEURALNETWORKS_DIV:
+    case ANEURALNETWORKS_MAX:
+    case ANEURALNETWORKS_MIN:
+    case ANEURALNETWORKS_MUL:
+    case ANEURALNETWORKS_SUB:
+      TENSOROPT_RETURN_IF_COND(input_shapes.size() < 2,
+                               "Error: missing rhs of operation "
+                                   << operation.type,
+                               ANEURALNETWORKS_BAD_DATA);
+      return inferBroadcast(input, input_shapes[1], out);
+
+    case ANEURALNETWORKS_CAST:
+    case ANEURALNETWORKS_EXP:
+    case ANEURALNETWORKS_RELU:
+    case ANEURALNETWORKS_RELU1:
+    case ANEURALNETWORKS_RELU6:
+    case ANEURALNETWORKS_RSQRT:
+    case ANEURALNETWORKS_SOFTMAX:
+    case ANEURALNETWORKS_SQRT:
+      out = input;
+      return ANEURALNETWORKS_NO_ERROR;
+
+    case ANEURALNETWORKS_AVERAGE_POOL_2D:
+    case ANEURALNETWORKS_MAX_POOL_2D:
+      return inferPool(model, operation, input, out);
+
+    case ANEURALNETWORKS_CONV_2D:
+    case ANEURALNETWORKS_DEPTHWISE_CONV_2D:
+      TENSOROPT_RETURN_IF_COND(input_shapes.size() < 3,
+                               "Error: missing filter of operation "
+                                   << operation.type,
+                               ANEURALNETWORKS_BAD_DATA);
+      return inferConv(model, operation, input, input_shapes[1], out);
+
+    case ANEURALNETWORKS_MATMUL:
+      TENSOROPT_RETURN_IF_COND(input_shapes.size() < 2,
+                               "Error: missing rhs of operation "
+                                   << operation.type,
+                               ANEURALNETWORKS_BAD_DATA);
+      return inferMatmul(model, operation, input, input_shapes[1], out);
+
+    case ANEURALNETWORKS_RESHAPE:
+      return inferReshape(model, operation, input, out);
+
+    case ANEURALNETWORKS_SQUEEZE:
+      return inferSqueeze(model, operation, input, out);
+
+    case ANEURALNETWORKS_CONCATENATION:
+      return inferConcat(model, operation, input_shapes, out);
+
+    case ANEURALNETWORKS_SLICE:
+      return inferSlice(model, operation, input, out);
+
+    case ANEURALNETWORKS_STRIDED_SLICE:
+      return inferStridedSlice(model, operation, input, out);
+
+    case ANEURALNETWORKS_TRANSPOSE:
+      return inferTranspose(model, operation, input, out);
+
+    default:
+      VLOG_AT("Error: cannot infer the shape of operation " << operation.type);
+      return ANEURALNETWORKS_OP_FAILED;
+  }
+}
+
+Shape getOperandShape(const ANeuralNetworksOperandType& op) {
+  return Shape(op.dimensions, op.dimensions + op.dimensionCount);
+}
+
+bool isShapeKnown(const Shape& shape) {
+  return std::find(shape.begin(), shape.end(), 0u) == shape.end();
+}
+
+bool isShapeCompatible(const Shape& declared, const Shape& inferred) {
+  if (declared.size() != inferred.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < declared.size(); ++i) {
+    if (declared[i] != 0 && declared[i] != inferred[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool hasDynamicInputs(const ANeuralNetworksModel& model) {
+  for (auto input : model.inputs) {
+    if (!isShapeKnown(getOperandShape(model.operands[input]))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+ResultCode inferShapes(const ANeuralNetworksModel& model,
+                       const std::vector<Shape>& input_shapes,
+                       std::vector<Shape>& shapes) {
+  shapes.resize(model.operands.size());
+  for (std::size_t i = 0; i < model.operands.size(); ++i) {
+    shapes[i] = getOperandShape(model.operands[i]);
+  }
+  if (!input_shapes.empty()) {
+    TENSOROPT_RETURN_IF_COND(input_shapes.size() != model.inputs.size(),
+                             "Error: expected " << model.inputs.size()
+                                                << " input shapes but got "
+                                                << input_shapes.size(),
+                             ANEURALNETWORKS_BAD_DATA);
+    for (std::size_t i = 0; i < model.inputs.size(); ++i) {
+      auto input_idx = model.inputs[i];
+      TENSOROPT_RETURN_IF_COND(
+          !isShapeCompatible(shapes[input_idx], input_shapes[i]),
+          "Error: shape [" << arrayToString(input_shapes[i],
+                                            input_shapes[i].size())
+                           << "] is not compatible with input " << i,
+          ANEURALNETWORKS_BAD_DATA);
+      shapes[input_idx] = input_shapes[i];
+    }
+  }
+  for (std::size_t i = 0; i < model.inputs.size(); ++i) {
+    TENSOROPT_RETURN_IF_COND(!isShapeKnown(shapes[model.inputs[i]]),
+                             "Error: the shape of input " << i
+                                                          << " is unknown",
+                             ANEURALNETWORKS_BAD_DATA);
+  }
+
+  std::vector<Shape> operation_inputs;
+  std::vector<Shape> operation_outputs;
+  for (std::size_t op_idx = 0; op_idx < model.operations.size(); ++op_idx) {
+    const auto& operation = model.operations[op_idx];
+    operation_inputs.clear();
+    for (auto input_idx : operation.inputs) {
+      operation_inputs.push_back(shapes[input_idx]);
+    }
+    auto res = inferOutputShapes(model, operation, operation_inputs,
+                                 operation_outputs);
+    if (res == ANEURALNETWORKS_OP_FAILED && operation.outputs.size() == 1 &&
+        isShapeKnown(shapes[operation.outputs[0]])) {
+      // Trust the declared shape if the parameters are not known
+      continue;
+    }
+    TENSOROPT_RETURN_IF_COND(res != ANEURALNETWORKS_NO_ERROR,
+                             "Error: could not infer the shape of operation #"
+                                 << op_idx << " (code=" << operation.type
+                                 << ")",
+                             res);
+    for (std::size_t i = 0; i < operation.outputs.size(); ++i) {
+      auto output_idx = operation.outputs[i];
+      auto& declared = shapes[output_idx];
+      const auto& inferred = operation_outputs[i];
+      // The declared shape of a strided slice with new or shrunk axes is
+      // used as the shape of the reshape of the result
+      bool is_reshaped_slice =
+          operation.type == ANEURALNETWORKS_STRIDED_SLICE &&
+          isShapeKnown(declared) &&
+          getShapeSize(declared) == getShapeSize(inferred);
+      if (is_reshaped_slice) {
+        continue;
+      }
+      TENSOROPT_RETURN_IF_COND(
+          !isShapeCompatible(declared, inferred),
+          "Error: operation #"
+              << op_idx << " (code=" << operation.type << ") output #" << i
+              << " was declared with shape ["
+              << arrayToString(declared, declared.size())
+              << "] but the inferred shape is ["
+              << arrayToString(inferred, inferred.size()) << "]",
+          ANEURALNETWORKS_BAD_DATA);
+      declared = inferred;
+    }
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
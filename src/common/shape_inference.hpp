@@ -0,0 +1,78 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef SRC_COMMON_SHAPE_INFERENCE_HPP
+#define SRC_COMMON_SHAPE_INFERENCE_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "common/model.hpp"
+
+/**
+ * Dimensions of an operand, empty for scalars.
+ * A dimension of 0 in a declared operand type means that it is unknown.
+ */
+using Shape = std::vector<uint32_t>;
+
+/**
+ * Compute the output shapes of an operation from the shapes of its inputs.
+ * The constant parameters of the operation are read from the model.
+ * Return ANEURALNETWORKS_BAD_DATA if the inputs or parameters are invalid and
+ * ANEURALNETWORKS_OP_FAILED if a parameter cannot be read on the host.
+ */
+ResultCode inferOutputShapes(const ANeuralNetworksModel& model,
+                             const ANeuralNetworksModel::Operation& operation,
+                             const std::vector<Shape>& input_shapes,
+                             std::vector<Shape>& output_shapes);
+
+/**
+ * Return the declared shape of an operand.
+ */
+Shape getOperandShape(const ANeuralNetworksOperandType& op);
+
+/**
+ * Return true if the shape has no unknown dimension.
+ */
+bool isShapeKnown(const Shape& shape);
+
+/**
+ * Return true if the inferred shape matches the declared shape where the
+ * declared dimensions are known.
+ */
+bool isShapeCompatible(const Shape& declared, const Shape& inferred);
+
+/**
+ * Return true if a model input has an unknown dimension.
+ * Such inputs are dynamic, their shapes are only known when the model is
+ * executed.
+ */
+bool hasDynamicInputs(const ANeuralNetworksModel& model);
+
+/**
+ * Compute the shape of every operand of the model, indexed by operand index.
+ * The shapes of the model inputs are given by input_shapes, in the order of
+ * the inputs, or by their declared dimensions if input_shapes is empty. They
+ * must not have unknown dimensions.
+ * Each inferred shape is checked against the declared dimensions.
+ * If a parameter cannot be read on the host the declared shape is used if it
+ * is known.
+ * The operations must be sorted.
+ */
+ResultCode inferShapes(const ANeuralNetworksModel& model,
+                       const std::vector<Shape>& input_shapes,
+                       std::vector<Shape>& shapes);
+
+#endif  // SRC_COMMON_SHAPE_INFERENCE_HPP
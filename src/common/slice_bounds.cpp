@@ -0,0 +1,141 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/slice_bounds.hpp"
+#include "common/macro.hpp"
+#include "common/utils.hpp"
+
+#include <string>
+
+namespace {
+
+// Offset to convert an exclusive end bound to an inclusive one
+constexpr int INCLUSIVE_END = -1;
+
+template <class Container>
+ResultCode checkVectorEqualRank(uint32_t rank, const Container& container,
+                                const std::string& input_name) {
+  TENSOROPT_UNUSED_VARIABLE(input_name);
+  TENSOROPT_RETURN_IF_COND(
+      container.size() != rank,
+      "Error: '" << input_name << "' argument has " << container.size()
+                 << " elements but input rank is " << rank << ".",
+      ANEURALNETWORKS_OP_FAILED);
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+template <class Container>
+ResultCode checkVectorSmallerOrEqualRank(uint32_t rank,
+                                         const Container& container,
+                                         const std::string& input_name) {
+  TENSOROPT_UNUSED_VARIABLE(input_name);
+  TENSOROPT_RETURN_IF_COND(
+      container.size() > rank,
+      "Error: '" << input_name << "' argument has " << container.size()
+                 << " elements but input rank is " << rank << ".",
+      ANEURALNETWORKS_OP_FAILED);
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+}  // end namespace
+
+ResultCode getSliceBounds(const ANeuralNetworksOperandType& input_op,
+                          const std::vector<int32_t>& begins,
+                          const std::vector<int32_t>& sizes,
+                          SliceBounds& bounds) {
+  auto rank = input_op.dimensionCount;
+  TENSOROPT_RETURN_IF_ERROR(checkVectorEqualRank(rank, begins, "begins"));
+  TENSOROPT_RETURN_IF_ERROR(checkVectorEqualRank(rank, sizes, "sizes"));
+  bounds.starts.resize(rank);
+  bounds.ends.resize(rank);
+  bounds.strides.assign(rank, 1);
+  for (unsigned i = 0; i < rank; ++i) {
+    bounds.starts[i] = static_cast<std::size_t>(begins[i]);
+    if (sizes[i] < 0) {
+      bounds.ends[i] = static_cast<std::size_t>(
+          static_cast<long>(input_op.dimensions[i]) + INCLUSIVE_END);
+    } else {  // sizes[i] cannot be 0
+      bounds.ends[i] =
+          bounds.starts[i] + static_cast<std::size_t>(sizes[i] + INCLUSIVE_END);
+    }
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode getStridedSliceBounds(const ANeuralNetworksOperandType& input_op,
+                                 std::vector<int32_t>& begins,
+                                 std::vector<int32_t>& ends,
+                                 std::vector<int32_t>& strides,
+                                 const std::bitset<32>& begin_mask,
+                                 const std::bitset<32>& end_mask,
+                                 const std::bitset<32>& shrink_axis_mask,
+                                 const std::bitset<32>& ellipsis_mask,
+                                 SliceBounds& bounds) {
+  auto rank = input_op.dimensionCount;
+  TENSOROPT_RETURN_IF_ERROR(
+      checkVectorSmallerOrEqualRank(rank, begins, "begins"));
+  TENSOROPT_RETURN_IF_COND(ends.size() != begins.size(),
+                           "Error: 'ends' argument is of size "
+                               << ends.size() << " but expected "
+                               << begins.size() << ".",
+                           ANEURALNETWORKS_OP_FAILED);
+  TENSOROPT_RETURN_IF_COND(strides.size() != begins.size(),
+                           "Error: 'strides' argument is of size "
+                               << strides.size() << " but expected "
+                               << begins.size() << ".",
+                           ANEURALNETWORKS_OP_FAILED);
+  if (ellipsis_mask.none()) {
+    TENSOROPT_RETURN_IF_ERROR(checkVectorEqualRank(rank, begins, "begins"));
+  } else if (begins.size() < rank) {
+    unsigned ellipsis = 0;
+    while (!ellipsis_mask[ellipsis] && ellipsis < rank) {
+      ++ellipsis;
+    }
+    if (ellipsis < rank) {
+      std::size_t diff = rank - begins.size();
+      begins.insert(begins.begin() + ellipsis, diff, 0);
+      ends.insert(ends.begin() + ellipsis, diff, -1);
+      strides.insert(strides.begin() + ellipsis, diff, 1);
+    }
+  }
+  bounds.starts.resize(rank);
+  bounds.ends.resize(rank);
+  bounds.strides.resize(rank);
+  for (unsigned i = 0; i < rank; ++i) {
+    if (begin_mask[i] || begins[i] < 0) {
+      bounds.starts[i] = 0;
+    } else {
+      bounds.starts[i] = static_cast<std::size_t>(begins[i]);
+    }
+    if (shrink_axis_mask[i]) {
+      bounds.ends[i] = bounds.starts[i] + (1 + INCLUSIVE_END);
+      bounds.strides[i] = 1;
+      continue;
+    }
+    if (end_mask[i] || ends[i] < 0) {
+      bounds.ends[i] = static_cast<std::size_t>(
+          static_cast<long>(input_op.dimensions[i]) + INCLUSIVE_END);
+    } else {  // ends[i] cannot be 0
+      bounds.ends[i] = static_cast<std::size_t>(ends[i] + INCLUSIVE_END);
+    }
+    if (strides[i] <= 0) {
+      VLOG_AT("Error: strides must be stricly positive but got ["
+              << arrayToString(strides, rank) << "].");
+      return ANEURALNETWORKS_OP_FAILED;
+    }
+    bounds.strides[i] = static_cast<std::size_t>(strides[i]);
+  }
+  return ANEURALNETWORKS_NO_ERROR;
+}
@@ -0,0 +1,59 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef SRC_COMMON_SLICE_BOUNDS_HPP
+#define SRC_COMMON_SLICE_BOUNDS_HPP
+
+#include <bitset>
+#include <cstddef>
+#include <vector>
+
+#include "tensoropt/operand.hpp"
+#include "tensoropt/result.hpp"
+
+/**
+ * Bounds of a sub-tensor along each dimension of the input.
+ * The end bounds are inclusive.
+ */
+struct SliceBounds {
+  std::vector<std::size_t> starts;
+  std::vector<std::size_t> ends;
+  std::vector<std::size_t> strides;
+};
+
+/**
+ * Compute the bounds of ANEURALNETWORKS_SLICE.
+ */
+ResultCode getSliceBounds(const ANeuralNetworksOperandType& input_op,
+                          const std::vector<int32_t>& begins,
+                          const std::vector<int32_t>& sizes,
+                          SliceBounds& bounds);
+
+/**
+ * Compute the bounds of ANEURALNETWORKS_STRIDED_SLICE.
+ * begins, ends and strides are modified if an ellipsis is used.
+ * The new axis mask is not used here, it only changes the output shape.
+ */
+ResultCode getStridedSliceBounds(const ANeuralNetworksOperandType& input_op,
+                                 std::vector<int32_t>& begins,
+                                 std::vector<int32_t>& ends,
+                                 std::vector<int32_t>& strides,
+                                 const std::bitset<32>& begin_mask,
+                                 const std::bitset<32>& end_mask,
+                                 const std::bitset<32>& shrink_axis_mask,
+                                 const std::bitset<32>& ellipsis_mask,
+                                 SliceBounds& bounds);
+
+#endif  // SRC_COMMON_SLICE_BOUNDS_HPP
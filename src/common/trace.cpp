@@ -0,0 +1,153 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/trace.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/macro.hpp"
+
+std::atomic<bool> tracing_enabled(false);
+
+namespace {
+
+struct TraceEvent {
+  const char* name;
+  const char* category;
+  trace_clock_t::time_point start;
+  trace_clock_t::time_point end;
+  uint32_t thread_id;
+};
+
+/**
+ * Events recorded since the trace was started.
+ */
+struct Trace {
+  std::mutex mutex;
+  std::string path;
+  trace_clock_t::time_point start;
+  std::vector<TraceEvent> events;
+};
+
+Trace& getTrace() {
+  static Trace trace;
+  return trace;
+}
+
+/**
+ * Return a small identifier for the current thread.
+ */
+uint32_t getThreadId() {
+  static std::atomic<uint32_t> next_thread_id(0);
+  thread_local uint32_t thread_id = next_thread_id++;
+  return thread_id;
+}
+
+/**
+ * Return the number of microseconds between two time points as expected by
+ * the trace format.
+ */
+double getMicroseconds(trace_clock_t::time_point start,
+                       trace_clock_t::time_point end) {
+  return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+/**
+ * Write the events of the trace in the Chrome trace event format.
+ */
+ResultCode writeTrace(const Trace& trace) {
+  std::ofstream file(trace.path, std::ios::out | std::ios::trunc);
+  file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+  bool first = true;
+  for (const auto& event : trace.events) {
+    file << (first ? "\n" : ",\n") << "{\"name\":\"" << event.name
+         << "\",\"cat\":\"" << event.category
+         << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.thread_id
+         << ",\"ts\":" << getMicroseconds(trace.start, event.start)
+         << ",\"dur\":" << getMicroseconds(event.start, event.end) << "}";
+    first = false;
+  }
+  file << "\n]}\n";
+  TENSOROPT_RETURN_IF_COND(!file.good(),
+                           "Error: could not write trace file " << trace.path,
+                           ANEURALNETWORKS_BAD_DATA);
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+/**
+ * Start tracing if TENSOROPT_TRACE is set and write the trace when the
+ * process exits.
+ */
+struct EnvironmentTrace {
+  EnvironmentTrace() {
+    // Make sure the trace is destroyed after this object
+    getTrace();
+    const char* path = std::getenv("TENSOROPT_TRACE");
+    if (path && *path) {
+      ANeuralNetworks_startTracing(path);
+    }
+  }
+
+  ~EnvironmentTrace() {
+    if (tracing_enabled) {
+      ANeuralNetworks_stopTracing();
+    }
+  }
+};
+
+EnvironmentTrace environment_trace;
+
+}  // namespace
+
+void recordTraceEvent(const char* name, const char* category,
+                      trace_clock_t::time_point start,
+                      trace_clock_t::time_point end) {
+  auto thread_id = getThreadId();
+  auto& trace = getTrace();
+  std::lock_guard<std::mutex> lock(trace.mutex);
+  // The event may finish after the trace was stopped
+  if (tracing_enabled) {
+    trace.events.push_back({name, category, start, end, thread_id});
+  }
+}
+
+ResultCode ANeuralNetworks_startTracing(const char* path) {
+  TENSOROPT_RETURN_IF_NULL(path);
+  auto& trace = getTrace();
+  std::lock_guard<std::mutex> lock(trace.mutex);
+  TENSOROPT_RETURN_IF_COND(tracing_enabled, "Error: tracing already started",
+                           ANEURALNETWORKS_BAD_STATE);
+  trace.path = path;
+  trace.start = trace_clock_t::now();
+  trace.events.clear();
+  tracing_enabled = true;
+  return ANEURALNETWORKS_NO_ERROR;
+}
+
+ResultCode ANeuralNetworks_stopTracing() {
+  auto& trace = getTrace();
+  std::lock_guard<std::mutex> lock(trace.mutex);
+  TENSOROPT_RETURN_IF_COND(!tracing_enabled, "Error: tracing is not started",
+                           ANEURALNETWORKS_BAD_STATE);
+  tracing_enabled = false;
+  auto ret = writeTrace(trace);
+  trace.events.clear();
+  return ret;
+}
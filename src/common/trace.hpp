@@ -0,0 +1,77 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef SRC_COMMON_TRACE_HPP
+#define SRC_COMMON_TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+
+#include "tensoropt/trace.hpp"
+
+using trace_clock_t = std::chrono::steady_clock;
+
+/**
+ * Whether events are recorded. This is the only check made when tracing is
+ * disabled.
+ */
+extern std::atomic<bool> tracing_enabled;
+
+/**
+ * Record an event of the current thread.
+ * name and category must be string literals.
+ */
+void recordTraceEvent(const char* name, const char* category,
+                      trace_clock_t::time_point start,
+                      trace_clock_t::time_point end);
+
+/**
+ * Record an event spanning the lifetime of the object if tracing is enabled
+ * when it is created.
+ */
+class TraceScope {
+ public:
+  TraceScope(const char* name, const char* category)
+      : name_(tracing_enabled.load(std::memory_order_relaxed) ? name
+                                                              : nullptr),
+        category_(category),
+        start_() {
+    if (name_) {
+      start_ = trace_clock_t::now();
+    }
+  }
+
+  ~TraceScope() {
+    if (name_) {
+      recordTraceEvent(name_, category_, start_, trace_clock_t::now());
+    }
+  }
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+ private:
+  const char* name_;
+  const char* category_;
+  trace_clock_t::time_point start_;
+};
+
+#define TENSOROPT_TRACE_SCOPE(NAME, CATEGORY) \
+  TraceScope tensoropt_trace_scope(NAME, CATEGORY)
+
+// Trace a public entry point
+#define TENSOROPT_TRACE_API() TENSOROPT_TRACE_SCOPE(__func__, "api")
+
+#endif  // SRC_COMMON_TRACE_HPP
@@ -16,6 +16,7 @@
 #ifndef SRC_COMMON_UTILS_HPP
 #define SRC_COMMON_UTILS_HPP
 
+#include <chrono>
 #include <cstdint>
 #include <sstream>
 
@@ -34,6 +35,16 @@ inline Index roundRatioUp(Index x, Index y) {
   return (x + y - 1) / y;
 }
 
+/**
+ * Return the duration in nanoseconds between two time points.
+ */
+template <class TimePoint>
+inline uint64_t getNanoseconds(TimePoint start, TimePoint end) {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+          .count());
+}
+
 template <class T>
 std::string arrayToString(const T& data, std::size_t count,
                           std::size_t max_count_print = 10) {
@@ -0,0 +1,75 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef TENSOROPT_TESTS_COMMON_ADD_FIXTURE_HPP
+#define TENSOROPT_TESTS_COMMON_ADD_FIXTURE_HPP
+
+#include "common/common_fixture.hpp"
+
+#include <array>
+#include <vector>
+
+/**
+ * Fixture running the model ADD(input0, input1) where input0 is a scalar and
+ * input1 and the output are vectors of input1_size elements.
+ */
+class AddFixture : public CommonFixture {
+ protected:
+  AddFixture()
+      : host_input0(1.f),
+        host_input1{-1.f, 2.f, 5.f},
+        host_output(input1_size) {}
+
+  void buildModel() {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32);                 // 0
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {input1_size});  // 1
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {input1_size});  // 2
+    std::array<uint32_t, 2> op_inputs_idx{0, 1};
+    uint32_t op_output_idx = 2;
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_addOperation(
+        model, ANEURALNETWORKS_ADD, 2, op_inputs_idx.data(), 1,
+        &op_output_idx));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_identifyInputsAndOutputs(
+        model, 2, op_inputs_idx.data(), 1, &op_output_idx));
+  }
+
+  /**
+   * Set the host inputs and output of the fixture on the execution.
+   */
+  void setHostMemories() {
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_setInput(
+        execution, 0, nullptr, &host_input0, sizeof(float)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_setInput(
+        execution, 1, nullptr, host_input1.data(), tensor_size));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_setOutput(
+        execution, 0, nullptr, host_output.data(), tensor_size));
+  }
+
+  void checkOutput(const std::vector<float>& output) {
+    for (uint32_t i = 0; i < input1_size; ++i) {
+      ASSERT_FLOAT_EQ(output[i], host_input0 + host_input1[i]);
+    }
+  }
+
+  void checkOutput() { checkOutput(host_output); }
+
+  static constexpr uint32_t input1_size = 3;
+  static constexpr std::size_t tensor_size = input1_size * sizeof(float);
+  float host_input0;
+  std::vector<float> host_input1;
+  std::vector<float> host_output;
+};
+
+#endif  // TENSOROPT_TESTS_COMMON_ADD_FIXTURE_HPP
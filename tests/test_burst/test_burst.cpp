@@ -0,0 +1,91 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/add_fixture.hpp"
+
+#include <algorithm>
+
+class BurstFixture : public AddFixture {
+ protected:
+  BurstFixture() : AddFixture(), burst(nullptr) {}
+
+  ~BurstFixture() {
+    if (burst) {
+      ANeuralNetworksBurst_free(burst);
+    }
+  }
+
+  void createBurst() {
+    buildModel();
+    compileModel();
+    TENSOROPT_ASSERT_OK(ANeuralNetworksBurst_create(compilation, &burst));
+  }
+
+  void getStatistics(ANeuralNetworksExecutionStatistics& statistics) {
+    TENSOROPT_ASSERT_OK(
+        ANeuralNetworksExecution_getStatistics(execution, &statistics));
+  }
+
+  void testBurstReusesMemories() {
+    createBurst();
+    // The same buffers are used with different values for each computation
+    const uint64_t num_computations = 3;
+    for (uint64_t i = 0; i < num_computations; ++i) {
+      host_input0 = static_cast<float>(i);
+      setHostMemories();
+      TENSOROPT_ASSERT_OK(
+          ANeuralNetworksExecution_burstCompute(execution, burst));
+      checkOutput();
+    }
+    ANeuralNetworksExecutionStatistics statistics;
+    getStatistics(statistics);
+    ASSERT_EQ(statistics.num_computations, num_computations);
+    ASSERT_EQ(statistics.num_memory_imports, 3u);
+    ASSERT_EQ(statistics.num_memory_destroys, 0u);
+  }
+
+  void testAlternateBurstAndExecution() {
+    createBurst();
+    // The memories set once are bound to the binding of the execution and to
+    // the binding of the burst
+    setHostMemories();
+    const uint64_t num_computations = 4;
+    for (uint64_t i = 0; i < num_computations; ++i) {
+      host_input0 = static_cast<float>(i);
+      std::fill(host_output.begin(), host_output.end(), 0.f);
+      if (i % 2 == 0) {
+        TENSOROPT_ASSERT_OK(
+            ANeuralNetworksExecution_burstCompute(execution, burst));
+      } else {
+        TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_compute(execution));
+      }
+      checkOutput();
+    }
+    // The memories are imported once for the burst and once for the
+    // execution
+    ANeuralNetworksExecutionStatistics statistics;
+    getStatistics(statistics);
+    ASSERT_EQ(statistics.num_computations, num_computations);
+    ASSERT_EQ(statistics.num_memory_imports, 6u);
+  }
+
+  ANeuralNetworksBurst* burst;
+};
+
+#define ADD_BURST_TEST_HELPER(NAME) \
+  ADD_TEST_HELPER(BurstFixture, NAME, test##NAME)
+
+ADD_BURST_TEST_HELPER(BurstReusesMemories)
+ADD_BURST_TEST_HELPER(AlternateBurstAndExecution)
@@ -0,0 +1,197 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/common_fixture.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+
+class CachingFixture : public CommonFixture {
+ protected:
+  CachingFixture() : token(), token_path() {
+    for (unsigned i = 0; i < BYTE_SIZE_OF_CACHE_TOKEN; ++i) {
+      token[i] = static_cast<uint8_t>(i * 7);
+    }
+    updateTokenPath();
+  }
+
+  void updateTokenPath() {
+    token_path = "./";
+    for (unsigned i = 0; i < BYTE_SIZE_OF_CACHE_TOKEN; ++i) {
+      // Token bytes are written in hexadecimal
+      static constexpr char hex[] = "0123456789abcdef";
+      token_path += hex[token[i] >> 4];
+      token_path += hex[token[i] & 0xf];
+    }
+    std::remove(token_path.c_str());
+  }
+
+  ~CachingFixture() { std::remove(token_path.c_str()); }
+
+  void buildModel() {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32);                 // 0
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {input1_size});  // 1
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {input1_size});  // 2
+    std::array<uint32_t, 2> op_inputs_idx{0, 1};
+    uint32_t op_output_idx = 2;
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_addOperation(
+        model, ANEURALNETWORKS_ADD, 2, op_inputs_idx.data(), 1,
+        &op_output_idx));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_identifyInputsAndOutputs(
+        model, 2, op_inputs_idx.data(), 1, &op_output_idx));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_finish(model));
+  }
+
+  void compileWithCaching() {
+    TENSOROPT_ASSERT_OK(ANeuralNetworksCompilation_create(model, &compilation));
+    TENSOROPT_ASSERT_OK(
+        ANeuralNetworksCompilation_setCaching(compilation, ".", token.data()));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksCompilation_finish(compilation));
+    TENSOROPT_ASSERT_OK(
+        ANeuralNetworksExecution_create(compilation, &execution));
+  }
+
+  void checkValidOutput() {
+    float host_input0{1.f};
+    std::vector<float> host_input1{-1.f, 2.f, 5.f};
+    std::vector<float> host_output(input1_size);
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_setInput(
+        execution, 0, nullptr, &host_input0, sizeof(float)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_setInput(
+        execution, 1, nullptr, host_input1.data(),
+        input1_size * sizeof(float)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_setOutput(
+        execution, 0, nullptr, host_output.data(),
+        input1_size * sizeof(float)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_compute(execution));
+    for (uint32_t i = 0; i < input1_size; ++i) {
+      ASSERT_FLOAT_EQ(host_output[i], host_input0 + host_input1[i]);
+    }
+  }
+
+  void releaseCompilation() {
+    ANeuralNetworksExecution_free(execution);
+    execution = nullptr;
+    ANeuralNetworksCompilation_free(compilation);
+    compilation = nullptr;
+  }
+
+  void testWriteCacheOnMiss() {
+    buildModel();
+    compileWithCaching();
+    ASSERT_TRUE(std::ifstream(token_path).good());
+    checkValidOutput();
+  }
+
+  void testLoadCacheOnHit() {
+    buildModel();
+    compileWithCaching();
+    releaseCompilation();
+    ASSERT_TRUE(std::ifstream(token_path).good());
+
+    // The second compilation loads the network object from the cache
+    compileWithCaching();
+    uint64_t duration;
+    TENSOROPT_ASSERT_OK(ANeuralNetworksCompilation_getDuration(
+        compilation, ANEURALNETWORKS_COMPILATION_DURATION_CONVERT, &duration));
+    ASSERT_EQ(duration, UINT64_MAX);
+    checkValidOutput();
+  }
+
+  void testInvalidCacheIsOverwritten() {
+    {
+      std::ofstream file(token_path, std::ios::binary);
+      file << "invalid binary";
+    }
+    buildModel();
+    compileWithCaching();
+    checkValidOutput();
+  }
+
+  void testModelHashIsStable() {
+    std::array<uint8_t, BYTE_SIZE_OF_MODEL_HASH> first_hash;
+    std::array<uint8_t, BYTE_SIZE_OF_MODEL_HASH> second_hash;
+    ASSERT_EQ(ANeuralNetworksModel_getHash(model, first_hash.data()),
+              ANEURALNETWORKS_BAD_STATE);
+    buildModel();
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_getHash(model, first_hash.data()));
+
+    ANeuralNetworksModel_free(model);
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_create(&model));
+    buildModel();
+    TENSOROPT_ASSERT_OK(
+        ANeuralNetworksModel_getHash(model, second_hash.data()));
+    ASSERT_EQ(first_hash, second_hash);
+  }
+
+  void testNullTokenUsesModelHash() {
+    buildModel();
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_getHash(model, token.data()));
+    updateTokenPath();
+    TENSOROPT_ASSERT_OK(ANeuralNetworksCompilation_create(model, &compilation));
+    TENSOROPT_ASSERT_OK(
+        ANeuralNetworksCompilation_setCaching(compilation, ".", nullptr));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksCompilation_finish(compilation));
+    ASSERT_TRUE(std::ifstream(token_path).good());
+  }
+
+  void testIdenticalModelsShareNetworkObject() {
+    buildModel();
+    ANeuralNetworksCompilation* first_compilation;
+    TENSOROPT_ASSERT_OK(
+        ANeuralNetworksCompilation_create(model, &first_compilation));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksCompilation_finish(first_compilation));
+
+    // The second compilation must stay valid once the first one is released
+    ANeuralNetworksModel* first_model = model;
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_create(&model));
+    buildModel();
+    TENSOROPT_ASSERT_OK(ANeuralNetworksCompilation_create(model, &compilation));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksCompilation_finish(compilation));
+    // The shared network object is used without converting the model again
+    uint64_t duration;
+    TENSOROPT_ASSERT_OK(ANeuralNetworksCompilation_getDuration(
+        first_compilation, ANEURALNETWORKS_COMPILATION_DURATION_CONVERT,
+        &duration));
+    ASSERT_NE(duration, UINT64_MAX);
+    TENSOROPT_ASSERT_OK(ANeuralNetworksCompilation_getDuration(
+        compilation, ANEURALNETWORKS_COMPILATION_DURATION_CONVERT, &duration));
+    ASSERT_EQ(duration, UINT64_MAX);
+    ANeuralNetworksCompilation_free(first_compilation);
+    ANeuralNetworksModel_free(first_model);
+
+    TENSOROPT_ASSERT_OK(
+        ANeuralNetworksExecution_create(compilation, &execution));
+    checkValidOutput();
+  }
+
+  static constexpr uint32_t input1_size = 3;
+  std::array<uint8_t, BYTE_SIZE_OF_CACHE_TOKEN> token;
+  std::string token_path;
+};
+
+constexpr uint32_t CachingFixture::input1_size;
+
+#define ADD_CACHING_TEST_HELPER(NAME) \
+  ADD_TEST_HELPER(CachingFixture, NAME, test##NAME)
+
+ADD_CACHING_TEST_HELPER(WriteCacheOnMiss)
+ADD_CACHING_TEST_HELPER(LoadCacheOnHit)
+ADD_CACHING_TEST_HELPER(InvalidCacheIsOverwritten)
+ADD_CACHING_TEST_HELPER(ModelHashIsStable)
+ADD_CACHING_TEST_HELPER(NullTokenUsesModelHash)
+ADD_CACHING_TEST_HELPER(IdenticalModelsShareNetworkObject)
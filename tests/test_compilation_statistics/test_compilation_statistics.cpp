@@ -0,0 +1,86 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/add_fixture.hpp"
+#include "backends/imgdnn/compilation.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+class CompilationStatisticsFixture : public AddFixture {
+ protected:
+  CompilationStatisticsFixture() : AddFixture(), token(), token_path("./") {
+    for (unsigned i = 0; i < BYTE_SIZE_OF_CACHE_TOKEN; ++i) {
+      token[i] = static_cast<uint8_t>(i * 11 + 1);
+      static constexpr char hex[] = "0123456789abcdef";
+      token_path += hex[token[i] >> 4];
+      token_path += hex[token[i] & 0xf];
+    }
+    std::remove(token_path.c_str());
+  }
+
+  ~CompilationStatisticsFixture() { std::remove(token_path.c_str()); }
+
+  void compileWithCaching() {
+    TENSOROPT_ASSERT_OK(ANeuralNetworksCompilation_create(model, &compilation));
+    TENSOROPT_ASSERT_OK(
+        ANeuralNetworksCompilation_setCaching(compilation, ".", token.data()));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksCompilation_finish(compilation));
+  }
+
+  void testCompilationStatistics() {
+    buildModel();
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_finish(model));
+    compileWithCaching();
+    uint64_t duration;
+    for (int32_t code = ANEURALNETWORKS_COMPILATION_DURATION_OPTIMIZE;
+         code <= ANEURALNETWORKS_COMPILATION_DURATION_CREATE_NETWORK_BINARY;
+         ++code) {
+      TENSOROPT_ASSERT_OK(
+          ANeuralNetworksCompilation_getDuration(compilation, code, &duration));
+      ASSERT_NE(duration, UINT64_MAX) << "code " << code;
+    }
+    ASSERT_EQ(ANeuralNetworksCompilation_getDuration(
+                  compilation,
+                  static_cast<int32_t>(NUM_COMPILATION_DURATIONS), &duration),
+              ANEURALNETWORKS_BAD_DATA);
+    uint32_t count;
+    TENSOROPT_ASSERT_OK(ANeuralNetworksCompilation_getOperationDuration(
+        compilation, ANEURALNETWORKS_ADD, &duration, &count));
+    ASSERT_EQ(count, 1u);
+    TENSOROPT_ASSERT_OK(ANeuralNetworksCompilation_getOperationDuration(
+        compilation, ANEURALNETWORKS_CONV_2D, &duration, &count));
+    ASSERT_EQ(count, 0u);
+    ASSERT_EQ(duration, 0u);
+    ANeuralNetworksCompilation_free(compilation);
+    compilation = nullptr;
+
+    // The model is not converted when loaded from the cache
+    compileWithCaching();
+    TENSOROPT_ASSERT_OK(ANeuralNetworksCompilation_getDuration(
+        compilation, ANEURALNETWORKS_COMPILATION_DURATION_CONVERT, &duration));
+    ASSERT_EQ(duration, UINT64_MAX);
+  }
+
+  std::array<uint8_t, BYTE_SIZE_OF_CACHE_TOKEN> token;
+  std::string token_path;
+};
+
+#define ADD_COMPILATION_STATISTICS_TEST_HELPER(NAME) \
+  ADD_TEST_HELPER(CompilationStatisticsFixture, NAME, test##NAME)
+
+ADD_COMPILATION_STATISTICS_TEST_HELPER(CompilationStatistics)
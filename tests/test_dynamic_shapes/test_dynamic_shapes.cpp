@@ -0,0 +1,182 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/common_fixture.hpp"
+#include "backends/imgdnn/compilation.hpp"
+#include "backends/imgdnn/execution.hpp"
+
+#include <array>
+#include <vector>
+
+class DynamicShapesFixture : public CommonFixture {
+ protected:
+  /**
+   * Build the model ADD(input0, input1) where the first dimension of the
+   * inputs and output is dynamic.
+   */
+  void buildModel() {
+    const std::vector<uint32_t> dims{0, inner_size};
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, dims);  // 0
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, dims);  // 1
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, dims);  // 2
+    std::array<uint32_t, 2> op_inputs_idx{0, 1};
+    uint32_t op_output_idx = 2;
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_addOperation(
+        model, ANEURALNETWORKS_ADD, 2, op_inputs_idx.data(), 1,
+        &op_output_idx));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_identifyInputsAndOutputs(
+        model, 2, op_inputs_idx.data(), 1, &op_output_idx));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_finish(model));
+  }
+
+  void createCompilation() {
+    TENSOROPT_ASSERT_OK(ANeuralNetworksCompilation_create(model, &compilation));
+  }
+
+  void createExecution() {
+    TENSOROPT_ASSERT_OK(ANeuralNetworksCompilation_finish(compilation));
+    TENSOROPT_ASSERT_OK(
+        ANeuralNetworksExecution_create(compilation, &execution));
+  }
+
+  /**
+   * Execute the model for the given batch size and check the output values
+   * and dimensions.
+   */
+  void checkBatch(uint32_t batch) {
+    std::array<uint32_t, 2> dims{batch, inner_size};
+    ANeuralNetworksOperandType type;
+    type.type = ANEURALNETWORKS_TENSOR_FLOAT32;
+    type.dimensionCount = static_cast<uint32_t>(dims.size());
+    type.dimensions = dims.data();
+    type.scale = 0.f;
+    type.zeroPoint = 0;
+
+    const std::size_t size = batch * inner_size;
+    std::vector<float> host_input0(size);
+    std::vector<float> host_input1(size);
+    std::vector<float> host_output(size);
+    for (std::size_t i = 0; i < size; ++i) {
+      host_input0[i] = static_cast<float>(i);
+      host_input1[i] = 2.f;
+    }
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_setInput(
+        execution, 0, &type, host_input0.data(), size * sizeof(float)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_setInput(
+        execution, 1, &type, host_input1.data(), size * sizeof(float)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_setOutput(
+        execution, 0, nullptr, host_output.data(), size * sizeof(float)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_compute(execution));
+    for (std::size_t i = 0; i < size; ++i) {
+      ASSERT_FLOAT_EQ(host_output[i], host_input0[i] + host_input1[i]);
+    }
+
+    uint32_t rank;
+    TENSOROPT_ASSERT_OK(
+        ANeuralNetworksExecution_getOutputOperandRank(execution, 0, &rank));
+    ASSERT_EQ(rank, dims.size());
+    std::array<uint32_t, 2> output_dims;
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_getOutputOperandDimensions(
+        execution, 0, output_dims.data()));
+    ASSERT_EQ(output_dims, dims);
+  }
+
+  void testSpecialiseOnInputShape() {
+    buildModel();
+    createCompilation();
+    createExecution();
+    checkBatch(2);
+    checkBatch(5);
+    // The first specialisation is reused
+    checkBatch(2);
+  }
+
+  void testEvictedSpecialisationIsCompiledAgain() {
+    buildModel();
+    createCompilation();
+    TENSOROPT_ASSERT_OK(
+        ANeuralNetworksCompilation_setMaxSpecialisations(compilation, 1));
+    createExecution();
+    checkBatch(1);
+    // Keep the first specialisation alive to compare it with the next ones
+    auto first_specialisation = execution->specialised_compilation;
+    checkBatch(3);
+    ASSERT_EQ(compilation->specialisations.size(), 1u);
+    ASSERT_NE(execution->specialised_compilation, first_specialisation);
+    checkBatch(1);
+    ASSERT_EQ(compilation->specialisations.size(), 1u);
+    ASSERT_NE(execution->specialised_compilation, first_specialisation);
+  }
+
+  void testIdentifiedOperandsBeforeSpecialisation() {
+    buildModel();
+    createCompilation();
+    createExecution();
+    ASSERT_EQ(ANeuralNetworksExecution_getIdentifiedInputCount(execution), 2u);
+    ASSERT_EQ(ANeuralNetworksExecution_getIdentifiedOutputCount(execution),
+              1u);
+    std::array<ANeuralNetworksOperandType, 2> inputs;
+    ANeuralNetworksOperandType output;
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_getIdentifiedInputs(
+        execution, inputs.data()));
+    TENSOROPT_ASSERT_OK(
+        ANeuralNetworksExecution_getIdentifiedOutputs(execution, &output));
+    // The dynamic dimension is unknown until the inputs are set
+    for (const auto& type : {inputs[0], inputs[1], output}) {
+      ASSERT_EQ(type.type, ANEURALNETWORKS_TENSOR_FLOAT32);
+      ASSERT_EQ(type.dimensionCount, 2u);
+      ASSERT_EQ(type.dimensions[0], 0u);
+      ASSERT_EQ(type.dimensions[1], inner_size);
+    }
+  }
+
+  void testBatchIsPaddedToBucket() {
+    buildModel();
+    createCompilation();
+    std::array<uint32_t, 3> buckets{2, 4, 8};
+    for (int32_t i = 0; i < 2; ++i) {
+      TENSOROPT_ASSERT_OK(ANeuralNetworksCompilation_setDimensionBuckets(
+          compilation, i, 0, buckets.data(),
+          static_cast<uint32_t>(buckets.size())));
+    }
+    // A single specialisation is enough for all the batches up to 4
+    TENSOROPT_ASSERT_OK(
+        ANeuralNetworksCompilation_setMaxSpecialisations(compilation, 1));
+    createExecution();
+    checkBatch(3);
+    auto bucket_specialisation = execution->specialised_compilation;
+    ASSERT_NE(bucket_specialisation, nullptr);
+    checkBatch(4);
+    ASSERT_EQ(execution->specialised_compilation, bucket_specialisation);
+    checkBatch(3);
+    ASSERT_EQ(execution->specialised_compilation, bucket_specialisation);
+    ASSERT_EQ(execution->imgdnn_network_object_,
+              bucket_specialisation->imgdnn_network_object_);
+    // Larger than the largest bucket
+    checkBatch(9);
+  }
+
+  static constexpr uint32_t inner_size = 3;
+};
+
+constexpr uint32_t DynamicShapesFixture::inner_size;
+
+#define ADD_DYNAMIC_SHAPES_TEST_HELPER(NAME) \
+  ADD_TEST_HELPER(DynamicShapesFixture, NAME, test##NAME)
+
+ADD_DYNAMIC_SHAPES_TEST_HELPER(SpecialiseOnInputShape)
+ADD_DYNAMIC_SHAPES_TEST_HELPER(EvictedSpecialisationIsCompiledAgain)
+ADD_DYNAMIC_SHAPES_TEST_HELPER(IdentifiedOperandsBeforeSpecialisation)
+ADD_DYNAMIC_SHAPES_TEST_HELPER(BatchIsPaddedToBucket)
@@ -0,0 +1,46 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/add_fixture.hpp"
+
+#include <cstdint>
+
+class ExecutionStatisticsFixture : public AddFixture {
+ protected:
+  void testExecutionStatistics() {
+    buildModel();
+    compileModel();
+
+    // The same buffers are imported once
+    const uint64_t num_computations = 3;
+    for (uint64_t i = 0; i < num_computations; ++i) {
+      setHostMemories();
+      TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_compute(execution));
+    }
+    ANeuralNetworksExecutionStatistics statistics;
+    TENSOROPT_ASSERT_OK(
+        ANeuralNetworksExecution_getStatistics(execution, &statistics));
+    ASSERT_EQ(statistics.num_computations, num_computations);
+    ASSERT_EQ(statistics.num_memory_imports, 3u);
+    ASSERT_EQ(statistics.imported_bytes, sizeof(float) + 2 * tensor_size);
+    ASSERT_EQ(statistics.host_output_bytes, num_computations * tensor_size);
+    ASSERT_EQ(statistics.num_memory_destroys, 0u);
+  }
+};
+
+#define ADD_EXECUTION_STATISTICS_TEST_HELPER(NAME) \
+  ADD_TEST_HELPER(ExecutionStatisticsFixture, NAME, test##NAME)
+
+ADD_EXECUTION_STATISTICS_TEST_HELPER(ExecutionStatistics)
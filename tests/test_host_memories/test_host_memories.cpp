@@ -0,0 +1,50 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/add_fixture.hpp"
+
+class HostMemoriesFixture : public AddFixture {
+ protected:
+  void testExecutionReusesHostMemories() {
+    buildModel();
+    compileModel();
+
+    // Alternate between two output buffers with the same inputs
+    const uint64_t num_computations = 4;
+    std::vector<std::vector<float>> host_outputs(
+        2, std::vector<float>(input1_size));
+    for (uint64_t i = 0; i < num_computations; ++i) {
+      host_input0 = static_cast<float>(i);
+      auto& output = host_outputs[i % 2];
+      setHostMemories();
+      TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_setOutput(
+          execution, 0, nullptr, output.data(), tensor_size));
+      TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_compute(execution));
+      checkOutput(output);
+    }
+    // Both inputs and both outputs are imported once
+    ANeuralNetworksExecutionStatistics statistics;
+    TENSOROPT_ASSERT_OK(
+        ANeuralNetworksExecution_getStatistics(execution, &statistics));
+    ASSERT_EQ(statistics.num_computations, num_computations);
+    ASSERT_EQ(statistics.num_memory_imports, 4u);
+    ASSERT_EQ(statistics.num_memory_destroys, 0u);
+  }
+};
+
+#define ADD_HOST_MEMORIES_TEST_HELPER(NAME) \
+  ADD_TEST_HELPER(HostMemoriesFixture, NAME, test##NAME)
+
+ADD_HOST_MEMORIES_TEST_HELPER(ExecutionReusesHostMemories)
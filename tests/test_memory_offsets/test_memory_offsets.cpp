@@ -0,0 +1,72 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/add_fixture.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+class MemoryOffsetsFixture : public AddFixture {
+ protected:
+  void testExecutionUsesMemoryOffsets() {
+    buildModel();
+    compileModel();
+
+    // Pack input 1 and the output in one buffer, the output is placed at the
+    // first offset aligned for the device after the input
+    std::size_t align = cl::sycl::queue().get_device().get_info<
+                            cl::sycl::info::device::mem_base_addr_align>() /
+                        8;
+    align = std::max(align, std::size_t(1));
+    const std::size_t output_offset =
+        ((tensor_size + align - 1) / align) * align;
+    std::vector<uint8_t> packed(output_offset + tensor_size);
+    std::memcpy(packed.data(), host_input1.data(), tensor_size);
+    tensoropt_buffer_t buffer(packed.data(),
+                              cl::sycl::range<1>(packed.size()));
+    ANeuralNetworksMemory* memory;
+    TENSOROPT_ASSERT_OK(
+        ANeuralNetworksMemory_createFromBuffer(buffer, &memory));
+
+    if (align > 1) {
+      ASSERT_EQ(ANeuralNetworksExecution_setOutputFromMemory(
+                    execution, 0, nullptr, memory, 1, tensor_size),
+                ANEURALNETWORKS_BAD_DATA);
+    }
+    ASSERT_EQ(ANeuralNetworksExecution_setOutputFromMemory(
+                  execution, 0, nullptr, memory, output_offset, packed.size()),
+              ANEURALNETWORKS_BAD_DATA);
+
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_setInput(
+        execution, 0, nullptr, &host_input0, sizeof(float)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_setInputFromMemory(
+        execution, 1, nullptr, memory, 0, tensor_size));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_setOutputFromMemory(
+        execution, 0, nullptr, memory, output_offset, tensor_size));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_compute(execution));
+
+    {
+      auto acc = buffer.get_access<cl::sycl::access::mode::read>();
+      std::memcpy(host_output.data(), &acc[output_offset], tensor_size);
+    }
+    checkOutput();
+    ANeuralNetworksMemory_free(memory);
+  }
+};
+
+#define ADD_MEMORY_OFFSETS_TEST_HELPER(NAME) \
+  ADD_TEST_HELPER(MemoryOffsetsFixture, NAME, test##NAME)
+
+ADD_MEMORY_OFFSETS_TEST_HELPER(ExecutionUsesMemoryOffsets)
@@ -0,0 +1,148 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/common_fixture.hpp"
+#include "model_zoo/model_zoo.hpp"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+class ModelZooFixture : public CommonFixture {
+ protected:
+  ModelZooFixture() : builder(model) {}
+
+  /**
+   * Compile and execute the model with random inputs.
+   * Check that the output has the expected shape and only finite values. If
+   * the output is the result of a SOFTMAX, check that each row sums to 1.
+   */
+  void executeAndCheck(const std::vector<uint32_t>& expected_dims,
+                       bool is_softmax) {
+    compileModel();
+    ASSERT_EQ(ANeuralNetworksExecution_getIdentifiedInputCount(execution), 1u);
+    ASSERT_EQ(ANeuralNetworksExecution_getIdentifiedOutputCount(execution),
+              1u);
+    ANeuralNetworksOperandType input_op;
+    ANeuralNetworksOperandType output_op;
+    TENSOROPT_ASSERT_OK(
+        ANeuralNetworksExecution_getIdentifiedInputs(execution, &input_op));
+    TENSOROPT_ASSERT_OK(
+        ANeuralNetworksExecution_getIdentifiedOutputs(execution, &output_op));
+    ASSERT_EQ(std::vector<uint32_t>(
+                  output_op.dimensions,
+                  output_op.dimensions + output_op.dimensionCount),
+              expected_dims);
+
+    std::mt19937 engine(0);
+    std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+    std::vector<float> host_input(getOperandTypeSize(input_op));
+    for (auto& value : host_input) {
+      value = distribution(engine);
+    }
+    std::vector<float> host_output(totalSize(expected_dims));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_setInput(
+        execution, 0, nullptr, host_input.data(),
+        host_input.size() * sizeof(float)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_setOutput(
+        execution, 0, nullptr, host_output.data(),
+        host_output.size() * sizeof(float)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_compute(execution));
+
+    for (auto value : host_output) {
+      ASSERT_TRUE(std::isfinite(value));
+    }
+    if (is_softmax) {
+      auto row_size = expected_dims.back();
+      for (std::size_t row = 0; row < host_output.size() / row_size; ++row) {
+        float sum = 0.f;
+        for (std::size_t i = 0; i < row_size; ++i) {
+          sum += host_output[row * row_size + i];
+        }
+        EXPECT_NEAR(sum, 1.f, 1e-3f);
+      }
+    }
+  }
+
+  void testMobileNetV1() {
+    MobileNetConfig config;
+    config.image_size = 32;
+    config.width_multiplier = 0.25f;
+    config.num_classes = 10;
+    TENSOROPT_ASSERT_OK(buildMobileNetV1(builder, config));
+    executeAndCheck({1, 10}, true);
+  }
+
+  void testMobileNetV2() {
+    MobileNetConfig config;
+    config.batch = 2;
+    config.image_size = 32;
+    config.width_multiplier = 0.25f;
+    config.num_classes = 10;
+    TENSOROPT_ASSERT_OK(buildMobileNetV2(builder, config));
+    executeAndCheck({2, 10}, true);
+  }
+
+  void testResNet() {
+    ResNetConfig config;
+    config.image_size = 32;
+    config.base_channels = 8;
+    config.blocks_per_stage = {1, 2};
+    config.num_classes = 10;
+    TENSOROPT_ASSERT_OK(buildResNet(builder, config));
+    executeAndCheck({1, 10}, true);
+  }
+
+  void testTransformerEncoder() {
+    TransformerConfig config;
+    config.sequence_length = 16;
+    config.model_size = 32;
+    config.num_heads = 2;
+    config.feed_forward_size = 64;
+    config.num_layers = 2;
+    TENSOROPT_ASSERT_OK(buildTransformerEncoder(builder, config));
+    executeAndCheck({16, 32}, false);
+  }
+
+  void testTransformerEncoderInvalidHeads() {
+    TransformerConfig config;
+    config.model_size = 30;
+    config.num_heads = 4;
+    ASSERT_EQ(buildTransformerEncoder(builder, config),
+              ANEURALNETWORKS_BAD_DATA);
+  }
+
+  void testMlp() {
+    MlpConfig config;
+    config.batch = 3;
+    config.input_size = 32;
+    config.hidden_sizes = {16, 16, 16};
+    config.num_classes = 10;
+    TENSOROPT_ASSERT_OK(buildMlp(builder, config));
+    executeAndCheck({3, 10}, true);
+  }
+
+  ModelBuilder builder;
+};
+
+#define ADD_MODEL_ZOO_TEST_HELPER(NAME) \
+  ADD_TEST_HELPER(ModelZooFixture, NAME, test##NAME)
+
+ADD_MODEL_ZOO_TEST_HELPER(MobileNetV1)
+ADD_MODEL_ZOO_TEST_HELPER(MobileNetV2)
+ADD_MODEL_ZOO_TEST_HELPER(ResNet)
+ADD_MODEL_ZOO_TEST_HELPER(TransformerEncoder)
+ADD_MODEL_ZOO_TEST_HELPER(TransformerEncoderInvalidHeads)
+ADD_MODEL_ZOO_TEST_HELPER(Mlp)
@@ -0,0 +1,129 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/common_fixture.hpp"
+
+#include <algorithm>
+#include <vector>
+
+class ConvFixture : public CommonFixture {
+ protected:
+  /**
+   * Build and compile a depthwise convolution of a [1, 3, 3, 1] input with a
+   * depth multiplier of 2 and a [2, 2, 2, 1] filter. The optional inputs after
+   * the FuseCode are only added if dilation is not 0.
+   */
+  void compileDepthwise(int32_t fuse_code, int32_t dilation,
+                        const std::vector<uint32_t>& output_dims) {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {1, 3, 3, 1});        // 0
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {channels, 2, 2, 1});  // 1
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {channels});           // 2
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, output_dims);          // 3
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 1, filter.data(), filter.size() * sizeof(float)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 2, bias.data(), bias.size() * sizeof(float)));
+    std::vector<uint32_t> inputs{0, 1, 2};
+    uint32_t op_idx;
+    addConstScalarOperand(ANEURALNETWORKS_INT32,
+                          int32_t(ANEURALNETWORKS_PADDING_VALID), &op_idx);
+    inputs.push_back(op_idx);
+    addConstScalarOperand(ANEURALNETWORKS_INT32, int32_t(1), &op_idx);
+    inputs.push_back(op_idx);
+    inputs.push_back(op_idx);
+    addConstScalarOperand(ANEURALNETWORKS_INT32, int32_t(channels), &op_idx);
+    inputs.push_back(op_idx);
+    addConstScalarOperand(ANEURALNETWORKS_INT32, fuse_code, &op_idx);
+    inputs.push_back(op_idx);
+    if (dilation != 0) {
+      addConstScalarOperand(ANEURALNETWORKS_BOOL, false, &op_idx);
+      inputs.push_back(op_idx);
+      inputs.push_back(op_idx);
+      addConstScalarOperand(ANEURALNETWORKS_INT32, dilation, &op_idx);
+      inputs.push_back(op_idx);
+      inputs.push_back(op_idx);
+    }
+    uint32_t output_idx = 3;
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_addOperation(
+        model, ANEURALNETWORKS_DEPTHWISE_CONV_2D,
+        static_cast<uint32_t>(inputs.size()), inputs.data(), 1, &output_idx));
+    uint32_t input_idx = 0;
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_identifyInputsAndOutputs(
+        model, 1, &input_idx, 1, &output_idx));
+    compileModel();
+  }
+
+  void execute(std::vector<float>& output) {
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_setInput(
+        execution, 0, nullptr, input.data(), input.size() * sizeof(float)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_setOutput(
+        execution, 0, nullptr, output.data(), output.size() * sizeof(float)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_compute(execution));
+  }
+
+  /**
+   * Compute the output channel c at position (h, w) on the host.
+   */
+  float computeHost(uint32_t h, uint32_t w, uint32_t c, uint32_t dilation) {
+    float res = bias[c];
+    for (uint32_t kh = 0; kh < 2; ++kh) {
+      for (uint32_t kw = 0; kw < 2; ++kw) {
+        res += input[(h + kh * dilation) * 3 + w + kw * dilation] *
+               filter[c * 4 + kh * 2 + kw];
+      }
+    }
+    return res;
+  }
+
+  void testDepthwiseWithDilation() {
+    // The dilated filter covers the whole input
+    compileDepthwise(ANEURALNETWORKS_FUSED_NONE, 2, {1, 1, 1, channels});
+
+    std::vector<float> output(channels);
+    execute(output);
+    for (uint32_t c = 0; c < channels; ++c) {
+      ASSERT_FLOAT_EQ(output[c], computeHost(0, 0, c, 2));
+    }
+  }
+
+  void testDepthwiseWithDefaultDilation() {
+    // The FuseCode is read after the depth multiplier
+    compileDepthwise(ANEURALNETWORKS_FUSED_RELU, 0, {1, 2, 2, channels});
+
+    std::vector<float> output(4 * channels);
+    execute(output);
+    for (uint32_t h = 0; h < 2; ++h) {
+      for (uint32_t w = 0; w < 2; ++w) {
+        for (uint32_t c = 0; c < channels; ++c) {
+          ASSERT_FLOAT_EQ(output[(h * 2 + w) * channels + c],
+                          std::max(computeHost(h, w, c, 1), 0.f));
+        }
+      }
+    }
+  }
+
+  static constexpr uint32_t channels = 2;
+  std::vector<float> input{1.f, -2.f, 3.f, 0.5f, 4.f, -1.f, 2.f, 1.f, -3.f};
+  std::vector<float> filter{1.f, -1.f, 2.f, 0.5f, -1.f, 3.f, 0.5f, -2.f};
+  std::vector<float> bias{0.5f, -1.f};
+};
+
+constexpr uint32_t ConvFixture::channels;
+
+#define ADD_CONV_TEST_HELPER(NAME) \
+  ADD_TEST_HELPER(ConvFixture, NAME, test##NAME)
+
+ADD_CONV_TEST_HELPER(DepthwiseWithDilation)
+ADD_CONV_TEST_HELPER(DepthwiseWithDefaultDilation)
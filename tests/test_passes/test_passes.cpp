@@ -0,0 +1,555 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/common_fixture.hpp"
+#include "backends/imgdnn/compilation.hpp"
+#include "common/passes/passes.hpp"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+class PassesFixture : public CommonFixture {
+ protected:
+  void addOperation(ANeuralNetworksOperationType op_type,
+                    const std::vector<uint32_t>& inputs,
+                    const std::vector<uint32_t>& outputs) {
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_addOperation(
+        model, op_type, static_cast<uint32_t>(inputs.size()), inputs.data(),
+        static_cast<uint32_t>(outputs.size()), outputs.data()));
+  }
+
+  void identifyInputsAndOutputs(const std::vector<uint32_t>& inputs,
+                                const std::vector<uint32_t>& outputs) {
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_identifyInputsAndOutputs(
+        model, static_cast<uint32_t>(inputs.size()), inputs.data(),
+        static_cast<uint32_t>(outputs.size()), outputs.data()));
+  }
+
+  void expectCompilationError(ResultCode expected) {
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_finish(model));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksCompilation_create(model, &compilation));
+    ASSERT_EQ(ANeuralNetworksCompilation_finish(compilation), expected);
+  }
+
+  /**
+   * Return the types of the operations left once the passes are run on a copy
+   * of the finished model.
+   */
+  std::vector<ANeuralNetworksOperationType> getOptimizedOperationTypes() {
+    ANeuralNetworksModel optimized_model = *model;
+    EXPECT_EQ(optimizeModel(optimized_model), ANEURALNETWORKS_NO_ERROR);
+    std::vector<ANeuralNetworksOperationType> types;
+    for (const auto& operation : optimized_model.operations) {
+      types.push_back(operation.type);
+    }
+    return types;
+  }
+
+  /**
+   * Execute the compiled model with float inputs and outputs.
+   */
+  void execute(const std::vector<std::vector<float>>& inputs,
+               std::vector<std::vector<float>>& outputs) {
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+      TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_setInput(
+          execution, static_cast<int32_t>(i), nullptr, inputs[i].data(),
+          inputs[i].size() * sizeof(float)));
+    }
+    for (std::size_t i = 0; i < outputs.size(); ++i) {
+      TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_setOutput(
+          execution, static_cast<int32_t>(i), nullptr, outputs[i].data(),
+          outputs[i].size() * sizeof(float)));
+    }
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_compute(execution));
+  }
+
+  void testUnorderedOperations() {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 0
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 1
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 2
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 3
+    // The consumer is added before the producer
+    addOperation(ANEURALNETWORKS_MUL, {2, 1}, {3});
+    addOperation(ANEURALNETWORKS_ADD, {0, 1}, {2});
+    identifyInputsAndOutputs({0, 1}, {3});
+    compileModel();
+
+    std::vector<float> input0{1.f, 2.f, 3.f};
+    std::vector<float> input1{-1.f, 0.5f, 2.f};
+    std::vector<std::vector<float>> outputs{std::vector<float>(size)};
+    execute({input0, input1}, outputs);
+    for (uint32_t i = 0; i < size; ++i) {
+      ASSERT_FLOAT_EQ(outputs[0][i], (input0[i] + input1[i]) * input1[i]);
+    }
+  }
+
+  void testCycleIsRejected() {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 0
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 1
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 2
+    addOperation(ANEURALNETWORKS_ADD, {0, 2}, {1});
+    addOperation(ANEURALNETWORKS_ADD, {0, 1}, {2});
+    identifyInputsAndOutputs({0}, {2});
+    expectCompilationError(ANEURALNETWORKS_BAD_DATA);
+  }
+
+  void testDanglingOperandIsRejected() {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 0
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 1
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 2
+    // Operand 1 is never set
+    addOperation(ANEURALNETWORKS_ADD, {0, 1}, {2});
+    identifyInputsAndOutputs({0}, {2});
+    expectCompilationError(ANEURALNETWORKS_BAD_DATA);
+  }
+
+  void testDeadOperationsAreRemoved() {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 0
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 1
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 2
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 3
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 4
+    std::vector<float> const_values{4.f, 5.f, 6.f};
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 1, const_values.data(), const_values.size() * sizeof(float)));
+    // Operations 3 and 4 do not contribute to the output
+    addOperation(ANEURALNETWORKS_MUL, {0, 1}, {3});
+    addOperation(ANEURALNETWORKS_ADD, {0, 0}, {2});
+    addOperation(ANEURALNETWORKS_SUB, {3, 1}, {4});
+    identifyInputsAndOutputs({0}, {2});
+    compileModel();
+
+    // Only the ADD is left and the constant is not used anymore
+    ANeuralNetworksModel optimized_model = *model;
+    TENSOROPT_ASSERT_OK(sortOperations(optimized_model));
+    TENSOROPT_ASSERT_OK(eliminateDeadOperations(optimized_model));
+    ASSERT_EQ(optimized_model.operations.size(), 1u);
+    ASSERT_EQ(optimized_model.operations[0].type, ANEURALNETWORKS_ADD);
+    ASSERT_EQ(optimized_model.const_host_operands.count(1), 0u);
+    ASSERT_EQ(optimized_model.const_host_operands_owned.count(1), 0u);
+
+    std::vector<float> input0{1.f, 2.f, 3.f};
+    std::vector<std::vector<float>> outputs{std::vector<float>(size)};
+    execute({input0}, outputs);
+    for (uint32_t i = 0; i < size; ++i) {
+      ASSERT_FLOAT_EQ(outputs[0][i], 2.f * input0[i]);
+    }
+  }
+
+  void testConstantsAreFolded() {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size, 2});  // 0
+    addOperand(ANEURALNETWORKS_TENSOR_INT32, {2});          // 1
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {2, size});  // 2
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {2, size});  // 3
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {2, size});  // 4
+    std::vector<float> const_values{1.f, 2.f, 3.f, 4.f, 5.f, 6.f};
+    std::vector<int32_t> perms{1, 0};
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 0, const_values.data(), const_values.size() * sizeof(float)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 1, perms.data(), perms.size() * sizeof(int32_t)));
+    // The transpose only depends on constants
+    addOperation(ANEURALNETWORKS_TRANSPOSE, {0, 1}, {2});
+    addOperation(ANEURALNETWORKS_ADD, {2, 3}, {4});
+    identifyInputsAndOutputs({3}, {4});
+    compileModel();
+    ASSERT_EQ(getOptimizedOperationTypes(),
+              std::vector<ANeuralNetworksOperationType>{ANEURALNETWORKS_ADD});
+
+    std::vector<float> input{1.f, 1.f, 1.f, 2.f, 2.f, 2.f};
+    std::vector<std::vector<float>> outputs{std::vector<float>(2 * size)};
+    execute({input}, outputs);
+    std::vector<float> expected{2.f, 4.f, 6.f, 4.f, 6.f, 8.f};
+    for (uint32_t i = 0; i < 2 * size; ++i) {
+      ASSERT_FLOAT_EQ(outputs[0][i], expected[i]);
+    }
+  }
+
+  void testTransposesAreMerged() {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {1, 2, 2, size});  // 0
+    addOperand(ANEURALNETWORKS_TENSOR_INT32, {4});                // 1
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {1, size, 2, 2});  // 2
+    addOperand(ANEURALNETWORKS_TENSOR_INT32, {4});                // 3
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {1, 2, 2, size});  // 4
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {1, 2, 2, size});  // 5
+    std::vector<int32_t> to_nchw{0, 3, 1, 2};
+    std::vector<int32_t> to_nhwc{0, 2, 3, 1};
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 1, to_nchw.data(), to_nchw.size() * sizeof(int32_t)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 3, to_nhwc.data(), to_nhwc.size() * sizeof(int32_t)));
+    // The second transpose cancels the first one
+    addOperation(ANEURALNETWORKS_TRANSPOSE, {0, 1}, {2});
+    addOperation(ANEURALNETWORKS_TRANSPOSE, {2, 3}, {4});
+    addOperation(ANEURALNETWORKS_RELU, {4}, {5});
+    identifyInputsAndOutputs({0}, {5});
+    compileModel();
+    // Only the first transpose is added to the network and it is not used
+    ASSERT_EQ(compilation->num_img_transposes, 1u);
+
+    std::vector<float> input(4 * size);
+    for (std::size_t i = 0; i < input.size(); ++i) {
+      input[i] = static_cast<float>(i) - 5.f;
+    }
+    std::vector<std::vector<float>> outputs{std::vector<float>(4 * size)};
+    execute({input}, outputs);
+    for (std::size_t i = 0; i < input.size(); ++i) {
+      ASSERT_FLOAT_EQ(outputs[0][i], std::max(input[i], 0.f));
+    }
+  }
+
+  void testResultsStayNCHW() {
+    static constexpr uint32_t channels = 2;
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {1, 2, 2, channels});  // 0
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32,
+               {channels, 1, 1, channels});                           // 1
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {channels});           // 2
+    addOperand(ANEURALNETWORKS_INT32);                                // 3
+    addOperand(ANEURALNETWORKS_INT32);                                // 4
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {1, 2, 2, channels});  // 5
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {1, 2, 2, channels});  // 6
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {1, 2, 2, channels});  // 7
+    std::vector<float> filter{1.f, -2.f, 3.f, 4.f};
+    std::vector<float> bias{0.5f, -1.f};
+    int32_t padding = ANEURALNETWORKS_PADDING_VALID;
+    int32_t one = 1;
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 1, filter.data(), filter.size() * sizeof(float)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 2, bias.data(), bias.size() * sizeof(float)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 3, &padding, sizeof(int32_t)));
+    TENSOROPT_ASSERT_OK(
+        ANeuralNetworksModel_setOperandValue(model, 4, &one, sizeof(int32_t)));
+    // The pooling uses the NCHW result of the convolution
+    addOperation(ANEURALNETWORKS_CONV_2D, {0, 1, 2, 3, 4, 4}, {5});
+    addOperation(ANEURALNETWORKS_RELU, {5}, {6});
+    addOperation(ANEURALNETWORKS_MAX_POOL_2D, {6, 3, 4, 4, 4, 4}, {7});
+    identifyInputsAndOutputs({0}, {7});
+    compileModel();
+    // The input is transposed to NCHW and the output back to NHWC
+    ASSERT_EQ(compilation->num_img_transposes, 2u);
+
+    std::vector<float> input{1.f, -1.f, 2.f, 0.5f, -3.f, 1.f, 0.f, 4.f};
+    std::vector<std::vector<float>> outputs{std::vector<float>(input.size())};
+    execute({input}, outputs);
+    for (uint32_t i = 0; i < input.size(); i += channels) {
+      for (uint32_t c = 0; c < channels; ++c) {
+        float conv = bias[c];
+        for (uint32_t k = 0; k < channels; ++k) {
+          conv += filter[c * channels + k] * input[i + k];
+        }
+        ASSERT_FLOAT_EQ(outputs[0][i + c], std::max(conv, 0.f));
+      }
+    }
+  }
+
+  void testActivationsAreFused() {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 0
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 1
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 2
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 3
+    // The RELU6 is merged in the FuseCode of the ADD
+    addOperation(ANEURALNETWORKS_ADD, {0, 1}, {2});
+    addOperation(ANEURALNETWORKS_RELU6, {2}, {3});
+    identifyInputsAndOutputs({0, 1}, {3});
+    compileModel();
+    ASSERT_EQ(getOptimizedOperationTypes(),
+              std::vector<ANeuralNetworksOperationType>{ANEURALNETWORKS_ADD});
+
+    std::vector<float> input0{-2.f, 2.f, 5.f};
+    std::vector<float> input1{1.f, 1.f, 3.f};
+    std::vector<std::vector<float>> outputs{std::vector<float>(size)};
+    execute({input0, input1}, outputs);
+    std::vector<float> expected{0.f, 3.f, 6.f};
+    for (uint32_t i = 0; i < size; ++i) {
+      ASSERT_FLOAT_EQ(outputs[0][i], expected[i]);
+    }
+  }
+
+  void testChannelOperationsAreFolded() {
+    static constexpr uint32_t channels = 2;
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {1, 2, 2, channels});  // 0
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32,
+               {channels, 1, 1, channels});                           // 1
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {channels});           // 2
+    addOperand(ANEURALNETWORKS_INT32);                                // 3
+    addOperand(ANEURALNETWORKS_INT32);                                // 4
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {1, 2, 2, channels});  // 5
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {channels});           // 6
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {1, 2, 2, channels});  // 7
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {channels});           // 8
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {1, 2, 2, channels});  // 9
+    std::vector<float> filter{1.f, 2.f, 3.f, 4.f};
+    std::vector<float> bias{10.f, 20.f};
+    int32_t padding = ANEURALNETWORKS_PADDING_VALID;
+    int32_t stride = 1;
+    std::vector<float> scale{2.f, -1.f};
+    std::vector<float> shift{0.5f, 100.f};
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 1, filter.data(), filter.size() * sizeof(float)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 2, bias.data(), bias.size() * sizeof(float)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 3, &padding, sizeof(int32_t)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 4, &stride, sizeof(int32_t)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 6, scale.data(), scale.size() * sizeof(float)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 8, shift.data(), shift.size() * sizeof(float)));
+    // The MUL and ADD are folded in the filter and bias of the convolution
+    addOperation(ANEURALNETWORKS_CONV_2D, {0, 1, 2, 3, 4, 4}, {5});
+    addOperation(ANEURALNETWORKS_MUL, {6, 5}, {7});
+    addOperation(ANEURALNETWORKS_ADD, {7, 8}, {9});
+    identifyInputsAndOutputs({0}, {9});
+    compileModel();
+    ASSERT_EQ(getOptimizedOperationTypes(),
+              std::vector<ANeuralNetworksOperationType>{
+                  ANEURALNETWORKS_CONV_2D});
+
+    std::vector<float> input{1.f, -1.f, 2.f, 0.5f, -3.f, 1.f, 0.f, 4.f};
+    std::vector<std::vector<float>> outputs{std::vector<float>(input.size())};
+    execute({input}, outputs);
+    for (uint32_t i = 0; i < input.size(); i += channels) {
+      for (uint32_t c = 0; c < channels; ++c) {
+        float conv = bias[c];
+        for (uint32_t k = 0; k < channels; ++k) {
+          conv += filter[c * channels + k] * input[i + k];
+        }
+        ASSERT_FLOAT_EQ(outputs[0][i + c], conv * scale[c] + shift[c]);
+      }
+    }
+  }
+
+  void testReshapesAreCollapsed() {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {1, size});  // 0
+    addOperand(ANEURALNETWORKS_TENSOR_INT32, {2});          // 1
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size, 1});  // 2
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});     // 3
+    addOperand(ANEURALNETWORKS_TENSOR_INT32, {1});          // 4
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});     // 5
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});     // 6
+    std::vector<int32_t> shape2d{size, 1};
+    std::vector<int32_t> shape1d{size};
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 1, shape2d.data(), shape2d.size() * sizeof(int32_t)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 4, shape1d.data(), shape1d.size() * sizeof(int32_t)));
+    // The last reshape is applied to the input directly
+    addOperation(ANEURALNETWORKS_RESHAPE, {0, 1}, {2});
+    addOperation(ANEURALNETWORKS_SQUEEZE, {2}, {3});
+    addOperation(ANEURALNETWORKS_RESHAPE, {3, 4}, {5});
+    addOperation(ANEURALNETWORKS_RELU, {5}, {6});
+    identifyInputsAndOutputs({0}, {6});
+    compileModel();
+    ASSERT_EQ(getOptimizedOperationTypes(),
+              (std::vector<ANeuralNetworksOperationType>{
+                  ANEURALNETWORKS_RESHAPE, ANEURALNETWORKS_RELU}));
+
+    std::vector<float> input{-1.f, 2.f, 3.f};
+    std::vector<std::vector<float>> outputs{std::vector<float>(size)};
+    execute({input}, outputs);
+    for (uint32_t i = 0; i < size; ++i) {
+      ASSERT_FLOAT_EQ(outputs[0][i], std::max(input[i], 0.f));
+    }
+  }
+
+  void testIdentityReshapesAreRemoved() {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 0
+    addOperand(ANEURALNETWORKS_TENSOR_INT32, {1});       // 1
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 2
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 3
+    std::vector<int32_t> shape{size};
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 1, shape.data(), shape.size() * sizeof(int32_t)));
+    addOperation(ANEURALNETWORKS_RESHAPE, {0, 1}, {2});
+    addOperation(ANEURALNETWORKS_RELU, {2}, {3});
+    identifyInputsAndOutputs({0}, {3});
+    compileModel();
+    ASSERT_EQ(getOptimizedOperationTypes(),
+              std::vector<ANeuralNetworksOperationType>{ANEURALNETWORKS_RELU});
+
+    std::vector<float> input{-1.f, 2.f, 3.f};
+    std::vector<std::vector<float>> outputs{std::vector<float>(size)};
+    execute({input}, outputs);
+    for (uint32_t i = 0; i < size; ++i) {
+      ASSERT_FLOAT_EQ(outputs[0][i], std::max(input[i], 0.f));
+    }
+  }
+
+  void testCommonSubexpressionsAreMerged() {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 0
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 1
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 2
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});  // 3
+    // Operand 2 is computed like operand 1
+    addOperation(ANEURALNETWORKS_EXP, {0}, {1});
+    addOperation(ANEURALNETWORKS_EXP, {0}, {2});
+    addOperation(ANEURALNETWORKS_SUB, {1, 2}, {3});
+    identifyInputsAndOutputs({0}, {3});
+    compileModel();
+    ASSERT_EQ(getOptimizedOperationTypes(),
+              (std::vector<ANeuralNetworksOperationType>{
+                  ANEURALNETWORKS_EXP, ANEURALNETWORKS_SUB}));
+
+    std::vector<float> input{-1.f, 0.f, 2.f};
+    std::vector<std::vector<float>> outputs{std::vector<float>(size)};
+    execute({input}, outputs);
+    for (uint32_t i = 0; i < size; ++i) {
+      ASSERT_FLOAT_EQ(outputs[0][i], 0.f);
+    }
+  }
+
+  void testEqualConstantsAreMerged() {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size, 2});  // 0
+    addOperand(ANEURALNETWORKS_TENSOR_INT32, {2});          // 1
+    addOperand(ANEURALNETWORKS_TENSOR_INT32, {2});          // 2
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {2, size});  // 3
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {2, size});  // 4
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {2, size});  // 5
+    // The permutations are equal but stored in different operands
+    std::vector<int32_t> perms{1, 0};
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 1, perms.data(), perms.size() * sizeof(int32_t)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 2, perms.data(), perms.size() * sizeof(int32_t)));
+    addOperation(ANEURALNETWORKS_TRANSPOSE, {0, 1}, {3});
+    addOperation(ANEURALNETWORKS_TRANSPOSE, {0, 2}, {4});
+    addOperation(ANEURALNETWORKS_SUB, {3, 4}, {5});
+    identifyInputsAndOutputs({0}, {5});
+    compileModel();
+    ASSERT_EQ(getOptimizedOperationTypes(),
+              (std::vector<ANeuralNetworksOperationType>{
+                  ANEURALNETWORKS_TRANSPOSE, ANEURALNETWORKS_SUB}));
+
+    std::vector<float> input{1.f, 2.f, 3.f, 4.f, 5.f, 6.f};
+    std::vector<std::vector<float>> outputs{std::vector<float>(2 * size)};
+    execute({input}, outputs);
+    for (uint32_t i = 0; i < 2 * size; ++i) {
+      ASSERT_FLOAT_EQ(outputs[0][i], 0.f);
+    }
+  }
+
+  void testDifferentConstantsAreNotMerged() {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size, size, size});  // 0
+    addOperand(ANEURALNETWORKS_TENSOR_INT32, {3});                   // 1
+    addOperand(ANEURALNETWORKS_TENSOR_INT32, {3});                   // 2
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size, size, size});  // 3
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size, size, size});  // 4
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size, size, size});  // 5
+    // The permutations differ but produce the same shape
+    std::vector<int32_t> perms1{1, 0, 2};
+    std::vector<int32_t> perms2{2, 1, 0};
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 1, perms1.data(), perms1.size() * sizeof(int32_t)));
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_setOperandValue(
+        model, 2, perms2.data(), perms2.size() * sizeof(int32_t)));
+    addOperation(ANEURALNETWORKS_TRANSPOSE, {0, 1}, {3});
+    addOperation(ANEURALNETWORKS_TRANSPOSE, {0, 2}, {4});
+    addOperation(ANEURALNETWORKS_SUB, {3, 4}, {5});
+    identifyInputsAndOutputs({0}, {5});
+    compileModel();
+    ASSERT_EQ(getOptimizedOperationTypes(),
+              (std::vector<ANeuralNetworksOperationType>{
+                  ANEURALNETWORKS_TRANSPOSE, ANEURALNETWORKS_TRANSPOSE,
+                  ANEURALNETWORKS_SUB}));
+
+    std::vector<float> input(size * size * size);
+    for (uint32_t i = 0; i < input.size(); ++i) {
+      input[i] = static_cast<float>(i);
+    }
+    std::vector<std::vector<float>> outputs{
+        std::vector<float>(size * size * size)};
+    execute({input}, outputs);
+    auto at = [](uint32_t i, uint32_t j, uint32_t k) {
+      return (i * size + j) * size + k;
+    };
+    for (uint32_t i = 0; i < size; ++i) {
+      for (uint32_t j = 0; j < size; ++j) {
+        for (uint32_t k = 0; k < size; ++k) {
+          ASSERT_FLOAT_EQ(outputs[0][at(i, j, k)],
+                          input[at(j, i, k)] - input[at(k, j, i)]);
+        }
+      }
+    }
+  }
+
+  void testInvalidShapeIsRejected() {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});      // 0
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});      // 1
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size + 1});  // 2
+    addOperation(ANEURALNETWORKS_ADD, {0, 1}, {2});
+    identifyInputsAndOutputs({0, 1}, {2});
+    expectCompilationError(ANEURALNETWORKS_BAD_DATA);
+  }
+
+  void testIntermediateMemoryIsReused() {
+    for (uint32_t i = 0; i < 5; ++i) {
+      addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, {size});
+    }
+    for (uint32_t i = 0; i < 4; ++i) {
+      addOperation(ANEURALNETWORKS_ADD, {i, i}, {i + 1});
+    }
+    identifyInputsAndOutputs({0}, {4});
+    compileModel();
+    // Operands 1 and 3 are not alive at the same time, each intermediate
+    // operand is aligned to 64 bytes
+    std::size_t arena_size;
+    TENSOROPT_ASSERT_OK(
+        ANeuralNetworksCompilation_getArenaSize(compilation, &arena_size));
+    ASSERT_EQ(arena_size, 2u * 64u);
+    std::array<std::size_t, 3> offsets;
+    for (uint32_t i = 0; i < offsets.size(); ++i) {
+      TENSOROPT_ASSERT_OK(ANeuralNetworksCompilation_getArenaOffset(
+          compilation, i + 1, &offsets[i]));
+    }
+    ASSERT_EQ(offsets[0], offsets[2]);
+    ASSERT_NE(offsets[0], offsets[1]);
+    // Inputs and outputs are not in the arena
+    std::size_t offset;
+    ASSERT_EQ(
+        ANeuralNetworksCompilation_getArenaOffset(compilation, 0, &offset),
+        ANEURALNETWORKS_BAD_DATA);
+    ASSERT_EQ(
+        ANeuralNetworksCompilation_getArenaOffset(compilation, 4, &offset),
+        ANEURALNETWORKS_BAD_DATA);
+  }
+
+  static constexpr uint32_t size = 3;
+};
+
+constexpr uint32_t PassesFixture::size;
+
+#define ADD_PASSES_TEST_HELPER(NAME) \
+  ADD_TEST_HELPER(PassesFixture, NAME, test##NAME)
+
+ADD_PASSES_TEST_HELPER(UnorderedOperations)
+ADD_PASSES_TEST_HELPER(CycleIsRejected)
+ADD_PASSES_TEST_HELPER(DanglingOperandIsRejected)
+ADD_PASSES_TEST_HELPER(DeadOperationsAreRemoved)
+ADD_PASSES_TEST_HELPER(ConstantsAreFolded)
+ADD_PASSES_TEST_HELPER(TransposesAreMerged)
+ADD_PASSES_TEST_HELPER(ResultsStayNCHW)
+ADD_PASSES_TEST_HELPER(ActivationsAreFused)
+ADD_PASSES_TEST_HELPER(ChannelOperationsAreFolded)
+ADD_PASSES_TEST_HELPER(ReshapesAreCollapsed)
+ADD_PASSES_TEST_HELPER(IdentityReshapesAreRemoved)
+ADD_PASSES_TEST_HELPER(CommonSubexpressionsAreMerged)
+ADD_PASSES_TEST_HELPER(EqualConstantsAreMerged)
+ADD_PASSES_TEST_HELPER(DifferentConstantsAreNotMerged)
+ADD_PASSES_TEST_HELPER(InvalidShapeIsRejected)
+ADD_PASSES_TEST_HELPER(IntermediateMemoryIsReused)
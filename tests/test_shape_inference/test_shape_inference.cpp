@@ -0,0 +1,220 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/common_fixture.hpp"
+#include "common/passes/passes.hpp"
+
+#include <vector>
+
+class ShapeInferenceFixture : public CommonFixture {
+ protected:
+  using Shape = std::vector<uint32_t>;
+
+  void addOperation(ANeuralNetworksOperationType op_type,
+                    const std::vector<uint32_t>& inputs,
+                    const std::vector<uint32_t>& outputs) {
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_addOperation(
+        model, op_type, static_cast<uint32_t>(inputs.size()), inputs.data(),
+        static_cast<uint32_t>(outputs.size()), outputs.data()));
+  }
+
+  void identifyInputsAndOutputs(const std::vector<uint32_t>& inputs,
+                                const std::vector<uint32_t>& outputs) {
+    TENSOROPT_ASSERT_OK(ANeuralNetworksModel_identifyInputsAndOutputs(
+        model, static_cast<uint32_t>(inputs.size()), inputs.data(),
+        static_cast<uint32_t>(outputs.size()), outputs.data()));
+  }
+
+  uint32_t addInt32Operand(int32_t value) {
+    uint32_t op_idx;
+    addConstScalarOperand(ANEURALNETWORKS_INT32, value, &op_idx);
+    return op_idx;
+  }
+
+  uint32_t addInt32TensorOperand(const std::vector<int32_t>& values) {
+    uint32_t op_idx;
+    addOperand(ANEURALNETWORKS_TENSOR_INT32,
+               Shape{static_cast<uint32_t>(values.size())}, &op_idx);
+    EXPECT_EQ(ANeuralNetworksModel_setOperandValue(
+                  model, static_cast<int32_t>(op_idx), values.data(),
+                  values.size() * sizeof(int32_t)),
+              ANEURALNETWORKS_NO_ERROR);
+    return op_idx;
+  }
+
+  uint32_t addUnknownOperand(std::size_t rank) {
+    uint32_t op_idx;
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, Shape(rank, 0), &op_idx);
+    return op_idx;
+  }
+
+  /**
+   * Return the dimensions of the operands once the shapes are inferred on a
+   * copy of the finished model.
+   */
+  std::vector<Shape> inferDimensions(const std::vector<uint32_t>& op_indices) {
+    EXPECT_EQ(ANeuralNetworksModel_finish(model), ANEURALNETWORKS_NO_ERROR);
+    ANeuralNetworksModel inferred_model = *model;
+    EXPECT_EQ(sortOperations(inferred_model), ANEURALNETWORKS_NO_ERROR);
+    EXPECT_EQ(inferOperandShapes(inferred_model), ANEURALNETWORKS_NO_ERROR);
+    std::vector<Shape> shapes;
+    for (auto op_idx : op_indices) {
+      const auto& op = inferred_model.operands[op_idx];
+      shapes.emplace_back(op.dimensions, op.dimensions + op.dimensionCount);
+    }
+    return shapes;
+  }
+
+  void testWindowPadding() {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, Shape{1, 5, 5, 2});  // 0
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, Shape{3, 3, 3, 2});  // 1
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, Shape{3});           // 2
+    auto same_conv = addUnknownOperand(4);
+    auto valid_conv = addUnknownOperand(4);
+    auto same_pool = addUnknownOperand(4);
+    auto valid_pool = addUnknownOperand(4);
+    auto same = addInt32Operand(ANEURALNETWORKS_PADDING_SAME);
+    auto valid = addInt32Operand(ANEURALNETWORKS_PADDING_VALID);
+    auto one = addInt32Operand(1);
+    auto two = addInt32Operand(2);
+    auto fuse = addInt32Operand(ANEURALNETWORKS_FUSED_NONE);
+    addOperation(ANEURALNETWORKS_CONV_2D, {0, 1, 2, same, two, two, fuse},
+                 {same_conv});
+    addOperation(ANEURALNETWORKS_CONV_2D, {0, 1, 2, valid, two, two, fuse},
+                 {valid_conv});
+    addOperation(ANEURALNETWORKS_MAX_POOL_2D,
+                 {0, same, one, one, two, two, fuse}, {same_pool});
+    addOperation(ANEURALNETWORKS_MAX_POOL_2D,
+                 {0, valid, one, one, two, two, fuse}, {valid_pool});
+    identifyInputsAndOutputs({0, 1, 2},
+                             {same_conv, valid_conv, same_pool, valid_pool});
+
+    auto shapes =
+        inferDimensions({same_conv, valid_conv, same_pool, valid_pool});
+    EXPECT_EQ(shapes[0], (Shape{1, 3, 3, 3}));
+    EXPECT_EQ(shapes[1], (Shape{1, 2, 2, 3}));
+    EXPECT_EQ(shapes[2], (Shape{1, 5, 5, 2}));
+    EXPECT_EQ(shapes[3], (Shape{1, 4, 4, 2}));
+  }
+
+  void testWindowStridesAndDilation() {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, Shape{1, 9, 6, 2});  // 0
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, Shape{3, 3, 3, 2});  // 1
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, Shape{3});           // 2
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, Shape{4, 3, 3, 1});  // 3
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, Shape{4});           // 4
+    auto conv = addUnknownOperand(4);
+    auto depthwise = addUnknownOperand(4);
+    auto valid = addInt32Operand(ANEURALNETWORKS_PADDING_VALID);
+    auto one = addInt32Operand(1);
+    auto two = addInt32Operand(2);
+    auto fuse = addInt32Operand(ANEURALNETWORKS_FUSED_NONE);
+    uint32_t no;
+    addConstScalarOperand(ANEURALNETWORKS_BOOL, false, &no);
+    // The stride and dilation of the height are 2, the ones of the width 1
+    addOperation(ANEURALNETWORKS_CONV_2D,
+                 {0, 1, 2, valid, one, two, fuse, no, no, one, two}, {conv});
+    // Depthwise convolutions have the depth multiplier before the FuseCode
+    addOperation(ANEURALNETWORKS_DEPTHWISE_CONV_2D,
+                 {0, 3, 4, valid, one, two, two, fuse, no, no, one, two},
+                 {depthwise});
+    identifyInputsAndOutputs({0, 1, 2, 3, 4}, {conv, depthwise});
+
+    auto shapes = inferDimensions({conv, depthwise});
+    EXPECT_EQ(shapes[0], (Shape{1, 3, 4, 3}));
+    EXPECT_EQ(shapes[1], (Shape{1, 3, 4, 4}));
+  }
+
+  void testBroadcast() {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, Shape{2, 1, 3});  // 0
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, Shape{4, 1});     // 1
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, Shape{1});        // 2
+    auto add = addUnknownOperand(3);
+    auto mul = addUnknownOperand(2);
+    addOperation(ANEURALNETWORKS_ADD, {0, 1}, {add});
+    addOperation(ANEURALNETWORKS_MUL, {2, 1}, {mul});
+    identifyInputsAndOutputs({0, 1, 2}, {add, mul});
+
+    auto shapes = inferDimensions({add, mul});
+    EXPECT_EQ(shapes[0], (Shape{2, 4, 3}));
+    EXPECT_EQ(shapes[1], (Shape{4, 1}));
+  }
+
+  void testStridedSliceMasks() {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, Shape{2, 3, 4});  // 0
+    auto shrink_slice = addUnknownOperand(2);
+    auto new_axis_slice = addUnknownOperand(3);
+    auto zero = addInt32Operand(0);
+    // The last axis is shrunk
+    addOperation(ANEURALNETWORKS_STRIDED_SLICE,
+                 {0, addInt32TensorOperand({0, 1, 1}),
+                  addInt32TensorOperand({2, 3, 2}),
+                  addInt32TensorOperand({1, 1, 1}), zero, zero,
+                  addInt32Operand(4)},
+                 {shrink_slice});
+    // The first axis is shrunk and a new axis is inserted after it
+    addOperation(ANEURALNETWORKS_STRIDED_SLICE,
+                 {0, addInt32TensorOperand({0, 1, 0}),
+                  addInt32TensorOperand({1, 3, 4}),
+                  addInt32TensorOperand({1, 1, 2}), zero, zero,
+                  addInt32Operand(1), zero, addInt32Operand(2)},
+                 {new_axis_slice});
+    identifyInputsAndOutputs({0}, {shrink_slice, new_axis_slice});
+
+    auto shapes = inferDimensions({shrink_slice, new_axis_slice});
+    EXPECT_EQ(shapes[0], (Shape{2, 2}));
+    EXPECT_EQ(shapes[1], (Shape{2, 1, 2}));
+  }
+
+  void testReshapeUnknownDimension() {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, Shape{2, 3, 4});  // 0
+    auto first = addUnknownOperand(2);
+    auto middle = addUnknownOperand(3);
+    addOperation(ANEURALNETWORKS_RESHAPE, {0, addInt32TensorOperand({4, -1})},
+                 {first});
+    addOperation(ANEURALNETWORKS_RESHAPE,
+                 {0, addInt32TensorOperand({2, -1, 3})}, {middle});
+    identifyInputsAndOutputs({0}, {first, middle});
+
+    auto shapes = inferDimensions({first, middle});
+    EXPECT_EQ(shapes[0], (Shape{4, 6}));
+    EXPECT_EQ(shapes[1], (Shape{2, 4, 3}));
+  }
+
+  void testDeclaredUnknownDimensions() {
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, Shape{2, 3});  // 0
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, Shape{0, 3});  // 1
+    addOperand(ANEURALNETWORKS_TENSOR_FLOAT32, Shape{3, 0});  // 2
+    addOperation(ANEURALNETWORKS_RELU, {0}, {1});
+    addOperation(ANEURALNETWORKS_TRANSPOSE, {1, addInt32TensorOperand({1, 0})},
+                 {2});
+    identifyInputsAndOutputs({0}, {2});
+
+    // The intermediate and output operands are both set
+    auto shapes = inferDimensions({1, 2});
+    EXPECT_EQ(shapes[0], (Shape{2, 3}));
+    EXPECT_EQ(shapes[1], (Shape{3, 2}));
+  }
+};
+
+#define ADD_SHAPE_INFERENCE_TEST_HELPER(NAME) \
+  ADD_TEST_HELPER(ShapeInferenceFixture, NAME, test##NAME)
+
+ADD_SHAPE_INFERENCE_TEST_HELPER(WindowPadding)
+ADD_SHAPE_INFERENCE_TEST_HELPER(WindowStridesAndDilation)
+ADD_SHAPE_INFERENCE_TEST_HELPER(Broadcast)
+ADD_SHAPE_INFERENCE_TEST_HELPER(StridedSliceMasks)
+ADD_SHAPE_INFERENCE_TEST_HELPER(ReshapeUnknownDimension)
+ADD_SHAPE_INFERENCE_TEST_HELPER(DeclaredUnknownDimensions)
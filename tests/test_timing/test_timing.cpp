@@ -0,0 +1,65 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/add_fixture.hpp"
+
+#include <cstdint>
+#include <map>
+
+class TimingFixture : public AddFixture {
+ protected:
+  void testMeasureTiming() {
+    buildModel();
+    compileModel();
+
+    uint64_t duration;
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_getDuration(
+        execution, ANEURALNETWORKS_DURATION_ON_HARDWARE, &duration));
+    ASSERT_EQ(duration, UINT64_MAX);
+
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_setMeasureTiming(execution,
+                                                                  true));
+    setHostMemories();
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_compute(execution));
+    checkOutput();
+    std::map<int32_t, uint64_t> durations;
+    for (int32_t code :
+         {ANEURALNETWORKS_DURATION_ON_HARDWARE,
+          ANEURALNETWORKS_DURATION_IN_DRIVER, ANEURALNETWORKS_DURATION_IN_QUEUE,
+          ANEURALNETWORKS_DURATION_COPY_TO_HOST}) {
+      TENSOROPT_ASSERT_OK(
+          ANeuralNetworksExecution_getDuration(execution, code, &duration));
+      ASSERT_NE(duration, UINT64_MAX);
+      durations[code] = duration;
+    }
+    // The time in the driver includes all the other durations
+    ASSERT_GE(durations[ANEURALNETWORKS_DURATION_IN_DRIVER],
+              durations[ANEURALNETWORKS_DURATION_ON_HARDWARE] +
+                  durations[ANEURALNETWORKS_DURATION_IN_QUEUE] +
+                  durations[ANEURALNETWORKS_DURATION_COPY_TO_HOST]);
+    // The NNAPI fenced durations and codes after the TensorOpt ones are not
+    // supported
+    for (int32_t code : {2, 3, 1002}) {
+      ASSERT_EQ(
+          ANeuralNetworksExecution_getDuration(execution, code, &duration),
+          ANEURALNETWORKS_BAD_DATA);
+    }
+  }
+};
+
+#define ADD_TIMING_TEST_HELPER(NAME) \
+  ADD_TEST_HELPER(TimingFixture, NAME, test##NAME)
+
+ADD_TIMING_TEST_HELPER(MeasureTiming)
@@ -0,0 +1,77 @@
+/**
+ * Copyright (C) Codeplay Software Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/add_fixture.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+class TraceFixture : public AddFixture {
+ protected:
+  TraceFixture() : trace_path("./test_trace.json") {}
+
+  ~TraceFixture() { std::remove(trace_path.c_str()); }
+
+  void compute() {
+    compileModel();
+    setHostMemories();
+    TENSOROPT_ASSERT_OK(ANeuralNetworksExecution_compute(execution));
+    checkOutput();
+  }
+
+  std::string readTrace() {
+    std::ifstream file(trace_path);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+  }
+
+  void testTraceApiBackendAndDevice() {
+    TENSOROPT_ASSERT_OK(ANeuralNetworks_startTracing(trace_path.c_str()));
+    ASSERT_EQ(ANeuralNetworks_startTracing(trace_path.c_str()),
+              ANEURALNETWORKS_BAD_STATE);
+    buildModel();
+    compute();
+    TENSOROPT_ASSERT_OK(ANeuralNetworks_stopTracing());
+
+    auto trace = readTrace();
+    ASSERT_EQ(trace.find("{\"traceEvents\":["), 0u);
+    for (const char* name :
+         {"\"ANeuralNetworksModel_finish\"",
+          "\"ANeuralNetworksExecution_compute\"",
+          "\"imgdnnNetworkObjectExecute\"", "\"interop_task\""}) {
+      ASSERT_NE(trace.find(name), std::string::npos) << name;
+    }
+  }
+
+  void testNothingIsRecordedWhenStopped() {
+    ASSERT_EQ(ANeuralNetworks_stopTracing(), ANEURALNETWORKS_BAD_STATE);
+    TENSOROPT_ASSERT_OK(ANeuralNetworks_startTracing(trace_path.c_str()));
+    TENSOROPT_ASSERT_OK(ANeuralNetworks_stopTracing());
+    buildModel();
+    compute();
+    ASSERT_EQ(readTrace().find("ANeuralNetworks"), std::string::npos);
+  }
+
+  std::string trace_path;
+};
+
+#define ADD_TRACE_TEST_HELPER(NAME) \
+  ADD_TEST_HELPER(TraceFixture, NAME, test##NAME)
+
+ADD_TRACE_TEST_HELPER(TraceApiBackendAndDevice)
+ADD_TRACE_TEST_HELPER(NothingIsRecordedWhenStopped)